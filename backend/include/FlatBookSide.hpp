@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace dom
+{
+    // One side of the book stored as a tick-indexed ring buffer.
+    //
+    // The ring covers a contiguous tick range [base_, base_ + capacity) and a
+    // level lives in slot `tick & mask_`, so set/clear/lookup are O(1) without
+    // any tree walk. Ticks that fall outside the covered range (a far print
+    // before the next re-anchor, or an unbounded cache) go to a small spill map
+    // so results stay identical to the std::map storage.
+    class FlatBookSide
+    {
+    public:
+        using Tick = std::int64_t;
+
+        FlatBookSide();
+
+        // Size the ring so that [anchor - span, anchor + span] always fits.
+        void reserveSpan(std::size_t spanPerSide);
+
+        void clear();
+
+        [[nodiscard]] bool empty() const { return count_ == 0 && spill_.empty(); }
+
+        // Returns 0.0 when the level is absent.
+        [[nodiscard]] double get(Tick tick) const;
+
+        // qty <= 0 removes the level (same rule as OrderBook::applySide).
+        void set(Tick tick, double qty);
+        void add(Tick tick, double qty);
+
+        // Preconditions: !empty().
+        [[nodiscard]] Tick highest() const;
+        [[nodiscard]] Tick lowest() const;
+
+        // Drop everything outside [minTick, maxTick] and re-anchor the ring on
+        // that range; spilled levels that are now covered move into the ring.
+        void retainRange(Tick minTick, Tick maxTick);
+
+        // Remove all levels with tick >= fromTick / tick <= toTick.
+        void eraseFrom(Tick fromTick);
+        void eraseUpTo(Tick toTick);
+
+    private:
+        [[nodiscard]] bool covers(Tick tick) const
+        {
+            return anchored_ && tick >= base_ && tick - base_ < static_cast<Tick>(slots_.size());
+        }
+        [[nodiscard]] double &slot(Tick tick)
+        {
+            return slots_[static_cast<std::size_t>(static_cast<std::uint64_t>(tick) & mask_)];
+        }
+        [[nodiscard]] double slot(Tick tick) const
+        {
+            return slots_[static_cast<std::size_t>(static_cast<std::uint64_t>(tick) & mask_)];
+        }
+
+        void anchorAround(Tick tick);
+        void absorbSpill();
+        void clearRingRange(Tick fromTick, Tick toTick);
+        void rescanHighest(Tick startTick);
+        void rescanLowest(Tick startTick);
+
+        std::vector<double> slots_;
+        std::uint64_t mask_{0};
+        Tick base_{0};
+        bool anchored_{false};
+
+        // Occupied ring slots and the extremes among them.
+        std::size_t count_{0};
+        Tick hi_{0};
+        Tick lo_{0};
+
+        std::map<Tick, double> spill_;
+
+        static constexpr std::size_t kMinCapacity = 1024;
+    };
+} // namespace dom
@@ -0,0 +1,212 @@
+#pragma once
+
+// Shared-memory ladder transport (`--shm <name>`).
+//
+// LadderClient creates a named mapping sized for its ladder window and passes
+// the name to orderbook_backend. The backend publishes every ladder into the
+// segment under a seqlock and pushes trades into a single-producer /
+// single-consumer ring; stdout only carries small doorbell frames
+// (FrameType::ShmLadder / ShmTrades) so the GUI knows when to look.
+//
+// Layout: SegmentHeader, f64 bid[rowCapacity], f64 ask[rowCapacity],
+// TradeSlot trades[tradeCapacity]. Row i of the published window is tick
+// windowMaxTick - i * compression. With compression 1 that is exactly the
+// binary full-ladder frame; above 1 every row is a bucket summed by the
+// backend (see OrderBook::compressedLadderRows).
+
+#include "LadderWire.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+namespace dom::shm
+{
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+                  "seqlock counters must be lock-free to live in shared memory");
+
+    constexpr std::uint32_t kSegmentMagic = 0x504C4D53; // "SMLP"
+    constexpr std::uint32_t kSegmentVersion = 2;
+    constexpr std::uint32_t kDefaultTradeCapacity = 1024; // power of two
+
+    struct TradeSlot
+    {
+        std::int64_t timestamp;
+        std::int64_t tick;
+        double price;
+        double qty;
+        std::uint64_t flags; // dom::wire::TradeFlag
+    };
+
+    struct SegmentHeader
+    {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint32_t rowCapacity;
+        std::uint32_t tradeCapacity;
+
+        // Ladder window, guarded by `seq` (odd while the backend is writing).
+        alignas(64) std::atomic<std::uint64_t> seq;
+        dom::wire::LadderHeader ladder;
+        std::uint32_t rowCount;
+        std::uint32_t compression; // ticks per row
+
+        // Trade ring: backend owns tradeWrite, GUI owns tradeRead.
+        alignas(64) std::atomic<std::uint64_t> tradeWrite;
+        alignas(64) std::atomic<std::uint64_t> tradeRead;
+        std::atomic<std::uint64_t> tradesDropped;
+    };
+
+    inline std::size_t alignUp(std::size_t v, std::size_t a) { return (v + a - 1) / a * a; }
+
+    inline std::size_t rowsOffset() { return alignUp(sizeof(SegmentHeader), 64); }
+
+    inline std::size_t tradesOffset(std::uint32_t rowCapacity)
+    {
+        return alignUp(rowsOffset() + 2 * sizeof(double) * rowCapacity, 64);
+    }
+
+    inline std::size_t segmentSize(std::uint32_t rowCapacity, std::uint32_t tradeCapacity)
+    {
+        return tradesOffset(rowCapacity) + sizeof(TradeSlot) * tradeCapacity;
+    }
+
+    // Typed view over a mapped segment. Does not own the mapping.
+    class Segment
+    {
+    public:
+        Segment() = default;
+        Segment(void *base, std::size_t size) : base_(static_cast<char *>(base)), size_(size) {}
+
+        // Creator side: construct the header in freshly mapped memory.
+        static Segment create(void *base, std::size_t size, std::uint32_t rowCapacity, std::uint32_t tradeCapacity)
+        {
+            auto *h = new (base) SegmentHeader{};
+            h->magic = kSegmentMagic;
+            h->version = kSegmentVersion;
+            h->rowCapacity = rowCapacity;
+            h->tradeCapacity = tradeCapacity;
+            return Segment(base, size);
+        }
+
+        // Opener side: true when the mapping carries a compatible header.
+        [[nodiscard]] bool valid() const
+        {
+            if (!base_ || size_ < sizeof(SegmentHeader))
+            {
+                return false;
+            }
+            const auto *h = header();
+            return h->magic == kSegmentMagic && h->version == kSegmentVersion && h->rowCapacity != 0
+                   && h->tradeCapacity != 0 && (h->tradeCapacity & (h->tradeCapacity - 1)) == 0
+                   && segmentSize(h->rowCapacity, h->tradeCapacity) <= size_;
+        }
+
+        [[nodiscard]] SegmentHeader *header() const { return reinterpret_cast<SegmentHeader *>(base_); }
+        [[nodiscard]] std::uint32_t rowCapacity() const { return header()->rowCapacity; }
+
+        // --- ladder (seqlock) ---------------------------------------------
+
+        // Single writer. Rows beyond rowCapacity are not published; callers
+        // trim the window to the capacity first.
+        void publishLadder(const dom::wire::LadderHeader &ladder,
+                           const double *bids,
+                           const double *asks,
+                           std::uint32_t n,
+                           std::uint32_t compression)
+        {
+            auto *h = header();
+            n = n < h->rowCapacity ? n : h->rowCapacity;
+            const std::uint64_t s = h->seq.load(std::memory_order_relaxed);
+            h->seq.store(s + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            h->ladder = ladder;
+            h->rowCount = n;
+            h->compression = compression;
+            std::memcpy(bidRows(), bids, n * sizeof(double));
+            std::memcpy(askRows(), asks, n * sizeof(double));
+            h->seq.store(s + 2, std::memory_order_release);
+        }
+
+        // Copies a consistent ladder; `bids`/`asks` must hold rowCapacity values.
+        // Returns false if nothing was published yet or the writer kept racing.
+        bool readLadder(dom::wire::LadderHeader &ladder,
+                        double *bids,
+                        double *asks,
+                        std::uint32_t &n,
+                        std::uint32_t &compression) const
+        {
+            const auto *h = header();
+            for (int attempt = 0; attempt < 64; ++attempt)
+            {
+                const std::uint64_t s1 = h->seq.load(std::memory_order_acquire);
+                if (s1 == 0)
+                {
+                    return false;
+                }
+                if (s1 & 1u)
+                {
+                    continue;
+                }
+                ladder = h->ladder;
+                n = h->rowCount < h->rowCapacity ? h->rowCount : h->rowCapacity;
+                compression = h->compression;
+                std::memcpy(bids, bidRows(), n * sizeof(double));
+                std::memcpy(asks, askRows(), n * sizeof(double));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (h->seq.load(std::memory_order_relaxed) == s1)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // --- trades (SPSC ring) -------------------------------------------
+
+        // Producer. Drops (and counts) the trade when the GUI fell a full ring behind.
+        bool pushTrade(const TradeSlot &trade)
+        {
+            auto *h = header();
+            const std::uint64_t w = h->tradeWrite.load(std::memory_order_relaxed);
+            const std::uint64_t r = h->tradeRead.load(std::memory_order_acquire);
+            if (w - r >= h->tradeCapacity)
+            {
+                h->tradesDropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            tradeSlots()[w & (h->tradeCapacity - 1)] = trade;
+            h->tradeWrite.store(w + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer. Calls fn(const TradeSlot &) for every pending trade.
+        template <typename Fn>
+        std::size_t drainTrades(Fn &&fn)
+        {
+            auto *h = header();
+            std::uint64_t r = h->tradeRead.load(std::memory_order_relaxed);
+            const std::uint64_t w = h->tradeWrite.load(std::memory_order_acquire);
+            const std::size_t count = static_cast<std::size_t>(w - r);
+            for (; r != w; ++r)
+            {
+                fn(tradeSlots()[r & (h->tradeCapacity - 1)]);
+            }
+            h->tradeRead.store(r, std::memory_order_release);
+            return count;
+        }
+
+    private:
+        [[nodiscard]] double *bidRows() const { return reinterpret_cast<double *>(base_ + rowsOffset()); }
+        [[nodiscard]] double *askRows() const { return bidRows() + header()->rowCapacity; }
+        [[nodiscard]] TradeSlot *tradeSlots() const
+        {
+            return reinterpret_cast<TradeSlot *>(base_ + tradesOffset(header()->rowCapacity));
+        }
+
+        char *base_{nullptr};
+        std::size_t size_{0};
+    };
+} // namespace dom::shm
@@ -0,0 +1,319 @@
+#pragma once
+
+// Binary framing for orderbook_backend stdout (`--protocol binary`).
+//
+// Every frame is an 8-byte header followed by the payload:
+//   u8  magic (kFrameMagic, never the first byte of a JSON line)
+//   u8  FrameType
+//   u16 book id (always 0 unless the backend runs with --symbols)
+//   u32 payload size in bytes
+// All integers/doubles are little-endian and packed without padding, so the
+// reader can mix frames and legacy JSON lines on the same stream.
+//
+// Ladder payload (full and delta share the header part):
+//   i64 timestamp, f64 bestBid, f64 bestAsk, f64 tickSize,
+//   i64 windowMinTick, i64 windowMaxTick, i64 centerTick
+//   full:  u32 n, f64 bid[n], f64 ask[n]            (row i is tick windowMax - i)
+//   delta: u32 n, i64 tick[n], f64 bid[n], f64 ask[n], u32 m, i64 removal[m]
+// Trade payload:
+//   i64 timestamp, i64 tick, f64 price, f64 qty, u8 flags (TradeFlag)
+// Shared-memory doorbells (`--shm`): ShmLadder carries only the ladder header,
+// ShmTrades is empty.
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace dom::wire
+{
+    static_assert(std::endian::native == std::endian::little, "wire format assumes a little-endian host");
+
+    constexpr std::uint8_t kFrameMagic = 0xB7;
+    constexpr std::size_t kFrameHeaderSize = 8;
+    // Upper bound for a sane frame; anything larger means the stream is out of sync.
+    constexpr std::uint32_t kMaxPayloadSize = 64u * 1024u * 1024u;
+
+    enum class FrameType : std::uint8_t
+    {
+        Ladder = 1,
+        LadderDelta = 2,
+        Trade = 3,
+        // Doorbells for the shared-memory transport (LadderShm.hpp).
+        ShmLadder = 4, // payload: LadderHeader, rows live in the segment
+        ShmTrades = 5, // empty payload, trades live in the segment ring
+        LadderSparse = 6, // full ladder listing only non-empty rows (--deep-book)
+    };
+
+    enum TradeFlag : std::uint8_t
+    {
+        TradeBuy = 1u << 0,
+        TradeHasTick = 1u << 1,
+        TradeHasTimestamp = 1u << 2,
+    };
+
+    struct LadderHeader
+    {
+        std::int64_t timestamp{};
+        double bestBid{};
+        double bestAsk{};
+        double tickSize{};
+        std::int64_t windowMinTick{};
+        std::int64_t windowMaxTick{};
+        std::int64_t centerTick{};
+    };
+
+    struct Trade
+    {
+        std::int64_t timestamp{};
+        std::int64_t tick{};
+        double price{};
+        double qty{};
+        std::uint8_t flags{};
+    };
+
+    // --- writer -----------------------------------------------------------
+
+    class FrameWriter
+    {
+    public:
+        void begin(FrameType type, std::uint16_t book = 0)
+        {
+            buf_.clear();
+            buf_.push_back(static_cast<char>(kFrameMagic));
+            buf_.push_back(static_cast<char>(type));
+            put<std::uint16_t>(book);
+            put<std::uint32_t>(0); // patched in finish()
+        }
+
+        template <typename T>
+        void put(T v)
+        {
+            const auto at = buf_.size();
+            buf_.resize(at + sizeof(T));
+            std::memcpy(buf_.data() + at, &v, sizeof(T));
+        }
+
+        template <typename T>
+        void putArray(const T *data, std::size_t n)
+        {
+            if (n == 0)
+            {
+                return;
+            }
+            const auto at = buf_.size();
+            buf_.resize(at + n * sizeof(T));
+            std::memcpy(buf_.data() + at, data, n * sizeof(T));
+        }
+
+        void putHeader(const LadderHeader &h)
+        {
+            put(h.timestamp);
+            put(h.bestBid);
+            put(h.bestAsk);
+            put(h.tickSize);
+            put(h.windowMinTick);
+            put(h.windowMaxTick);
+            put(h.centerTick);
+        }
+
+        // Returns the finished frame (header + payload).
+        const std::string &finish()
+        {
+            const auto payload = static_cast<std::uint32_t>(buf_.size() - kFrameHeaderSize);
+            std::memcpy(buf_.data() + 4, &payload, sizeof(payload));
+            return buf_;
+        }
+
+    private:
+        std::string buf_;
+    };
+
+    // --- reader -----------------------------------------------------------
+
+    struct FrameHeader
+    {
+        FrameType type{};
+        std::uint16_t book{0};
+        std::uint32_t payloadSize{0};
+    };
+
+    // `data` must point at kFrameHeaderSize bytes starting with kFrameMagic.
+    inline FrameHeader readFrameHeader(const char *data)
+    {
+        FrameHeader h;
+        h.type = static_cast<FrameType>(static_cast<std::uint8_t>(data[1]));
+        std::memcpy(&h.book, data + 2, sizeof(h.book));
+        std::memcpy(&h.payloadSize, data + 4, sizeof(h.payloadSize));
+        return h;
+    }
+
+    // Bounds-checked cursor over one payload. Any short read flips ok() to false.
+    class PayloadReader
+    {
+    public:
+        PayloadReader(const char *data, std::size_t size) : data_(data), size_(size) {}
+
+        template <typename T>
+        T get()
+        {
+            T v{};
+            if (!ok_ || size_ - pos_ < sizeof(T))
+            {
+                ok_ = false;
+                return v;
+            }
+            std::memcpy(&v, data_ + pos_, sizeof(T));
+            pos_ += sizeof(T);
+            return v;
+        }
+
+        // Returns a pointer to n packed T values (unaligned; read with at<T>()).
+        template <typename T>
+        const char *array(std::size_t n)
+        {
+            if (!ok_ || n > (size_ - pos_) / sizeof(T))
+            {
+                ok_ = false;
+                return nullptr;
+            }
+            const char *p = data_ + pos_;
+            pos_ += n * sizeof(T);
+            return p;
+        }
+
+        LadderHeader header()
+        {
+            LadderHeader h;
+            h.timestamp = get<std::int64_t>();
+            h.bestBid = get<double>();
+            h.bestAsk = get<double>();
+            h.tickSize = get<double>();
+            h.windowMinTick = get<std::int64_t>();
+            h.windowMaxTick = get<std::int64_t>();
+            h.centerTick = get<std::int64_t>();
+            return h;
+        }
+
+        [[nodiscard]] bool ok() const { return ok_; }
+
+    private:
+        const char *data_;
+        std::size_t size_;
+        std::size_t pos_{0};
+        bool ok_{true};
+    };
+
+    // Splits a stdout byte stream into frames and legacy JSON lines.
+    // onFrame(const FrameHeader &, const char *payload) and
+    // onLine(const char *line, std::size_t length) are called in stream order.
+    // Returns the number of bytes consumed; a trailing partial frame/line is left
+    // for the next call. Sets `desync` (and stops) on an impossible frame size.
+    template <typename OnFrame, typename OnLine>
+    std::size_t consumeStream(const char *data, std::size_t size, OnFrame &&onFrame, OnLine &&onLine, bool &desync)
+    {
+        desync = false;
+        std::size_t pos = 0;
+        while (pos < size)
+        {
+            if (static_cast<std::uint8_t>(data[pos]) == kFrameMagic)
+            {
+                if (size - pos < kFrameHeaderSize)
+                {
+                    break;
+                }
+                const FrameHeader header = readFrameHeader(data + pos);
+                if (header.payloadSize > kMaxPayloadSize)
+                {
+                    desync = true;
+                    break;
+                }
+                const std::size_t frameSize = kFrameHeaderSize + header.payloadSize;
+                if (size - pos < frameSize)
+                {
+                    break;
+                }
+                onFrame(header, data + pos + kFrameHeaderSize);
+                pos += frameSize;
+                continue;
+            }
+
+            const void *nl = std::memchr(data + pos, '\n', size - pos);
+            if (!nl)
+            {
+                break;
+            }
+            const auto end = static_cast<std::size_t>(static_cast<const char *>(nl) - data);
+            onLine(data + pos, end - pos);
+            pos = end + 1;
+        }
+        return pos;
+    }
+
+    template <typename T>
+    inline T at(const char *packed, std::size_t index)
+    {
+        T v;
+        std::memcpy(&v, packed + index * sizeof(T), sizeof(T));
+        return v;
+    }
+
+    // Parsed views over a ladder payload; arrays point into the frame buffer.
+    struct LadderFrame
+    {
+        LadderHeader header;
+        std::uint32_t rowCount{0};
+        const char *ticks{nullptr}; // delta and sparse only; dense full frames imply windowMax - i
+        const char *bids{nullptr};
+        const char *asks{nullptr};
+        std::uint32_t removalCount{0};
+        const char *removals{nullptr};
+
+        [[nodiscard]] std::int64_t tickAt(std::size_t i) const
+        {
+            return ticks ? at<std::int64_t>(ticks, i) : header.windowMaxTick - static_cast<std::int64_t>(i);
+        }
+        [[nodiscard]] double bidAt(std::size_t i) const { return at<double>(bids, i); }
+        [[nodiscard]] double askAt(std::size_t i) const { return at<double>(asks, i); }
+        [[nodiscard]] std::int64_t removalAt(std::size_t i) const { return at<std::int64_t>(removals, i); }
+    };
+
+    inline bool parseLadder(FrameType type, const char *payload, std::size_t size, LadderFrame &out)
+    {
+        PayloadReader r(payload, size);
+        out = LadderFrame{};
+        out.header = r.header();
+        out.rowCount = r.get<std::uint32_t>();
+        if (type == FrameType::LadderDelta || type == FrameType::LadderSparse)
+        {
+            out.ticks = r.array<std::int64_t>(out.rowCount);
+        }
+        out.bids = r.array<double>(out.rowCount);
+        out.asks = r.array<double>(out.rowCount);
+        if (type == FrameType::LadderDelta)
+        {
+            out.removalCount = r.get<std::uint32_t>();
+            out.removals = r.array<std::int64_t>(out.removalCount);
+        }
+        return r.ok();
+    }
+
+    inline bool parseLadderHeader(const char *payload, std::size_t size, LadderHeader &out)
+    {
+        PayloadReader r(payload, size);
+        out = r.header();
+        return r.ok();
+    }
+
+    inline bool parseTrade(const char *payload, std::size_t size, Trade &out)
+    {
+        PayloadReader r(payload, size);
+        out.timestamp = r.get<std::int64_t>();
+        out.tick = r.get<std::int64_t>();
+        out.price = r.get<double>();
+        out.qty = r.get<double>();
+        out.flags = r.get<std::uint8_t>();
+        return r.ok();
+    }
+} // namespace dom::wire
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "FlatBookSide.hpp"
+
 #include <cstdint>
 #include <map>
 #include <string>
@@ -19,10 +21,22 @@ namespace dom
     public:
         using Tick = std::int64_t;
 
+        // Level storage. Both engines produce identical ladders; Flat keeps a
+        // tick-indexed ring around the mid instead of a red-black tree.
+        enum class Storage
+        {
+            Map,
+            Flat
+        };
+
         OrderBook();
 
         void clear();
 
+        // Switching storage drops the current book (reload a snapshot afterwards).
+        void setStorage(Storage storage);
+        [[nodiscard]] Storage storage() const { return storage_; }
+
         // Set tick size (price step) in quote currency.
         void setTickSize(double tickSize);
 
@@ -47,14 +61,48 @@ namespace dom
                                                 Tick *outWindowMax = nullptr,
                                                 Tick *outCenter = nullptr) const;
 
+        // The window ladder() would use (same centering inertia), without
+        // materializing rows. Returns false when there is nothing to show.
+        bool ladderWindow(std::size_t levelsPerSide, Tick &outWindowMin, Tick &outWindowMax, Tick &outCenter) const;
+
+        // Rows for [windowMin, windowMax], top (windowMax) first; reuses `out`.
+        void ladderRows(Tick windowMin, Tick windowMax, std::vector<Level>& out) const;
+
+        // The same rows compressed `compression` ticks per row, in the GUI's
+        // convention: row tick b (a multiple of compression) holds the bids of
+        // [b, b + c - 1] and the asks of [b - c + 1, b]. Rows run from
+        // `outTopBucket` down to the bucket holding windowMin's bids. Bucket
+        // sums are cached per compression and re-summed only after one of
+        // their ticks changed, so a zoomed-out ladder costs about what the raw
+        // one does.
+        void compressedLadderRows(Tick compression,
+                                  Tick windowMin,
+                                  Tick windowMax,
+                                  std::vector<Level>& out,
+                                  Tick& outTopBucket);
+
+        [[nodiscard]] double bidQuantityAt(Tick tick) const;
+        [[nodiscard]] double askQuantityAt(Tick tick) const;
+
+        // Change tracking for incremental ladder deltas. Every tick touched by
+        // applyDelta / cache pruning / crossed-book cleanup since the previous
+        // call is reported once, restricted to [windowMin, windowMax] and sorted
+        // top-down. Returns false when the changes are unknown (after clear(),
+        // a snapshot, or too many untaken changes) and a full ladder is needed.
+        bool takeChangedTicks(Tick windowMin, Tick windowMax, std::vector<Tick>& out);
+        void discardChanges();
+
         void shiftManualCenterTicks(Tick delta);
         void clearManualCenter();
 
     private:
         using BookSide = std::map<Tick, double, std::less<>>;
 
+        Storage storage_{Storage::Map};
         BookSide bids_; // key: tick index, value: qty
         BookSide asks_;
+        FlatBookSide flatBids_; // used instead of bids_/asks_ when storage_ == Flat
+        FlatBookSide flatAsks_;
         double tickSize_{0.0};
 
         // Center of the ladder in ticks; adjusted slowly to avoid jumping.
@@ -64,12 +112,48 @@ namespace dom
         mutable bool manualCenterActive_{false};
         std::size_t cacheLevelsPerSide_{5000};
 
+        // See takeChangedTicks(). Ranges come from pruning/cleanup and are
+        // clipped to the ladder window when taken.
+        std::vector<Tick> changedTicks_;
+        std::vector<std::pair<Tick, Tick>> changedRanges_;
+        bool changesUnknown_{true};
+        // Cache window kept by the last prune; only a narrowing of it removes levels.
+        Tick retainedMin_{0};
+        Tick retainedMax_{0};
+        bool hasRetained_{false};
+
+        // compressedLadderRows() cache, keyed by compression, then bucket tick.
+        // Any change to a tick drops the buckets holding it.
+        struct BucketSums
+        {
+            std::map<Tick, double> bids;
+            std::map<Tick, double> asks;
+        };
+        std::map<Tick, BucketSums> bucketSums_;
+
         static void applySide(BookSide& side,
                               const std::vector<std::pair<Tick, double>>& updates);
+        static void applySide(FlatBookSide& side,
+                              const std::vector<std::pair<Tick, double>>& updates);
         static void pruneOutsideWindow(BookSide& side, Tick minTick, Tick maxTick);
         bool resolveAutoCenterTick(Tick& outTick) const;
         void pruneToCacheWindow(Tick anchorTick);
+        void noteChanged(const std::vector<std::pair<Tick, double>>& updates);
+        void noteChangedRange(Tick fromTick, Tick toTick);
+        void invalidateBuckets(Tick fromTick, Tick toTick);
+        [[nodiscard]] double sumBids(Tick fromTick, Tick toTick) const;
+        [[nodiscard]] double sumAsks(Tick fromTick, Tick toTick) const;
+
+        // Storage-agnostic accessors; callers check hasBids()/hasAsks() first.
+        [[nodiscard]] bool hasBids() const;
+        [[nodiscard]] bool hasAsks() const;
+        [[nodiscard]] Tick highestBidTick() const;
+        [[nodiscard]] Tick lowestBidTick() const;
+        [[nodiscard]] Tick highestAskTick() const;
+        [[nodiscard]] Tick lowestAskTick() const;
 
         static constexpr Tick kMaxLevels = 40000;
+        // Past this many untaken changes a full ladder is cheaper than the diff.
+        static constexpr std::size_t kMaxTrackedChanges = 2 * static_cast<std::size_t>(kMaxLevels);
     };
 } // namespace dom
@@ -0,0 +1,109 @@
+#pragma once
+
+// Raw exchange traffic on disk (`--record` / `--replay`).
+//
+// A recording is every WebSocket message and REST body the backend received,
+// in arrival order. Replaying it runs the same runners, decoders and ladder
+// emission with net::WebSocket / httpGet served from the file.
+//
+// File layout (little-endian, no padding):
+//   "OBREC001"
+//   record*: u8 RecordKind, i64 ns since the recording started (steady clock),
+//            u32 key size, u32 payload size, key bytes, payload bytes
+// Open and Http records carry the URL as key; messages have an empty key and
+// belong to the most recent Open (the backend keeps one socket at a time).
+
+#include "Transport.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace net
+{
+    enum class RecordKind : std::uint8_t
+    {
+        Open = 1,
+        Text = 2,
+        Binary = 3,
+        Http = 4,
+    };
+
+    // "host:port/path", the key stored with Open and Http records.
+    std::string urlKey(const Url &url);
+
+    class Recorder
+    {
+    public:
+        bool open(const std::string &path, std::string &error);
+
+        // Thread-safe; every record is flushed so a killed backend leaves a usable file.
+        void write(RecordKind kind, std::string_view key, std::string_view payload);
+
+        // Records every message `socket` receives; sends are not recorded.
+        std::unique_ptr<WebSocket> wrap(std::unique_ptr<WebSocket> socket, const Url &url);
+
+    private:
+        std::mutex mutex_;
+        std::ofstream out_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    class Replayer
+    {
+    public:
+        struct Stats
+        {
+            std::uint64_t messages{0};
+            std::uint64_t bytes{0};
+            std::chrono::steady_clock::duration elapsed{}; // first to last replayed message
+        };
+
+        // speed: 1 = recorded pace, N = N times faster, 0 = as fast as possible.
+        bool open(const std::string &path, double speed, std::string &error);
+
+        // The next recorded connection; nothing once the recording is exhausted.
+        std::unique_ptr<WebSocket> openWebSocket(const Url &url, std::string &error);
+
+        // The next recorded body for this URL, searched ahead of the socket stream.
+        std::optional<std::string> httpGet(const Url &url, std::string &error);
+
+        [[nodiscard]] Stats stats() const;
+
+    private:
+        friend class ReplayWebSocket;
+
+        struct Record
+        {
+            RecordKind kind{RecordKind::Text};
+            std::int64_t ns{0};
+            std::string key;
+            std::string payload;
+        };
+
+        bool readRecord(Record &out);
+        // Next Open/Text/Binary record; Http records met on the way are parked.
+        bool nextStreamRecord(Record &out);
+        // Delivers the next message of the current connection, paced by speed_.
+        bool nextMessage(Record &out);
+        void pace(std::int64_t ns);
+
+        mutable std::mutex mutex_;
+        std::ifstream in_;
+        double speed_{1.0};
+        std::deque<Record> pendingStream_;
+        std::unordered_map<std::string, std::deque<std::string>> pendingHttp_;
+        bool paceStarted_{false};
+        std::int64_t firstNs_{0};
+        std::chrono::steady_clock::time_point firstWall_{};
+        std::chrono::steady_clock::time_point lastWall_{};
+        Stats stats_;
+    };
+} // namespace net
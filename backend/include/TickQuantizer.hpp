@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <string_view>
+
+namespace dom
+{
+    // Price -> tick conversion for one tick size.
+    //
+    // The decimal scale (smallest 10^d that makes tickSize an integer) and the
+    // scaled tick are derived once instead of on every price. quantize() gives
+    // the same answer as the original per-call scale search; tickFromDecimal()
+    // skips the double round trip entirely for plain decimal strings such as
+    // "64123.45" and returns exactly what quantize(std::stod(text)) would.
+    class TickQuantizer
+    {
+    public:
+        using Tick = std::int64_t;
+
+        TickQuantizer() = default;
+
+        explicit TickQuantizer(double tickSize) : tickSize_(tickSize)
+        {
+            if (!(tickSize > 0.0) || !std::isfinite(tickSize))
+            {
+                return;
+            }
+            std::int64_t scale = 1;
+            for (int decimals = 0; decimals <= kMaxDecimals; ++decimals, scale *= 10)
+            {
+                const double scaledTickSizeD = tickSize * static_cast<double>(scale);
+                if (!std::isfinite(scaledTickSizeD))
+                {
+                    continue;
+                }
+                const std::int64_t tickSizeScaled = static_cast<std::int64_t>(std::llround(scaledTickSizeD));
+                if (tickSizeScaled <= 0 || std::abs(scaledTickSizeD - static_cast<double>(tickSizeScaled)) > 1e-9)
+                {
+                    continue;
+                }
+                decimals_ = decimals;
+                scale_ = scale;
+                tickScaled_ = tickSizeScaled;
+                return;
+            }
+        }
+
+        [[nodiscard]] bool valid() const { return tickScaled_ > 0; }
+        [[nodiscard]] double tickSize() const { return tickSize_; }
+
+        // False for non-positive/non-finite prices or an unusable tick size.
+        bool quantize(double price, Tick &outTick, double &outSnappedPrice) const
+        {
+            if (!valid() || !(price > 0.0) || !std::isfinite(price))
+            {
+                return false;
+            }
+            const std::int64_t priceScaled = static_cast<std::int64_t>(std::llround(price * static_cast<double>(scale_)));
+            outTick = roundToTick(priceScaled);
+            outSnappedPrice = static_cast<double>(outTick * tickScaled_) / static_cast<double>(scale_);
+            return std::isfinite(outSnappedPrice);
+        }
+
+        // Integer-only path for "123", "123.45", ".5". Returns false (caller
+        // falls back to the double path) for signs, exponents, zero, more
+        // fractional digits than the tick has, or more than kMaxDigits scaled
+        // digits - the cases where the double path could round differently.
+        bool tickFromDecimal(std::string_view text, Tick &outTick) const
+        {
+            if (!valid() || text.empty())
+            {
+                return false;
+            }
+            std::int64_t scaled = 0;
+            int digits = 0;
+            int fraction = -1; // digits seen after '.', -1 before it
+            for (const char c : text)
+            {
+                if (c == '.')
+                {
+                    if (fraction >= 0)
+                    {
+                        return false;
+                    }
+                    fraction = 0;
+                    continue;
+                }
+                if (c < '0' || c > '9')
+                {
+                    return false;
+                }
+                if (fraction >= 0 && ++fraction > decimals_)
+                {
+                    // Trailing zeros beyond the tick precision are harmless.
+                    if (c != '0')
+                    {
+                        return false;
+                    }
+                    continue;
+                }
+                if (scaled != 0 || c != '0')
+                {
+                    if (++digits > kMaxDigits)
+                    {
+                        return false;
+                    }
+                }
+                scaled = scaled * 10 + (c - '0');
+            }
+            for (int pad = fraction < 0 ? 0 : fraction; pad < decimals_; ++pad)
+            {
+                if (scaled != 0 && ++digits > kMaxDigits)
+                {
+                    return false;
+                }
+                scaled *= 10;
+            }
+            if (scaled <= 0)
+            {
+                return false;
+            }
+            outTick = roundToTick(scaled);
+            return true;
+        }
+
+    private:
+        [[nodiscard]] Tick roundToTick(std::int64_t priceScaled) const
+        {
+            if (priceScaled >= 0)
+            {
+                return (priceScaled + tickScaled_ / 2) / tickScaled_;
+            }
+            return -((-priceScaled + tickScaled_ / 2) / tickScaled_);
+        }
+
+        static constexpr int kMaxDecimals = 12;
+        // Up to 15 significant digits stod(text) * 10^d still rounds back to the exact integer.
+        static constexpr int kMaxDigits = 15;
+
+        double tickSize_{0.0};
+        int decimals_{0};
+        std::int64_t scale_{1};
+        std::int64_t tickScaled_{0};
+    };
+} // namespace dom
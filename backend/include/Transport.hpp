@@ -0,0 +1,131 @@
+#pragma once
+
+// Blocking WebSocket / HTTP GET client used by the exchange runners.
+//
+// One implementation per platform:
+//   TransportWinHttp.cpp - Windows, WinHTTP (the original transport)
+//   TransportQt.cpp      - everywhere else, Qt Network + Qt WebSockets
+// With ORDERBOOK_BACKEND_QT the Qt implementation is also available on Windows
+// as net::qt::*, which the backend prefers for proxied connections.
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace net
+{
+    struct Proxy
+    {
+        std::string type{"http"}; // http | socks5
+        std::string host;         // empty = no proxy
+        int port{0};
+        std::string user;
+        std::string pass;
+
+        [[nodiscard]] bool enabled() const { return !host.empty(); }
+    };
+
+    struct Url
+    {
+        bool secure{true};
+        std::string host;
+        std::uint16_t port{443};
+        std::string path{"/"}; // path plus query
+    };
+
+    // Accepts ws://, wss://, http:// and https:// with an optional :port.
+    inline bool parseUrl(std::string_view text, Url &out)
+    {
+        Url url;
+        std::string_view rest;
+        if (text.substr(0, 6) == "wss://" || text.substr(0, 8) == "https://")
+        {
+            url.secure = true;
+            rest = text.substr(text[0] == 'w' ? 6 : 8);
+        }
+        else if (text.substr(0, 5) == "ws://" || text.substr(0, 7) == "http://")
+        {
+            url.secure = false;
+            rest = text.substr(text[0] == 'w' ? 5 : 7);
+        }
+        else
+        {
+            return false;
+        }
+        url.port = url.secure ? 443 : 80;
+
+        const std::size_t slash = rest.find('/');
+        std::string_view authority = rest.substr(0, slash);
+        if (slash != std::string_view::npos)
+        {
+            url.path.assign(rest.substr(slash));
+        }
+        const std::size_t colon = authority.rfind(':');
+        if (colon != std::string_view::npos)
+        {
+            const std::string_view portText = authority.substr(colon + 1);
+            unsigned port = 0;
+            for (const char c : portText)
+            {
+                if (c < '0' || c > '9' || port > 65535)
+                {
+                    return false;
+                }
+                port = port * 10 + static_cast<unsigned>(c - '0');
+            }
+            if (portText.empty() || port == 0 || port > 65535)
+            {
+                return false;
+            }
+            url.port = static_cast<std::uint16_t>(port);
+            authority = authority.substr(0, colon);
+        }
+        if (authority.empty())
+        {
+            return false;
+        }
+        url.host.assign(authority);
+        out = std::move(url);
+        return true;
+    }
+
+    enum class MessageType
+    {
+        Text,
+        Binary,
+    };
+
+    // Messages larger than this are skipped instead of buffered.
+    constexpr std::size_t kMaxMessageSize = 4 * 1024 * 1024;
+
+    class WebSocket
+    {
+    public:
+        virtual ~WebSocket() = default;
+
+        // Safe to call from a thread other than the one calling receive().
+        virtual bool sendText(std::string_view text) = 0;
+
+        // Blocks for the next complete message (fragments are joined). `out` is
+        // overwritten, so a buffer reused across calls keeps its capacity.
+        // Returns false once the connection is closed or broken; see error().
+        virtual bool receive(std::string &out, MessageType &type) = 0;
+
+        virtual void close() = 0;
+        [[nodiscard]] virtual const std::string &error() const = 0;
+    };
+
+    // Both return nothing on failure and describe the reason in `error`.
+    std::unique_ptr<WebSocket> openWebSocket(const Url &url, const Proxy &proxy, std::string &error);
+    std::optional<std::string> httpGet(const Url &url, const Proxy &proxy, std::string &error);
+
+#if defined(ORDERBOOK_BACKEND_QT)
+    namespace qt
+    {
+        std::unique_ptr<WebSocket> openWebSocket(const Url &url, const Proxy &proxy, std::string &error);
+        std::optional<std::string> httpGet(const Url &url, const Proxy &proxy, std::string &error, int timeoutMs = 15000);
+    } // namespace qt
+#endif
+} // namespace net
@@ -0,0 +1,349 @@
+#include "FlatBookSide.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace dom
+{
+    namespace
+    {
+        std::size_t roundUpPow2(std::size_t v)
+        {
+            std::size_t p = 1;
+            while (p < v)
+            {
+                p <<= 1;
+            }
+            return p;
+        }
+    } // namespace
+
+    FlatBookSide::FlatBookSide()
+    {
+        slots_.assign(kMinCapacity, 0.0);
+        mask_ = static_cast<std::uint64_t>(kMinCapacity - 1);
+    }
+
+    void FlatBookSide::reserveSpan(std::size_t spanPerSide)
+    {
+        const std::size_t needed = std::max(kMinCapacity, roundUpPow2(spanPerSide * 2 + 1));
+        if (needed <= slots_.size())
+        {
+            return;
+        }
+
+        // Growing re-hashes every level (tick & mask changes), so collect and re-insert.
+        std::vector<std::pair<Tick, double>> levels;
+        levels.reserve(count_ + spill_.size());
+        if (count_ > 0)
+        {
+            for (Tick tick = lo_; tick <= hi_; ++tick)
+            {
+                const double qty = slot(tick);
+                if (qty != 0.0)
+                {
+                    levels.emplace_back(tick, qty);
+                }
+            }
+        }
+        for (const auto &[tick, qty] : spill_)
+        {
+            levels.emplace_back(tick, qty);
+        }
+        const bool hadRing = count_ > 0;
+        const Tick mid = hadRing ? lo_ + (hi_ - lo_) / 2 : Tick{0};
+
+        slots_.assign(needed, 0.0);
+        mask_ = static_cast<std::uint64_t>(needed - 1);
+        anchored_ = false;
+        count_ = 0;
+        spill_.clear();
+
+        if (hadRing)
+        {
+            anchorAround(mid);
+        }
+        for (const auto &[tick, qty] : levels)
+        {
+            set(tick, qty);
+        }
+    }
+
+    void FlatBookSide::clear()
+    {
+        if (count_ > 0)
+        {
+            for (Tick tick = lo_; tick <= hi_; ++tick)
+            {
+                slot(tick) = 0.0;
+            }
+        }
+        count_ = 0;
+        anchored_ = false;
+        spill_.clear();
+    }
+
+    double FlatBookSide::get(Tick tick) const
+    {
+        if (covers(tick))
+        {
+            return slot(tick);
+        }
+        if (spill_.empty())
+        {
+            return 0.0;
+        }
+        auto it = spill_.find(tick);
+        return it != spill_.end() ? it->second : 0.0;
+    }
+
+    void FlatBookSide::set(Tick tick, double qty)
+    {
+        if (qty <= 0.0)
+        {
+            if (!covers(tick))
+            {
+                spill_.erase(tick);
+                return;
+            }
+            double &cell = slot(tick);
+            if (cell == 0.0)
+            {
+                return;
+            }
+            cell = 0.0;
+            --count_;
+            if (count_ == 0)
+            {
+                return;
+            }
+            if (tick == hi_)
+            {
+                rescanHighest(tick - 1);
+            }
+            if (tick == lo_)
+            {
+                rescanLowest(tick + 1);
+            }
+            return;
+        }
+
+        if ((!anchored_ || count_ == 0) && !covers(tick))
+        {
+            // An empty ring can be moved for free; spilled levels it now covers
+            // must move in so lookups never see a stale empty slot.
+            anchorAround(tick);
+            absorbSpill();
+        }
+        if (!covers(tick))
+        {
+            spill_[tick] = qty;
+            return;
+        }
+        double &cell = slot(tick);
+        if (cell == 0.0)
+        {
+            if (count_ == 0)
+            {
+                hi_ = tick;
+                lo_ = tick;
+            }
+            else
+            {
+                hi_ = std::max(hi_, tick);
+                lo_ = std::min(lo_, tick);
+            }
+            ++count_;
+        }
+        cell = qty;
+    }
+
+    void FlatBookSide::add(Tick tick, double qty)
+    {
+        set(tick, get(tick) + qty);
+    }
+
+    FlatBookSide::Tick FlatBookSide::highest() const
+    {
+        if (spill_.empty())
+        {
+            return hi_;
+        }
+        const Tick spillHi = spill_.rbegin()->first;
+        return count_ > 0 ? std::max(hi_, spillHi) : spillHi;
+    }
+
+    FlatBookSide::Tick FlatBookSide::lowest() const
+    {
+        if (spill_.empty())
+        {
+            return lo_;
+        }
+        const Tick spillLo = spill_.begin()->first;
+        return count_ > 0 ? std::min(lo_, spillLo) : spillLo;
+    }
+
+    void FlatBookSide::retainRange(Tick minTick, Tick maxTick)
+    {
+        if (minTick > maxTick)
+        {
+            clear();
+            return;
+        }
+
+        if (!spill_.empty())
+        {
+            spill_.erase(spill_.begin(), spill_.lower_bound(minTick));
+            spill_.erase(spill_.upper_bound(maxTick), spill_.end());
+        }
+
+        // Every occupied slot lies in [lo_, hi_], so pruning only touches the
+        // ticks the window actually slid over.
+        if (count_ > 0 && lo_ < minTick)
+        {
+            clearRingRange(lo_, minTick - 1);
+            if (count_ > 0)
+            {
+                rescanLowest(minTick);
+            }
+        }
+        if (count_ > 0 && hi_ > maxTick)
+        {
+            clearRingRange(maxTick + 1, hi_);
+            if (count_ > 0)
+            {
+                rescanHighest(maxTick);
+            }
+        }
+
+        // Re-anchor so the retained range sits in the middle of the ring. Slots
+        // are addressed by absolute tick, so moving base_ is O(1): every
+        // occupied slot is inside [minTick, maxTick] and keeps its index.
+        const auto capacity = static_cast<Tick>(slots_.size());
+        const Tick width = maxTick - minTick;
+        if (width >= 0 && width < capacity && !(covers(minTick) && covers(maxTick)))
+        {
+            const Tick slack = (capacity - (width + 1)) / 2;
+            base_ = (minTick < std::numeric_limits<Tick>::min() + slack) ? std::numeric_limits<Tick>::min()
+                                                                           : minTick - slack;
+            anchored_ = true;
+        }
+
+        absorbSpill();
+    }
+
+    void FlatBookSide::eraseFrom(Tick fromTick)
+    {
+        if (!spill_.empty())
+        {
+            spill_.erase(spill_.lower_bound(fromTick), spill_.end());
+        }
+        if (count_ == 0 || hi_ < fromTick)
+        {
+            return;
+        }
+        clearRingRange(std::max(fromTick, lo_), hi_);
+        if (count_ > 0)
+        {
+            rescanHighest(fromTick - 1);
+        }
+    }
+
+    void FlatBookSide::eraseUpTo(Tick toTick)
+    {
+        if (!spill_.empty())
+        {
+            spill_.erase(spill_.begin(), spill_.upper_bound(toTick));
+        }
+        if (count_ == 0 || lo_ > toTick)
+        {
+            return;
+        }
+        clearRingRange(lo_, std::min(toTick, hi_));
+        if (count_ > 0)
+        {
+            rescanLowest(toTick + 1);
+        }
+    }
+
+    void FlatBookSide::anchorAround(Tick tick)
+    {
+        const auto half = static_cast<Tick>(slots_.size() / 2);
+        base_ = (tick < std::numeric_limits<Tick>::min() + half) ? std::numeric_limits<Tick>::min()
+                                                                  : tick - half;
+        anchored_ = true;
+    }
+
+    void FlatBookSide::absorbSpill()
+    {
+        for (auto it = spill_.begin(); it != spill_.end();)
+        {
+            if (!covers(it->first))
+            {
+                ++it;
+                continue;
+            }
+            const auto level = *it;
+            it = spill_.erase(it);
+            double &cell = slot(level.first);
+            if (cell == 0.0)
+            {
+                if (count_ == 0)
+                {
+                    hi_ = level.first;
+                    lo_ = level.first;
+                }
+                else
+                {
+                    hi_ = std::max(hi_, level.first);
+                    lo_ = std::min(lo_, level.first);
+                }
+                ++count_;
+            }
+            cell = level.second;
+        }
+    }
+
+    void FlatBookSide::clearRingRange(Tick fromTick, Tick toTick)
+    {
+        for (Tick tick = fromTick; tick <= toTick && count_ > 0; ++tick)
+        {
+            double &cell = slot(tick);
+            if (cell != 0.0)
+            {
+                cell = 0.0;
+                --count_;
+            }
+            if (tick == std::numeric_limits<Tick>::max())
+            {
+                break;
+            }
+        }
+    }
+
+    void FlatBookSide::rescanHighest(Tick startTick)
+    {
+        // count_ > 0 guarantees an occupied slot at or below startTick.
+        for (Tick tick = std::min(startTick, hi_); tick >= lo_; --tick)
+        {
+            if (slot(tick) != 0.0)
+            {
+                hi_ = tick;
+                return;
+            }
+        }
+    }
+
+    void FlatBookSide::rescanLowest(Tick startTick)
+    {
+        for (Tick tick = std::max(startTick, lo_); tick <= hi_; ++tick)
+        {
+            if (slot(tick) != 0.0)
+            {
+                lo_ = tick;
+                return;
+            }
+        }
+    }
+} // namespace dom
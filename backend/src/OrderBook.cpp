@@ -11,9 +11,30 @@ namespace dom
     {
         bids_.clear();
         asks_.clear();
+        flatBids_.clear();
+        flatAsks_.clear();
         // tickSize_ is configured separately via setTickSize()
         centerTick_ = 0;
         hasCenter_ = false;
+        changedTicks_.clear();
+        changedRanges_.clear();
+        changesUnknown_ = true;
+        hasRetained_ = false;
+        for (auto& entry : bucketSums_)
+        {
+            entry.second.bids.clear();
+            entry.second.asks.clear();
+        }
+    }
+
+    void OrderBook::setStorage(Storage storage)
+    {
+        if (storage == storage_)
+        {
+            return;
+        }
+        clear();
+        storage_ = storage;
     }
 
     void OrderBook::setTickSize(double tickSize)
@@ -30,6 +51,8 @@ namespace dom
         }
         const std::size_t maxPerSide = static_cast<std::size_t>(kMaxLevels / 2);
         cacheLevelsPerSide_ = std::min(levels, maxPerSide);
+        flatBids_.reserveSpan(cacheLevelsPerSide_);
+        flatAsks_.reserveSpan(cacheLevelsPerSide_);
     }
 
     void OrderBook::loadSnapshot(const std::vector<std::pair<Tick, double>>& bids,
@@ -41,7 +64,14 @@ namespace dom
         {
             if (qty > 0.0)
             {
-                bids_[tick] += qty;
+                if (storage_ == Storage::Flat)
+                {
+                    flatBids_.add(tick, qty);
+                }
+                else
+                {
+                    bids_[tick] += qty;
+                }
             }
         }
 
@@ -49,7 +79,14 @@ namespace dom
         {
             if (qty > 0.0)
             {
-                asks_[tick] += qty;
+                if (storage_ == Storage::Flat)
+                {
+                    flatAsks_.add(tick, qty);
+                }
+                else
+                {
+                    asks_[tick] += qty;
+                }
             }
         }
 
@@ -64,12 +101,22 @@ namespace dom
                                const std::vector<std::pair<Tick, double>>& asks,
                                std::size_t cacheLevelsHint)
     {
-        applySide(bids_, bids);
-        applySide(asks_, asks);
+        if (storage_ == Storage::Flat)
+        {
+            applySide(flatBids_, bids);
+            applySide(flatAsks_, asks);
+        }
+        else
+        {
+            applySide(bids_, bids);
+            applySide(asks_, asks);
+        }
+        noteChanged(bids);
+        noteChanged(asks);
 
         // Чтобы не держать бесконечный хвост старых уровней, которые уже ушли
         // далеко от текущего мида, чистим карту за окном вокруг середины.
-        if (tickSize_ <= 0.0 || (bids_.empty() && asks_.empty())) {
+        if (tickSize_ <= 0.0 || (!hasBids() && !hasAsks())) {
             return;
         }
 
@@ -85,17 +132,24 @@ namespace dom
 
         // Защитный инвариант: bestBid < bestAsk. Если данные пришли кривые или
         // из-за округления стороны пересеклись, вычищаем перекрытие.
-        if (!bids_.empty() && !asks_.empty() && bids_.rbegin()->first >= asks_.begin()->first) {
-            const Tick askTick = asks_.begin()->first;
-            const Tick bidTick = bids_.rbegin()->first;
-            // Удаляем бидовые уровни, которые не могут существовать выше/на ask.
-            auto badBidIt = bids_.lower_bound(askTick);
-            while (badBidIt != bids_.end()) {
-                badBidIt = bids_.erase(badBidIt);
+        if (hasBids() && hasAsks() && highestBidTick() >= lowestAskTick()) {
+            const Tick askTick = lowestAskTick();
+            const Tick bidTick = highestBidTick();
+            noteChangedRange(askTick, std::numeric_limits<Tick>::max());
+            noteChangedRange(std::numeric_limits<Tick>::min(), bidTick);
+            if (storage_ == Storage::Flat) {
+                flatBids_.eraseFrom(askTick);
+                flatAsks_.eraseUpTo(bidTick);
+            } else {
+                // Удаляем бидовые уровни, которые не могут существовать выше/на ask.
+                auto badBidIt = bids_.lower_bound(askTick);
+                while (badBidIt != bids_.end()) {
+                    badBidIt = bids_.erase(badBidIt);
+                }
+                // И удаляем аски, которые не могут быть ниже/на bid.
+                auto badAskEnd = asks_.upper_bound(bidTick);
+                asks_.erase(asks_.begin(), badAskEnd);
             }
-            // И удаляем аски, которые не могут быть ниже/на bid.
-            auto badAskEnd = asks_.upper_bound(bidTick);
-            asks_.erase(asks_.begin(), badAskEnd);
             // Сдвигаем центр при сильной чистке.
             hasCenter_ = false;
         }
@@ -103,21 +157,21 @@ namespace dom
 
     double OrderBook::bestBid() const
     {
-        if (bids_.empty() || tickSize_ <= 0.0)
+        if (!hasBids() || tickSize_ <= 0.0)
         {
             return 0.0;
         }
-        const Tick tick = bids_.rbegin()->first;
+        const Tick tick = highestBidTick();
         return static_cast<double>(tick) * tickSize_;
     }
 
     double OrderBook::bestAsk() const
     {
-        if (asks_.empty() || tickSize_ <= 0.0)
+        if (!hasAsks() || tickSize_ <= 0.0)
         {
             return 0.0;
         }
-        const Tick tick = asks_.begin()->first;
+        const Tick tick = lowestAskTick();
         return static_cast<double>(tick) * tickSize_;
     }
 
@@ -132,15 +186,42 @@ namespace dom
                                          Tick *outCenter) const
     {
         std::vector<Level> result;
+        Tick minTick = 0;
+        Tick maxTick = 0;
+        Tick center = 0;
+        if (!ladderWindow(levelsPerSide, minTick, maxTick, center))
+        {
+            return result;
+        }
+        if (outWindowMin)
+        {
+            *outWindowMin = minTick;
+        }
+        if (outWindowMax)
+        {
+            *outWindowMax = maxTick;
+        }
+        if (outCenter)
+        {
+            *outCenter = center;
+        }
+        ladderRows(minTick, maxTick, result);
+        return result;
+    }
 
+    bool OrderBook::ladderWindow(std::size_t levelsPerSide,
+                                 Tick &outWindowMin,
+                                 Tick &outWindowMax,
+                                 Tick &outCenter) const
+    {
         if (tickSize_ <= 0.0)
         {
-            return result;
+            return false;
         }
 
-        if (bids_.empty() && asks_.empty())
+        if (!hasBids() && !hasAsks())
         {
-            return result;
+            return false;
         }
 
         // Center around best bid / best ask with some inertia
@@ -155,28 +236,28 @@ namespace dom
         }
         else
         {
-            if (!bids_.empty() && !asks_.empty())
+            if (hasBids() && hasAsks())
             {
-                const Tick bestBidTick = bids_.rbegin()->first;
-                const Tick bestAskTick = asks_.begin()->first;
+                const Tick bestBidTick = highestBidTick();
+                const Tick bestAskTick = lowestAskTick();
                 midTick = (bestBidTick + bestAskTick) / 2;
                 hasMid = true;
             }
-            else if (!bids_.empty())
+            else if (hasBids())
             {
-                midTick = bids_.rbegin()->first;
+                midTick = highestBidTick();
                 hasMid = true;
             }
-            else if (!asks_.empty())
+            else if (hasAsks())
             {
-                midTick = asks_.begin()->first;
+                midTick = lowestAskTick();
                 hasMid = true;
             }
         }
 
         if (!hasMid)
         {
-            return result;
+            return false;
         }
 
         constexpr Tick maxLevels = kMaxLevels;
@@ -189,86 +270,39 @@ namespace dom
             Tick minTick = std::numeric_limits<Tick>::max();
             Tick maxTick = std::numeric_limits<Tick>::min();
 
-            if (!bids_.empty())
+            if (hasBids())
             {
-                minTick = std::min(minTick, bids_.begin()->first);
-                maxTick = std::max(maxTick, bids_.rbegin()->first);
+                minTick = std::min(minTick, lowestBidTick());
+                maxTick = std::max(maxTick, highestBidTick());
             }
-            if (!asks_.empty())
+            if (hasAsks())
             {
-                minTick = std::min(minTick, asks_.begin()->first);
-                maxTick = std::max(maxTick, asks_.rbegin()->first);
+                minTick = std::min(minTick, lowestAskTick());
+                maxTick = std::max(maxTick, highestAskTick());
             }
 
             if (minTick > maxTick)
             {
-                return result;
+                return false;
             }
 
-            Tick count = maxTick - minTick + 1;
-            if (count > maxLevels)
+            if (maxTick - minTick + 1 > maxLevels)
             {
                 minTick = maxTick - (maxLevels - 1);
-                count = maxLevels;
             }
 
-            if (outWindowMin)
+            outWindowMin = minTick;
+            outWindowMax = maxTick;
+            if (manualCenterActive_)
             {
-                *outWindowMin = minTick;
-            }
-            if (outWindowMax)
-            {
-                *outWindowMax = maxTick;
-            }
-            if (outCenter)
-            {
-                if (manualCenterActive_)
-                {
-                    *outCenter = manualCenterTick_;
-                }
-                else
-                {
-                    Tick autoCenter = 0;
-                    if (resolveAutoCenterTick(autoCenter))
-                    {
-                        *outCenter = autoCenter;
-                    }
-                    else
-                    {
-                        *outCenter = 0;
-                    }
-                }
+                outCenter = manualCenterTick_;
             }
-
-            result.reserve(static_cast<std::size_t>(count));
-            for (Tick tick = maxTick; tick >= minTick; --tick)
+            else
             {
-                const double price = static_cast<double>(tick) * tickSize_;
-
-                double bidQty = 0.0;
-                double askQty = 0.0;
-
-                auto bidIt = bids_.find(tick);
-                if (bidIt != bids_.end())
-                {
-                    bidQty = bidIt->second;
-                }
-
-                auto askIt = asks_.find(tick);
-                if (askIt != asks_.end())
-                {
-                    askQty = askIt->second;
-                }
-
-                result.push_back(Level{price, bidQty, askQty});
-
-                if (tick == std::numeric_limits<Tick>::min())
-                {
-                    break;
-                }
+                Tick autoCenter = 0;
+                outCenter = resolveAutoCenterTick(autoCenter) ? autoCenter : 0;
             }
-
-            return result;
+            return true;
         }
 
         const Tick padding = static_cast<Tick>(levelsPerSide);
@@ -327,59 +361,132 @@ namespace dom
 
         if (maxTick < minTick)
         {
-            return result;
+            return false;
         }
 
-        Tick count = maxTick - minTick + 1;
-        if (count > maxLevels)
+        if (maxTick - minTick + 1 > maxLevels)
         {
             minTick = maxTick - (maxLevels - 1);
-            count = maxLevels;
         }
 
-        if (outWindowMin)
-        {
-            *outWindowMin = minTick;
-        }
-        if (outWindowMax)
-        {
-            *outWindowMax = maxTick;
-        }
-        if (outCenter)
+        outWindowMin = minTick;
+        outWindowMax = maxTick;
+        outCenter = centerTick_;
+        return true;
+    }
+
+    void OrderBook::ladderRows(Tick windowMin, Tick windowMax, std::vector<Level>& out) const
+    {
+        out.clear();
+        if (windowMax < windowMin)
         {
-            *outCenter = centerTick_;
+            return;
         }
+        out.reserve(static_cast<std::size_t>(windowMax - windowMin) + 1);
 
-        result.reserve(static_cast<std::size_t>(count));
-
-        for (Tick tick = maxTick; tick >= minTick; --tick)
+        for (Tick tick = windowMax; tick >= windowMin; --tick)
         {
             const double price = static_cast<double>(tick) * tickSize_;
 
-            double bidQty = 0.0;
-            double askQty = 0.0;
+            const double bidQty = bidQuantityAt(tick);
+            const double askQty = askQuantityAt(tick);
 
-            auto bidIt = bids_.find(tick);
-            if (bidIt != bids_.end())
+            out.push_back(Level{price, bidQty, askQty});
+
+            if (tick == std::numeric_limits<Tick>::min())
             {
-                bidQty = bidIt->second;
+                break; // prevent overflow on next --tick
             }
+        }
+    }
+
+    void OrderBook::compressedLadderRows(Tick compression,
+                                         Tick windowMin,
+                                         Tick windowMax,
+                                         std::vector<Level>& out,
+                                         Tick& outTopBucket)
+    {
+        outTopBucket = windowMax;
+        if (compression <= 1)
+        {
+            ladderRows(windowMin, windowMax, out);
+            return;
+        }
+        out.clear();
+        if (windowMax < windowMin)
+        {
+            return;
+        }
 
-            auto askIt = asks_.find(tick);
-            if (askIt != asks_.end())
+        const auto floorBucket = [compression](Tick tick) {
+            Tick q = tick / compression;
+            if (tick % compression < 0)
             {
-                askQty = askIt->second;
+                --q;
             }
+            return q * compression;
+        };
+        const Tick bottom = floorBucket(windowMin);
+        const Tick top = floorBucket(windowMax) + (windowMax % compression != 0 ? compression : 0);
+        outTopBucket = top;
+        out.reserve(static_cast<std::size_t>((top - bottom) / compression) + 1);
+
+        BucketSums& sums = bucketSums_[compression];
+        for (Tick bucket = top; bucket >= bottom; bucket -= compression)
+        {
+            auto [bidIt, newBid] = sums.bids.try_emplace(bucket, 0.0);
+            if (newBid)
+            {
+                bidIt->second = sumBids(bucket, bucket + compression - 1);
+            }
+            auto [askIt, newAsk] = sums.asks.try_emplace(bucket, 0.0);
+            if (newAsk)
+            {
+                askIt->second = sumAsks(bucket - compression + 1, bucket);
+            }
+            out.push_back(Level{static_cast<double>(bucket) * tickSize_, bidIt->second, askIt->second});
+        }
+    }
 
-            result.push_back(Level{price, bidQty, askQty});
-
-            if (tick == std::numeric_limits<Tick>::min())
+    bool OrderBook::takeChangedTicks(Tick windowMin, Tick windowMax, std::vector<Tick>& out)
+    {
+        out.clear();
+        if (changesUnknown_)
+        {
+            discardChanges();
+            return false;
+        }
+        for (const Tick tick : changedTicks_)
+        {
+            if (tick >= windowMin && tick <= windowMax)
             {
-                break; // prevent overflow on next --tick
+                out.push_back(tick);
+            }
+        }
+        for (const auto& [fromTick, toTick] : changedRanges_)
+        {
+            const Tick lo = std::max(fromTick, windowMin);
+            const Tick hi = std::min(toTick, windowMax);
+            for (Tick tick = lo; tick <= hi; ++tick)
+            {
+                out.push_back(tick);
+                if (tick == hi)
+                {
+                    break; // hi may be Tick max
+                }
             }
         }
+        std::sort(out.begin(), out.end(), std::greater<Tick>());
+        out.erase(std::unique(out.begin(), out.end()), out.end());
+        discardChanges();
+        return true;
+    }
 
-        return result;
+    void OrderBook::discardChanges()
+    {
+        changedTicks_.clear();
+        changedRanges_.clear();
+        changesUnknown_ = false;
     }
 
     void OrderBook::shiftManualCenterTicks(Tick delta)
@@ -420,6 +527,113 @@ namespace dom
         }
     }
 
+    void OrderBook::applySide(FlatBookSide& side, const std::vector<std::pair<Tick, double>>& updates)
+    {
+        for (const auto& [tick, qty] : updates)
+        {
+            side.set(tick, qty);
+        }
+    }
+
+    void OrderBook::noteChanged(const std::vector<std::pair<Tick, double>>& updates)
+    {
+        if (!bucketSums_.empty())
+        {
+            for (const auto& update : updates)
+            {
+                invalidateBuckets(update.first, update.first);
+            }
+        }
+        if (changesUnknown_)
+        {
+            return;
+        }
+        if (changedTicks_.size() + updates.size() > kMaxTrackedChanges)
+        {
+            // Nobody is taking the changes (or the burst is huge); fall back to a full ladder.
+            changedTicks_.clear();
+            changedRanges_.clear();
+            changesUnknown_ = true;
+            return;
+        }
+        for (const auto& update : updates)
+        {
+            changedTicks_.push_back(update.first);
+        }
+    }
+
+    void OrderBook::noteChangedRange(Tick fromTick, Tick toTick)
+    {
+        invalidateBuckets(fromTick, toTick);
+        if (changesUnknown_ || fromTick > toTick)
+        {
+            return;
+        }
+        if (changedRanges_.size() >= kMaxTrackedChanges)
+        {
+            changedTicks_.clear();
+            changedRanges_.clear();
+            changesUnknown_ = true;
+            return;
+        }
+        changedRanges_.emplace_back(fromTick, toTick);
+    }
+
+    void OrderBook::invalidateBuckets(Tick fromTick, Tick toTick)
+    {
+        if (fromTick > toTick)
+        {
+            return;
+        }
+        constexpr Tick lowest = std::numeric_limits<Tick>::min();
+        constexpr Tick highest = std::numeric_limits<Tick>::max();
+        for (auto& [compression, sums] : bucketSums_)
+        {
+            // Bid bucket b covers [b, b + c - 1], ask bucket b covers [b - c + 1, b].
+            const Tick reach = compression - 1;
+            const Tick bidFrom = fromTick < lowest + reach ? lowest : fromTick - reach;
+            const Tick askTo = toTick > highest - reach ? highest : toTick + reach;
+            sums.bids.erase(sums.bids.lower_bound(bidFrom), sums.bids.upper_bound(toTick));
+            sums.asks.erase(sums.asks.lower_bound(fromTick), sums.asks.upper_bound(askTo));
+        }
+    }
+
+    double OrderBook::sumBids(Tick fromTick, Tick toTick) const
+    {
+        double sum = 0.0;
+        if (storage_ == Storage::Flat)
+        {
+            for (Tick tick = fromTick; tick <= toTick; ++tick)
+            {
+                sum += flatBids_.get(tick);
+            }
+            return sum;
+        }
+        for (auto it = bids_.lower_bound(fromTick); it != bids_.end() && it->first <= toTick; ++it)
+        {
+            sum += it->second;
+        }
+        return sum;
+    }
+
+    double OrderBook::sumAsks(Tick fromTick, Tick toTick) const
+    {
+        double sum = 0.0;
+        if (storage_ == Storage::Flat)
+        {
+            for (Tick tick = fromTick; tick <= toTick; ++tick)
+            {
+                sum += flatAsks_.get(tick);
+            }
+            return sum;
+        }
+        for (auto it = asks_.lower_bound(fromTick); it != asks_.end() && it->first <= toTick; ++it)
+        {
+            sum += it->second;
+        }
+        return sum;
+    }
+
     void OrderBook::pruneOutsideWindow(BookSide& side, Tick minTick, Tick maxTick)
     {
         if (side.empty()) {
@@ -440,16 +654,16 @@ namespace dom
 
     bool OrderBook::resolveAutoCenterTick(Tick& outTick) const
     {
-        if (!bids_.empty() && !asks_.empty()) {
-            outTick = (bids_.rbegin()->first + asks_.begin()->first) / 2;
+        if (hasBids() && hasAsks()) {
+            outTick = (highestBidTick() + lowestAskTick()) / 2;
             return true;
         }
-        if (!bids_.empty()) {
-            outTick = bids_.rbegin()->first;
+        if (hasBids()) {
+            outTick = highestBidTick();
             return true;
         }
-        if (!asks_.empty()) {
-            outTick = asks_.begin()->first;
+        if (hasAsks()) {
+            outTick = lowestAskTick();
             return true;
         }
         return false;
@@ -457,7 +671,7 @@ namespace dom
 
     void OrderBook::pruneToCacheWindow(Tick anchorTick)
     {
-        if (cacheLevelsPerSide_ == 0 || (bids_.empty() && asks_.empty())) {
+        if (cacheLevelsPerSide_ == 0 || (!hasBids() && !hasAsks())) {
             return;
         }
         const std::size_t maxPerSide = static_cast<std::size_t>(kMaxLevels / 2);
@@ -474,7 +688,79 @@ namespace dom
                            ? std::numeric_limits<Tick>::min()
                            : anchorTick - span;
 
+        // Levels below/above the previous cache window were already dropped, so
+        // only the part of it that this prune gives up can lose levels.
+        if (hasRetained_)
+        {
+            if (minTick > retainedMin_)
+            {
+                noteChangedRange(retainedMin_, minTick - 1);
+            }
+            if (maxTick < retainedMax_)
+            {
+                noteChangedRange(maxTick + 1, retainedMax_);
+            }
+        }
+        retainedMin_ = minTick;
+        retainedMax_ = maxTick;
+        hasRetained_ = true;
+
+        if (storage_ == Storage::Flat) {
+            flatBids_.retainRange(minTick, maxTick);
+            flatAsks_.retainRange(minTick, maxTick);
+            return;
+        }
         pruneOutsideWindow(bids_, minTick, maxTick);
         pruneOutsideWindow(asks_, minTick, maxTick);
     }
+
+    bool OrderBook::hasBids() const
+    {
+        return storage_ == Storage::Flat ? !flatBids_.empty() : !bids_.empty();
+    }
+
+    bool OrderBook::hasAsks() const
+    {
+        return storage_ == Storage::Flat ? !flatAsks_.empty() : !asks_.empty();
+    }
+
+    OrderBook::Tick OrderBook::highestBidTick() const
+    {
+        return storage_ == Storage::Flat ? flatBids_.highest() : bids_.rbegin()->first;
+    }
+
+    OrderBook::Tick OrderBook::lowestBidTick() const
+    {
+        return storage_ == Storage::Flat ? flatBids_.lowest() : bids_.begin()->first;
+    }
+
+    OrderBook::Tick OrderBook::highestAskTick() const
+    {
+        return storage_ == Storage::Flat ? flatAsks_.highest() : asks_.rbegin()->first;
+    }
+
+    OrderBook::Tick OrderBook::lowestAskTick() const
+    {
+        return storage_ == Storage::Flat ? flatAsks_.lowest() : asks_.begin()->first;
+    }
+
+    double OrderBook::bidQuantityAt(Tick tick) const
+    {
+        if (storage_ == Storage::Flat)
+        {
+            return flatBids_.get(tick);
+        }
+        auto it = bids_.find(tick);
+        return it != bids_.end() ? it->second : 0.0;
+    }
+
+    double OrderBook::askQuantityAt(Tick tick) const
+    {
+        if (storage_ == Storage::Flat)
+        {
+            return flatAsks_.get(tick);
+        }
+        auto it = asks_.find(tick);
+        return it != asks_.end() ? it->second : 0.0;
+    }
 } // namespace dom
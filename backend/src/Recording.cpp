@@ -0,0 +1,281 @@
+#include "Recording.hpp"
+
+#include <cstring>
+#include <thread>
+
+namespace net
+{
+    namespace
+    {
+        constexpr char kMagic[8] = {'O', 'B', 'R', 'E', 'C', '0', '0', '1'};
+        constexpr std::size_t kRecordHeaderSize = 1 + 8 + 4 + 4;
+
+        template <typename T>
+        void put(char *&p, T v)
+        {
+            std::memcpy(p, &v, sizeof(T));
+            p += sizeof(T);
+        }
+
+        template <typename T>
+        T get(const char *&p)
+        {
+            T v;
+            std::memcpy(&v, p, sizeof(T));
+            p += sizeof(T);
+            return v;
+        }
+
+        class RecordingWebSocket final : public WebSocket
+        {
+        public:
+            RecordingWebSocket(std::unique_ptr<WebSocket> inner, Recorder &recorder)
+                : inner_(std::move(inner)), recorder_(recorder)
+            {
+            }
+
+            bool sendText(std::string_view text) override { return inner_->sendText(text); }
+
+            bool receive(std::string &out, MessageType &type) override
+            {
+                if (!inner_->receive(out, type))
+                {
+                    return false;
+                }
+                recorder_.write(type == MessageType::Text ? RecordKind::Text : RecordKind::Binary, {}, out);
+                return true;
+            }
+
+            void close() override { inner_->close(); }
+            [[nodiscard]] const std::string &error() const override { return inner_->error(); }
+
+        private:
+            std::unique_ptr<WebSocket> inner_;
+            Recorder &recorder_;
+        };
+    } // namespace
+
+    std::string urlKey(const Url &url)
+    {
+        return url.host + ":" + std::to_string(url.port) + url.path;
+    }
+
+    // --- Recorder ---------------------------------------------------------
+
+    bool Recorder::open(const std::string &path, std::string &error)
+    {
+        out_.open(path, std::ios::binary | std::ios::trunc);
+        if (!out_)
+        {
+            error = "cannot create " + path;
+            return false;
+        }
+        out_.write(kMagic, sizeof(kMagic));
+        out_.flush();
+        start_ = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    void Recorder::write(RecordKind kind, std::string_view key, std::string_view payload)
+    {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_)
+                            .count();
+        char header[kRecordHeaderSize];
+        char *p = header;
+        put<std::uint8_t>(p, static_cast<std::uint8_t>(kind));
+        put<std::int64_t>(p, static_cast<std::int64_t>(ns));
+        put<std::uint32_t>(p, static_cast<std::uint32_t>(key.size()));
+        put<std::uint32_t>(p, static_cast<std::uint32_t>(payload.size()));
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        out_.write(header, sizeof(header));
+        out_.write(key.data(), static_cast<std::streamsize>(key.size()));
+        out_.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+        out_.flush();
+    }
+
+    std::unique_ptr<WebSocket> Recorder::wrap(std::unique_ptr<WebSocket> socket, const Url &url)
+    {
+        write(RecordKind::Open, urlKey(url), {});
+        return std::make_unique<RecordingWebSocket>(std::move(socket), *this);
+    }
+
+    // --- Replayer ---------------------------------------------------------
+
+    class ReplayWebSocket final : public WebSocket
+    {
+    public:
+        explicit ReplayWebSocket(Replayer &replayer) : replayer_(replayer) {}
+
+        // Subscriptions and pongs have nowhere to go.
+        bool sendText(std::string_view) override { return !closed_; }
+
+        bool receive(std::string &out, MessageType &type) override
+        {
+            if (closed_ || !replayer_.nextMessage(record_))
+            {
+                closed_ = true;
+                error_ = "replay: end of recorded connection";
+                return false;
+            }
+            // Swap instead of copy: the caller's old buffer becomes the next read target.
+            out.swap(record_.payload);
+            type = record_.kind == RecordKind::Binary ? MessageType::Binary : MessageType::Text;
+            return true;
+        }
+
+        void close() override { closed_ = true; }
+        [[nodiscard]] const std::string &error() const override { return error_; }
+
+    private:
+        Replayer &replayer_;
+        Replayer::Record record_;
+        std::string error_;
+        bool closed_{false};
+    };
+
+    bool Replayer::open(const std::string &path, double speed, std::string &error)
+    {
+        in_.open(path, std::ios::binary);
+        char magic[sizeof(kMagic)] = {};
+        if (!in_ || !in_.read(magic, sizeof(magic)) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0)
+        {
+            error = path + " is not a backend recording";
+            return false;
+        }
+        speed_ = speed;
+        return true;
+    }
+
+    bool Replayer::readRecord(Record &out)
+    {
+        char header[kRecordHeaderSize];
+        if (!in_.read(header, sizeof(header)))
+        {
+            return false;
+        }
+        const char *p = header;
+        out.kind = static_cast<RecordKind>(get<std::uint8_t>(p));
+        out.ns = get<std::int64_t>(p);
+        const auto keySize = get<std::uint32_t>(p);
+        const auto payloadSize = get<std::uint32_t>(p);
+        out.key.resize(keySize);
+        out.payload.resize(payloadSize);
+        // A record cut short by a killed recorder ends the replay.
+        return in_.read(out.key.data(), keySize) && in_.read(out.payload.data(), payloadSize);
+    }
+
+    bool Replayer::nextStreamRecord(Record &out)
+    {
+        if (!pendingStream_.empty())
+        {
+            out = std::move(pendingStream_.front());
+            pendingStream_.pop_front();
+            return true;
+        }
+        while (readRecord(out))
+        {
+            if (out.kind != RecordKind::Http)
+            {
+                return true;
+            }
+            pendingHttp_[out.key].push_back(std::move(out.payload));
+        }
+        return false;
+    }
+
+    bool Replayer::nextMessage(Record &out)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!nextStreamRecord(out))
+            {
+                return false;
+            }
+            if (out.kind == RecordKind::Open)
+            {
+                // The recorded connection ended here; leave the Open for the reconnect.
+                pendingStream_.push_front(std::move(out));
+                return false;
+            }
+        }
+        pace(out.ns);
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.messages;
+        stats_.bytes += out.payload.size();
+        lastWall_ = std::chrono::steady_clock::now();
+        stats_.elapsed = lastWall_ - firstWall_;
+        return true;
+    }
+
+    void Replayer::pace(std::int64_t ns)
+    {
+        if (!paceStarted_)
+        {
+            paceStarted_ = true;
+            firstNs_ = ns;
+            firstWall_ = std::chrono::steady_clock::now();
+            return;
+        }
+        if (speed_ <= 0.0)
+        {
+            return;
+        }
+        const auto offset = std::chrono::nanoseconds(static_cast<std::int64_t>(static_cast<double>(ns - firstNs_) / speed_));
+        std::this_thread::sleep_until(firstWall_ + offset);
+    }
+
+    std::unique_ptr<WebSocket> Replayer::openWebSocket(const Url &, std::string &error)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Record record;
+        while (nextStreamRecord(record))
+        {
+            // Skips the tail of a connection the runner already gave up on. The URL
+            // is not checked: --endpoint may have pointed the recording elsewhere.
+            if (record.kind == RecordKind::Open)
+            {
+                return std::make_unique<ReplayWebSocket>(*this);
+            }
+        }
+        error = "replay: no more recorded connections";
+        return nullptr;
+    }
+
+    std::optional<std::string> Replayer::httpGet(const Url &url, std::string &error)
+    {
+        const std::string key = urlKey(url);
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (;;)
+        {
+            const auto it = pendingHttp_.find(key);
+            if (it != pendingHttp_.end() && !it->second.empty())
+            {
+                std::string body = std::move(it->second.front());
+                it->second.pop_front();
+                return body;
+            }
+            // Read ahead; socket records met on the way stay queued in order.
+            Record record;
+            if (!readRecord(record))
+            {
+                error = "replay: no recorded response for " + key;
+                return std::nullopt;
+            }
+            if (record.kind == RecordKind::Http)
+            {
+                pendingHttp_[record.key].push_back(std::move(record.payload));
+            }
+            else
+            {
+                pendingStream_.push_back(std::move(record));
+            }
+        }
+    }
+
+    Replayer::Stats Replayer::stats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+} // namespace net
@@ -0,0 +1,254 @@
+#if defined(ORDERBOOK_BACKEND_QT)
+
+#include "Transport.hpp"
+
+#include <QAbstractSocket>
+#include <QByteArray>
+#include <QEventLoop>
+#include <QMetaObject>
+#include <QNetworkAccessManager>
+#include <QNetworkProxy>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QThread>
+#include <QTimer>
+#include <QUrl>
+#include <QWebSocket>
+
+#include <atomic>
+#include <deque>
+#include <utility>
+
+namespace net
+{
+    namespace
+    {
+        constexpr int kConnectTimeoutMs = 15000;
+
+        QNetworkProxy toQtProxy(const Proxy &proxy)
+        {
+            if (!proxy.enabled())
+            {
+                return QNetworkProxy(QNetworkProxy::NoProxy);
+            }
+            return QNetworkProxy((proxy.type == "socks5") ? QNetworkProxy::Socks5Proxy : QNetworkProxy::HttpProxy,
+                                 QString::fromStdString(proxy.host),
+                                 static_cast<quint16>(proxy.port),
+                                 QString::fromStdString(proxy.user),
+                                 QString::fromStdString(proxy.pass));
+        }
+
+        QUrl toQtUrl(const Url &url, bool webSocket)
+        {
+            const char *scheme = webSocket ? (url.secure ? "wss" : "ws") : (url.secure ? "https" : "http");
+            return QUrl(QStringLiteral("%1://%2:%3%4")
+                            .arg(QLatin1String(scheme), QString::fromStdString(url.host))
+                            .arg(url.port)
+                            .arg(QString::fromStdString(url.path)));
+        }
+
+        // Blocking facade over QWebSocket. The socket lives in the thread that
+        // opened it; receive() spins a local event loop on that thread until a
+        // message arrives, so no separate Qt thread is needed.
+        class QtWebSocket final : public WebSocket
+        {
+        public:
+            QtWebSocket()
+            {
+                QObject::connect(&socket_, &QWebSocket::textMessageReceived, &socket_, [this](const QString &msg) {
+                    enqueue(MessageType::Text, msg.toUtf8());
+                });
+                QObject::connect(&socket_, &QWebSocket::binaryMessageReceived, &socket_, [this](const QByteArray &msg) {
+                    enqueue(MessageType::Binary, msg);
+                });
+                QObject::connect(&socket_, &QWebSocket::disconnected, &socket_, [this]() {
+                    if (error_.empty())
+                    {
+                        error_ = "closed by server";
+                    }
+                    closed_.store(true);
+                    loop_.quit();
+                });
+                QObject::connect(&socket_,
+                                 QOverload<QAbstractSocket::SocketError>::of(&QWebSocket::error),
+                                 &socket_,
+                                 [this](QAbstractSocket::SocketError) {
+                                     error_ = socket_.errorString().toStdString();
+                                     closed_.store(true);
+                                     loop_.quit();
+                                 });
+            }
+
+            ~QtWebSocket() override
+            {
+                // The handlers touch loop_, which is destroyed before socket_.
+                socket_.disconnect();
+                socket_.abort();
+            }
+
+            bool open(const Url &url, const Proxy &proxy, std::string &error)
+            {
+                socket_.setProxy(toQtProxy(proxy));
+
+                bool connected = false;
+                QTimer timer;
+                timer.setSingleShot(true);
+                QObject::connect(&timer, &QTimer::timeout, &loop_, [this]() { loop_.quit(); });
+                const auto conn = QObject::connect(&socket_, &QWebSocket::connected, &loop_, [&]() {
+                    connected = true;
+                    loop_.quit();
+                });
+
+                socket_.open(toQtUrl(url, true));
+                timer.start(kConnectTimeoutMs);
+                loop_.exec();
+                QObject::disconnect(conn);
+
+                if (!connected)
+                {
+                    error = error_.empty() ? std::string("WebSocket connect timed out") : error_;
+                    socket_.abort();
+                    return false;
+                }
+                return true;
+            }
+
+            bool sendText(std::string_view text) override
+            {
+                if (closed_.load())
+                {
+                    return false;
+                }
+                const QString payload = QString::fromUtf8(text.data(), static_cast<qsizetype>(text.size()));
+                if (QThread::currentThread() == socket_.thread())
+                {
+                    return socket_.sendTextMessage(payload) >= 0;
+                }
+                // Another thread (e.g. a keepalive pinger): hand the send to the
+                // socket's thread; it runs the next time receive() spins the loop.
+                QMetaObject::invokeMethod(
+                    &socket_, [this, payload]() { socket_.sendTextMessage(payload); }, Qt::QueuedConnection);
+                return true;
+            }
+
+            bool receive(std::string &out, MessageType &type) override
+            {
+                for (;;)
+                {
+                    while (queue_.empty() && !closed_.load())
+                    {
+                        loop_.exec();
+                    }
+                    if (queue_.empty())
+                    {
+                        return false;
+                    }
+                    auto [msgType, payload] = std::move(queue_.front());
+                    queue_.pop_front();
+                    if (payload.isEmpty() || static_cast<std::size_t>(payload.size()) > kMaxMessageSize)
+                    {
+                        continue;
+                    }
+                    out.assign(payload.constData(), static_cast<std::size_t>(payload.size()));
+                    type = msgType;
+                    return true;
+                }
+            }
+
+            void close() override
+            {
+                if (!closed_.exchange(true))
+                {
+                    socket_.close();
+                }
+            }
+
+            [[nodiscard]] const std::string &error() const override { return error_; }
+
+        private:
+            void enqueue(MessageType type, QByteArray payload)
+            {
+                queue_.emplace_back(type, std::move(payload));
+                loop_.quit();
+            }
+
+            QWebSocket socket_;
+            QEventLoop loop_;
+            std::deque<std::pair<MessageType, QByteArray>> queue_;
+            std::string error_;
+            std::atomic<bool> closed_{false};
+        };
+    } // namespace
+
+    namespace qt
+    {
+        std::unique_ptr<WebSocket> openWebSocket(const Url &url, const Proxy &proxy, std::string &error)
+        {
+            auto socket = std::make_unique<QtWebSocket>();
+            if (!socket->open(url, proxy, error))
+            {
+                return nullptr;
+            }
+            return socket;
+        }
+
+        std::optional<std::string> httpGet(const Url &url, const Proxy &proxy, std::string &error, int timeoutMs)
+        {
+            QNetworkAccessManager nam;
+            nam.setProxy(toQtProxy(proxy));
+
+            const QUrl qurl = toQtUrl(url, false);
+            if (!qurl.isValid())
+            {
+                error = "invalid url: " + qurl.toString().toStdString();
+                return std::nullopt;
+            }
+
+            QNetworkRequest req(qurl);
+            req.setHeader(QNetworkRequest::UserAgentHeader, QStringLiteral("Ghost/1.0"));
+            req.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+
+            QEventLoop loop;
+            QTimer timer;
+            timer.setSingleShot(true);
+            QObject::connect(&timer, &QTimer::timeout, &loop, [&]() { loop.quit(); });
+
+            QNetworkReply *reply = nam.get(req);
+            QObject::connect(reply, &QNetworkReply::finished, &loop, [&]() { loop.quit(); });
+            timer.start(timeoutMs);
+            loop.exec();
+
+            if (!timer.isActive())
+            {
+                reply->abort();
+            }
+
+            const auto err = reply->error();
+            const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+            const QByteArray body = reply->readAll();
+            reply->deleteLater();
+
+            if (err != QNetworkReply::NoError || status <= 0 || status >= 400)
+            {
+                error = "HTTP GET " + url.host + " failed: status=" + std::to_string(status) +
+                        " err=" + std::to_string(static_cast<int>(err));
+                return std::nullopt;
+            }
+            return body.toStdString();
+        }
+    } // namespace qt
+
+#if !defined(_WIN32)
+    std::unique_ptr<WebSocket> openWebSocket(const Url &url, const Proxy &proxy, std::string &error)
+    {
+        return qt::openWebSocket(url, proxy, error);
+    }
+
+    std::optional<std::string> httpGet(const Url &url, const Proxy &proxy, std::string &error)
+    {
+        return qt::httpGet(url, proxy, error);
+    }
+#endif
+} // namespace net
+
+#endif // ORDERBOOK_BACKEND_QT
@@ -0,0 +1,369 @@
+#ifdef _WIN32
+
+#define WIN32_LEAN_AND_MEAN
+#ifndef NOMINMAX
+#    define NOMINMAX
+#endif
+#include <windows.h>
+#include <winhttp.h>
+
+#include "Transport.hpp"
+
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace net
+{
+    namespace
+    {
+        constexpr DWORD kReceiveChunk = 64 * 1024;
+
+        std::string winhttpError(const char *where)
+        {
+            DWORD error = GetLastError();
+            LPWSTR buffer = nullptr;
+            DWORD len =
+                FormatMessageW(FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM |
+                                   FORMAT_MESSAGE_IGNORE_INSERTS,
+                               nullptr,
+                               error,
+                               0,
+                               reinterpret_cast<LPWSTR>(&buffer),
+                               0,
+                               nullptr);
+            std::string msg = where;
+            msg += ": ";
+            if (len && buffer)
+            {
+                int outLen = WideCharToMultiByte(CP_UTF8, 0, buffer, len, nullptr, 0, nullptr, nullptr);
+                std::string utf8(outLen, '\0');
+                WideCharToMultiByte(CP_UTF8, 0, buffer, len, utf8.data(), outLen, nullptr, nullptr);
+                msg += utf8;
+                LocalFree(buffer);
+            }
+            else
+            {
+                msg += "unknown error";
+            }
+            return msg;
+        }
+
+        struct WinHttpHandle
+        {
+            WinHttpHandle() = default;
+            explicit WinHttpHandle(HINTERNET h) : handle(h) {}
+            ~WinHttpHandle() { reset(); }
+
+            WinHttpHandle(const WinHttpHandle&) = delete;
+            WinHttpHandle& operator=(const WinHttpHandle&) = delete;
+
+            WinHttpHandle(WinHttpHandle&& other) noexcept : handle(other.handle) { other.handle = nullptr; }
+            WinHttpHandle& operator=(WinHttpHandle&& other) noexcept
+            {
+                if (this != &other)
+                {
+                    reset();
+                    handle = other.handle;
+                    other.handle = nullptr;
+                }
+                return *this;
+            }
+
+            void reset(HINTERNET h = nullptr)
+            {
+                if (handle)
+                {
+                    WinHttpCloseHandle(handle);
+                }
+                handle = h;
+            }
+
+            [[nodiscard]] bool valid() const { return handle != nullptr; }
+            [[nodiscard]] HINTERNET get() const { return handle; }
+
+        private:
+            HINTERNET handle{nullptr};
+        };
+
+        std::wstring toWide(const std::string& s)
+        {
+            if (s.empty())
+            {
+                return {};
+            }
+            int len = MultiByteToWideChar(CP_UTF8, 0, s.c_str(), -1, nullptr, 0);
+            std::wstring out(len - 1, L'\0');
+            MultiByteToWideChar(CP_UTF8, 0, s.c_str(), -1, out.data(), len);
+            return out;
+        }
+
+        WinHttpHandle openSession(const Proxy &proxy)
+        {
+            if (proxy.enabled())
+            {
+                // WinHTTP does not reliably support SOCKS proxies for WebSockets.
+                // Most "SOCKS5" proxy providers also expose an HTTP CONNECT proxy on the same host:port,
+                // so use a named HTTP/HTTPS proxy even when the UI proxy type is SOCKS5.
+                std::ostringstream hp;
+                hp << proxy.host << ":" << proxy.port;
+                const std::wstring named = toWide("http=" + hp.str() + ";https=" + hp.str());
+                return WinHttpHandle(WinHttpOpen(L"Ghost/1.0",
+                                                 WINHTTP_ACCESS_TYPE_NAMED_PROXY,
+                                                 named.c_str(),
+                                                 WINHTTP_NO_PROXY_BYPASS,
+                                                 0));
+            }
+            return WinHttpHandle(WinHttpOpen(L"Ghost/1.0",
+                                             WINHTTP_ACCESS_TYPE_AUTOMATIC_PROXY,
+                                             nullptr,
+                                             nullptr,
+                                             0));
+        }
+
+        void applyProxyCredentials(const Proxy &proxy, HINTERNET request)
+        {
+            if (!request || !proxy.enabled() || proxy.user.empty())
+            {
+                return;
+            }
+            // Best-effort: many proxies accept Basic auth.
+            const std::wstring user = toWide(proxy.user);
+            const std::wstring pass = toWide(proxy.pass);
+            WinHttpSetCredentials(request,
+                                  WINHTTP_AUTH_TARGET_PROXY,
+                                  WINHTTP_AUTH_SCHEME_BASIC,
+                                  user.c_str(),
+                                  pass.c_str(),
+                                  nullptr);
+        }
+
+        // Session -> connection -> request, with the request already sent and answered.
+        bool openRequest(const Url &url,
+                         const Proxy &proxy,
+                         bool upgrade,
+                         WinHttpHandle &session,
+                         WinHttpHandle &connection,
+                         WinHttpHandle &request,
+                         std::string &error)
+        {
+            session = openSession(proxy);
+            if (!session.valid())
+            {
+                error = winhttpError("WinHttpOpen");
+                return false;
+            }
+
+            connection.reset(WinHttpConnect(session.get(), toWide(url.host).c_str(), url.port, 0));
+            if (!connection.valid())
+            {
+                error = winhttpError("WinHttpConnect");
+                return false;
+            }
+
+            request.reset(WinHttpOpenRequest(connection.get(),
+                                             L"GET",
+                                             toWide(url.path).c_str(),
+                                             nullptr,
+                                             WINHTTP_NO_REFERER,
+                                             WINHTTP_DEFAULT_ACCEPT_TYPES,
+                                             url.secure ? WINHTTP_FLAG_SECURE : 0));
+            if (!request.valid())
+            {
+                error = winhttpError("WinHttpOpenRequest");
+                return false;
+            }
+
+            applyProxyCredentials(proxy, request.get());
+            if (upgrade && !WinHttpSetOption(request.get(), WINHTTP_OPTION_UPGRADE_TO_WEB_SOCKET, nullptr, 0))
+            {
+                error = winhttpError("WinHttpSetOption");
+                return false;
+            }
+
+            if (!WinHttpSendRequest(request.get(),
+                                    WINHTTP_NO_ADDITIONAL_HEADERS,
+                                    0,
+                                    WINHTTP_NO_REQUEST_DATA,
+                                    0,
+                                    0,
+                                    0))
+            {
+                error = winhttpError("WinHttpSendRequest");
+                return false;
+            }
+
+            if (!WinHttpReceiveResponse(request.get(), nullptr))
+            {
+                error = winhttpError("WinHttpReceiveResponse");
+                return false;
+            }
+            return true;
+        }
+
+        class WinHttpWebSocket final : public WebSocket
+        {
+        public:
+            WinHttpWebSocket(WinHttpHandle session, WinHttpHandle connection, HINTERNET socket)
+                : session_(std::move(session)), connection_(std::move(connection)), socket_(socket)
+            {
+            }
+
+            ~WinHttpWebSocket() override
+            {
+                close();
+                socket_.reset();
+            }
+
+            // The stream thread (pongs, unsubscribes) and resubscribe workers
+            // send on the same handle; WinHTTP does not allow concurrent sends.
+            bool sendText(std::string_view text) override
+            {
+                std::lock_guard<std::mutex> lock(sendMutex_);
+                return WinHttpWebSocketSend(socket_.get(),
+                                            WINHTTP_WEB_SOCKET_UTF8_MESSAGE_BUFFER_TYPE,
+                                            const_cast<char *>(text.data()),
+                                            static_cast<DWORD>(text.size())) == NO_ERROR;
+            }
+
+            bool receive(std::string &out, MessageType &type) override
+            {
+                out.clear();
+                bool oversized = false;
+                for (;;)
+                {
+                    DWORD received = 0;
+                    WINHTTP_WEB_SOCKET_BUFFER_TYPE bufferType;
+                    const DWORD rc =
+                        WinHttpWebSocketReceive(socket_.get(), buffer_.data(), kReceiveChunk, &received, &bufferType);
+                    if (rc != NO_ERROR)
+                    {
+                        std::ostringstream msg;
+                        msg << "WebSocket receive failed: 0x" << std::hex << rc;
+                        error_ = msg.str();
+                        closed_ = true; // nothing left to close gracefully
+                        return false;
+                    }
+                    if (bufferType == WINHTTP_WEB_SOCKET_CLOSE_BUFFER_TYPE)
+                    {
+                        error_ = "closed by server";
+                        closed_ = true;
+                        return false;
+                    }
+
+                    const bool binary = bufferType == WINHTTP_WEB_SOCKET_BINARY_MESSAGE_BUFFER_TYPE ||
+                                        bufferType == WINHTTP_WEB_SOCKET_BINARY_FRAGMENT_BUFFER_TYPE;
+                    const bool fragment = bufferType == WINHTTP_WEB_SOCKET_UTF8_FRAGMENT_BUFFER_TYPE ||
+                                          bufferType == WINHTTP_WEB_SOCKET_BINARY_FRAGMENT_BUFFER_TYPE;
+                    if (!oversized)
+                    {
+                        if (out.size() + received > kMaxMessageSize)
+                        {
+                            oversized = true;
+                            out.clear();
+                        }
+                        else
+                        {
+                            out.append(buffer_.data(), received);
+                        }
+                    }
+                    if (fragment)
+                    {
+                        continue;
+                    }
+                    if (oversized || out.empty())
+                    {
+                        // Drop the whole message and wait for the next one.
+                        oversized = false;
+                        out.clear();
+                        continue;
+                    }
+                    type = binary ? MessageType::Binary : MessageType::Text;
+                    return true;
+                }
+            }
+
+            void close() override
+            {
+                if (closed_ || !socket_.valid())
+                {
+                    return;
+                }
+                closed_ = true;
+                std::lock_guard<std::mutex> lock(sendMutex_);
+                WinHttpWebSocketClose(socket_.get(), WINHTTP_WEB_SOCKET_SUCCESS_CLOSE_STATUS, nullptr, 0);
+            }
+
+            [[nodiscard]] const std::string &error() const override { return error_; }
+
+        private:
+            WinHttpHandle session_;
+            WinHttpHandle connection_;
+            WinHttpHandle socket_;
+            std::vector<char> buffer_ = std::vector<char>(kReceiveChunk);
+            std::string error_;
+            bool closed_{false};
+            std::mutex sendMutex_; // serializes sendText() and close()
+        };
+    } // namespace
+
+    std::unique_ptr<WebSocket> openWebSocket(const Url &url, const Proxy &proxy, std::string &error)
+    {
+        WinHttpHandle session;
+        WinHttpHandle connection;
+        WinHttpHandle request;
+        if (!openRequest(url, proxy, true, session, connection, request, error))
+        {
+            return nullptr;
+        }
+
+        HINTERNET socket = WinHttpWebSocketCompleteUpgrade(request.get(), 0);
+        if (!socket)
+        {
+            error = winhttpError("WinHttpWebSocketCompleteUpgrade");
+            return nullptr;
+        }
+        request.reset();
+        return std::make_unique<WinHttpWebSocket>(std::move(session), std::move(connection), socket);
+    }
+
+    std::optional<std::string> httpGet(const Url &url, const Proxy &proxy, std::string &error)
+    {
+        WinHttpHandle session;
+        WinHttpHandle connection;
+        WinHttpHandle request;
+        if (!openRequest(url, proxy, false, session, connection, request, error))
+        {
+            return std::nullopt;
+        }
+
+        std::string buffer;
+        for (;;)
+        {
+            DWORD bytesAvailable = 0;
+            if (!WinHttpQueryDataAvailable(request.get(), &bytesAvailable))
+            {
+                error = winhttpError("WinHttpQueryDataAvailable");
+                return std::nullopt;
+            }
+            if (bytesAvailable == 0)
+            {
+                break;
+            }
+
+            const std::size_t at = buffer.size();
+            buffer.resize(at + bytesAvailable);
+            DWORD bytesRead = 0;
+            if (!WinHttpReadData(request.get(), buffer.data() + at, bytesAvailable, &bytesRead))
+            {
+                error = winhttpError("WinHttpReadData");
+                return std::nullopt;
+            }
+            buffer.resize(at + bytesRead);
+        }
+
+        return buffer;
+    }
+} // namespace net
+
+#endif // _WIN32
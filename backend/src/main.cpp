@@ -4,28 +4,27 @@
 #        define NOMINMAX
 #    endif
 #    include <windows.h>
-#    include <winhttp.h>
-#else
-#    error "This backend is implemented for Windows (WinHTTP) only."
+#    include <fcntl.h>
+#    include <io.h>
 #endif
 
 #if defined(ORDERBOOK_BACKEND_QT)
 #    include <QCoreApplication>
-#    include <QEventLoop>
-#    include <QNetworkAccessManager>
-#    include <QNetworkProxy>
-#    include <QNetworkReply>
-#    include <QTimer>
-#    include <QUrl>
-#    include <QWebSocket>
 #endif
 
+#include "LadderShm.hpp"
+#include "LadderWire.hpp"
 #include "OrderBook.hpp"
+#include "Recording.hpp"
+#include "TickQuantizer.hpp"
+#include "Transport.hpp"
 
 #include <chrono>
 #include <cmath>
 #include <charconv>
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
 #include <iostream>
 #include <mutex>
 #include <optional>
@@ -34,6 +33,8 @@
 #include <string_view>
 #include <system_error>
 #include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include <atomic>
 #include <algorithm>
@@ -49,22 +50,28 @@ namespace
     struct Config
     {
         std::string symbol{"BIOUSDT"};
-        std::string endpoint{"wss://wbs-api.mexc.com/ws"};
+        std::string endpoint; // --endpoint ws[s]://host[:port]/path replaces the venue stream URL (e.g. a local stand-in)
         std::string exchange{"mexc"};
         std::string proxyType{"http"}; // http | socks5
         std::string proxy;             // host:port[:user:pass] / user:pass@host:port / etc
         std::size_t ladderLevelsPerSide{120};
         std::chrono::milliseconds throttle{50};
+        std::chrono::milliseconds maxStaleness{0}; // --max-staleness-ms; 0 = same as throttle
         std::size_t snapshotDepth{500};
         std::size_t cacheLevelsPerSide{5000};
         double futuresContractSize{1.0}; // MEXC futures qty is in contracts; multiply by this to get base qty
+        dom::OrderBook::Storage bookStorage{dom::OrderBook::Storage::Flat}; // --book-engine flat|map
+        bool binaryProtocol{false};                                          // --protocol binary|json
+        std::string shmName;                                                 // --shm <mapping>[,<mapping>...], implies binary
+        std::vector<std::string> symbols;                                    // --symbols A,B,... (multi-book mode)
+        bool deepBook{false}; // --deep-book: pipe ladders span the whole cache, full ones sent sparse
 
-        std::wstring winProxy; // WinHTTP proxy string; empty means no proxy
-        std::wstring proxyUser;
-        std::wstring proxyPass;
-    };
+        net::Proxy proxySettings; // parsed from proxy/proxyType; host empty means no proxy
 
-    std::wstring toWide(const std::string& s);
+        std::string recordPath; // --record <file>: append raw WS messages and REST bodies
+        std::string replayPath; // --replay <file>: serve them instead of the network
+        double replaySpeed{1.0}; // --speed N|max; 0 = as fast as possible
+    };
 
     std::string trimAscii(std::string s)
     {
@@ -88,6 +95,23 @@ namespace
         return s;
     }
 
+    // "a, b,,c" -> {"a", "b", "c"}
+    std::vector<std::string> splitList(const std::string &raw)
+    {
+        std::vector<std::string> out;
+        std::string item;
+        std::istringstream in(raw);
+        while (std::getline(in, item, ','))
+        {
+            item = trimAscii(item);
+            if (!item.empty())
+            {
+                out.push_back(item);
+            }
+        }
+        return out;
+    }
+
     bool parseProxyString(const std::string &rawInput,
                           std::string typeHint,
                           std::string &outType,
@@ -260,9 +284,7 @@ namespace
 
     void finalizeProxy(Config &cfg)
     {
-        cfg.winProxy.clear();
-        cfg.proxyUser.clear();
-        cfg.proxyPass.clear();
+        cfg.proxySettings = net::Proxy{};
 
         const std::string raw = trimAscii(cfg.proxy);
         if (raw.empty())
@@ -282,21 +304,11 @@ namespace
         }
 
         cfg.proxyType = type;
-        std::ostringstream hp;
-        hp << host << ":" << port;
-
-        std::string winProxy;
-        // WinHTTP does not reliably support SOCKS proxies for WebSockets.
-        // Most "SOCKS5" proxy providers also expose an HTTP CONNECT proxy on the same host:port.
-        // Use HTTP/HTTPS named proxy for WinHTTP even when the UI proxy type is SOCKS5.
-        winProxy = "http=" + hp.str() + ";https=" + hp.str();
-
-        cfg.winProxy = toWide(winProxy);
-        if (!user.empty())
-        {
-            cfg.proxyUser = toWide(user);
-            cfg.proxyPass = toWide(pass);
-        }
+        cfg.proxySettings.type = type;
+        cfg.proxySettings.host = host;
+        cfg.proxySettings.port = port;
+        cfg.proxySettings.user = user;
+        cfg.proxySettings.pass = pass;
     }
 
     Config parseArgs(int argc, char** argv)
@@ -321,6 +333,11 @@ namespace
             else if (arg == "--endpoint")
             {
                 cfg.endpoint = value("--endpoint");
+                net::Url url;
+                if (!net::parseUrl(cfg.endpoint, url))
+                {
+                    throw std::runtime_error("Invalid --endpoint: " + cfg.endpoint + " (expected ws[s]://host[:port]/path)");
+                }
             }
             else if (arg == "--exchange")
             {
@@ -342,6 +359,10 @@ namespace
             {
                 cfg.throttle = std::chrono::milliseconds(std::stoul(value("--throttle-ms")));
             }
+            else if (arg == "--max-staleness-ms")
+            {
+                cfg.maxStaleness = std::chrono::milliseconds(std::stoul(value("--max-staleness-ms")));
+            }
             else if (arg == "--snapshot-depth")
             {
                 cfg.snapshotDepth = std::stoul(value("--snapshot-depth"));
@@ -350,6 +371,82 @@ namespace
             {
                 cfg.cacheLevelsPerSide = std::stoul(value("--cache-levels"));
             }
+            else if (arg == "--protocol")
+            {
+                const std::string protocol = toLowerAscii(value("--protocol"));
+                if (protocol == "binary")
+                {
+                    cfg.binaryProtocol = true;
+                }
+                else if (protocol == "json")
+                {
+                    cfg.binaryProtocol = false;
+                }
+                else
+                {
+                    throw std::runtime_error("Unknown --protocol: " + protocol + " (expected json|binary)");
+                }
+            }
+            else if (arg == "--deep-book")
+            {
+                cfg.deepBook = true;
+            }
+            else if (arg == "--shm")
+            {
+                cfg.shmName = value("--shm");
+            }
+            else if (arg == "--symbols")
+            {
+                cfg.symbols = splitList(value("--symbols"));
+                if (cfg.symbols.empty())
+                {
+                    throw std::runtime_error("--symbols needs at least one symbol");
+                }
+                cfg.symbol = cfg.symbols.front();
+            }
+            else if (arg == "--record")
+            {
+                cfg.recordPath = value("--record");
+            }
+            else if (arg == "--replay")
+            {
+                cfg.replayPath = value("--replay");
+            }
+            else if (arg == "--speed")
+            {
+                const std::string speed = toLowerAscii(value("--speed"));
+                cfg.replaySpeed = speed == "max" ? 0.0 : std::stod(speed);
+                if (!(cfg.replaySpeed >= 0.0) || !std::isfinite(cfg.replaySpeed))
+                {
+                    throw std::runtime_error("Invalid --speed: " + speed + " (expected a positive factor or max)");
+                }
+            }
+            else if (arg == "--book-engine")
+            {
+                const std::string engine = toLowerAscii(value("--book-engine"));
+                if (engine == "map")
+                {
+                    cfg.bookStorage = dom::OrderBook::Storage::Map;
+                }
+                else if (engine == "flat")
+                {
+                    cfg.bookStorage = dom::OrderBook::Storage::Flat;
+                }
+                else
+                {
+                    throw std::runtime_error("Unknown --book-engine: " + engine + " (expected flat|map)");
+                }
+            }
+        }
+
+        if (!cfg.shmName.empty())
+        {
+            // Doorbells for the shared segment are binary frames.
+            cfg.binaryProtocol = true;
+        }
+        if (!cfg.recordPath.empty() && !cfg.replayPath.empty())
+        {
+            throw std::runtime_error("--record and --replay are mutually exclusive");
         }
 
         constexpr std::size_t kMinCacheLevels = 5000;
@@ -426,7 +523,7 @@ namespace
         {
             try
             {
-                return std::stod(value.get<std::string>());
+                return std::stod(value.get_ref<const std::string &>());
             }
             catch (...)
             {
@@ -436,57 +533,43 @@ namespace
         return 0.0;
     }
 
-    bool quantizeTickFromPrice(double price,
-                               double tickSize,
-                               dom::OrderBook::Tick &outTick,
-                               double &outSnappedPrice)
+    // Locale-independent and allocation-free, unlike std::stod.
+    bool parseDoubleStrict(std::string_view s, double &out)
     {
-        if (!(tickSize > 0.0) || !std::isfinite(tickSize) || !(price > 0.0) || !std::isfinite(price))
+        if (s.empty())
         {
             return false;
         }
-
-        auto pow10i = [](int exp) -> std::int64_t {
-            std::int64_t v = 1;
-            for (int i = 0; i < exp; ++i) v *= 10;
-            return v;
-        };
-
-        for (int decimals = 0; decimals <= 12; ++decimals)
+        double v = 0.0;
+        const auto *first = s.data();
+        const auto *last = s.data() + s.size();
+        auto res = std::from_chars(first, last, v);
+        if (res.ec != std::errc() || res.ptr != last)
         {
-            const std::int64_t scale = pow10i(decimals);
-            const double scaledTickSizeD = tickSize * static_cast<double>(scale);
-            if (!std::isfinite(scaledTickSizeD))
-            {
-                continue;
-            }
-            const std::int64_t tickSizeScaled = static_cast<std::int64_t>(std::llround(scaledTickSizeD));
-            if (tickSizeScaled <= 0)
-            {
-                continue;
-            }
-            if (std::abs(scaledTickSizeD - static_cast<double>(tickSizeScaled)) > 1e-9)
-            {
-                continue;
-            }
+            return false;
+        }
+        out = v;
+        return true;
+    }
 
-            const std::int64_t priceScaled = static_cast<std::int64_t>(std::llround(price * static_cast<double>(scale)));
-            std::int64_t tick = 0;
-            if (priceScaled >= 0)
-            {
-                tick = (priceScaled + tickSizeScaled / 2) / tickSizeScaled;
-            }
-            else
-            {
-                tick = -((-priceScaled + tickSizeScaled / 2) / tickSizeScaled);
-            }
-            outTick = static_cast<dom::OrderBook::Tick>(tick);
-            const std::int64_t snappedScaled = tick * tickSizeScaled;
-            outSnappedPrice = static_cast<double>(snappedScaled) / static_cast<double>(scale);
-            return std::isfinite(outSnappedPrice);
+    // Every feed thread keeps converting with the same tick size, so the
+    // quantizer (scale search included) is only rebuilt when it changes.
+    const dom::TickQuantizer &quantizerFor(double tickSize)
+    {
+        thread_local dom::TickQuantizer cached;
+        if (cached.tickSize() != tickSize)
+        {
+            cached = dom::TickQuantizer(tickSize);
         }
+        return cached;
+    }
 
-        return false;
+    bool quantizeTickFromPrice(double price,
+                               double tickSize,
+                               dom::OrderBook::Tick &outTick,
+                               double &outSnappedPrice)
+    {
+        return quantizerFor(tickSize).quantize(price, outTick, outSnappedPrice);
     }
 
     dom::OrderBook::Tick tickFromPrice(double price, double tickSize)
@@ -500,115 +583,80 @@ namespace
         return static_cast<dom::OrderBook::Tick>(std::llround(price / tickSize));
     }
 
-    std::string winhttpError(const char* where)
-    {
-        DWORD error = GetLastError();
-        LPWSTR buffer = nullptr;
-        DWORD len =
-            FormatMessageW(FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM |
-                               FORMAT_MESSAGE_IGNORE_INSERTS,
-                           nullptr,
-                           error,
-                           0,
-                           reinterpret_cast<LPWSTR>(&buffer),
-                           0,
-                           nullptr);
-        std::string msg = where;
-        msg += ": ";
-        if (len && buffer)
-        {
-            int outLen = WideCharToMultiByte(CP_UTF8, 0, buffer, len, nullptr, 0, nullptr, nullptr);
-            std::string utf8(outLen, '\0');
-            WideCharToMultiByte(CP_UTF8, 0, buffer, len, utf8.data(), outLen, nullptr, nullptr);
-            msg += utf8;
-            LocalFree(buffer);
+    // Exchange price text -> tick; identical to tickFromPrice(std::stod(text), tickSize)
+    // but plain decimals never go through a double.
+    bool tickFromPriceText(std::string_view text, double tickSize, dom::OrderBook::Tick &outTick)
+    {
+        if (quantizerFor(tickSize).tickFromDecimal(text, outTick))
+        {
+            return true;
         }
-        else
+        double price = 0.0;
+        if (!parseDoubleStrict(text, price))
         {
-            msg += "unknown error";
+            return false;
         }
-        return msg;
+        outTick = tickFromPrice(price, tickSize);
+        return true;
     }
 
-    struct WinHttpHandle
+    // JSON price (string or number) -> tick, same result as tickFromPrice(jsonToDouble(value), tickSize).
+    dom::OrderBook::Tick tickFromPriceJson(const json &value, double tickSize)
     {
-        WinHttpHandle() = default;
-        explicit WinHttpHandle(HINTERNET h) : handle(h) {}
-        ~WinHttpHandle() { reset(); }
-
-        WinHttpHandle(const WinHttpHandle&) = delete;
-        WinHttpHandle& operator=(const WinHttpHandle&) = delete;
-
-        WinHttpHandle(WinHttpHandle&& other) noexcept : handle(other.handle) { other.handle = nullptr; }
-        WinHttpHandle& operator=(WinHttpHandle&& other) noexcept
-        {
-            if (this != &other)
-            {
-                reset();
-                handle = other.handle;
-                other.handle = nullptr;
-            }
-            return *this;
-        }
-
-        void reset(HINTERNET h = nullptr)
+        dom::OrderBook::Tick tick = 0;
+        if (value.is_string() && tickFromPriceText(value.get_ref<const std::string &>(), tickSize, tick))
         {
-            if (handle)
-            {
-                WinHttpCloseHandle(handle);
-            }
-            handle = h;
+            return tick;
         }
+        return tickFromPrice(jsonToDouble(value), tickSize);
+    }
 
-        [[nodiscard]] bool valid() const { return handle != nullptr; }
-        [[nodiscard]] HINTERNET get() const { return handle; }
-
-    private:
-        HINTERNET handle{nullptr};
-    };
-
-    std::wstring toWide(const std::string& s)
+    // Qt copes with authenticated and SOCKS5 proxies better than WinHTTP, so
+    // proxied connections use it whenever the backend is built with Qt.
+    std::unique_ptr<net::WebSocket> connectWebSocket(const Config &cfg, const net::Url &url, std::string &error)
     {
-        if (s.empty())
+#if defined(ORDERBOOK_BACKEND_QT)
+        if (cfg.proxySettings.enabled())
         {
-            return {};
+            return net::qt::openWebSocket(url, cfg.proxySettings, error);
         }
-        int len = MultiByteToWideChar(CP_UTF8, 0, s.c_str(), -1, nullptr, 0);
-        std::wstring out(len - 1, L'\0');
-        MultiByteToWideChar(CP_UTF8, 0, s.c_str(), -1, out.data(), len);
-        return out;
+#endif
+        return net::openWebSocket(url, cfg.proxySettings, error);
     }
 
-    WinHttpHandle openSession(const Config &cfg)
+    std::optional<std::string> fetchUrl(const Config &cfg, const net::Url &url, std::string &error)
     {
-        if (!cfg.winProxy.empty())
+#if defined(ORDERBOOK_BACKEND_QT)
+        if (cfg.proxySettings.enabled())
         {
-            return WinHttpHandle(WinHttpOpen(L"Ghost/1.0",
-                                             WINHTTP_ACCESS_TYPE_NAMED_PROXY,
-                                             cfg.winProxy.c_str(),
-                                             WINHTTP_NO_PROXY_BYPASS,
-                                             0));
+            return net::qt::httpGet(url, cfg.proxySettings, error);
         }
-        return WinHttpHandle(WinHttpOpen(L"Ghost/1.0",
-                                         WINHTTP_ACCESS_TYPE_AUTOMATIC_PROXY,
-                                         nullptr,
-                                         nullptr,
-                                         0));
+#endif
+        return net::httpGet(url, cfg.proxySettings, error);
     }
 
-    void applyProxyCredentials(const Config &cfg, HINTERNET request)
+    // --record / --replay (Recording.hpp); set up in main() before any runner starts.
+    std::unique_ptr<net::Recorder> g_recorder;
+    std::unique_ptr<net::Replayer> g_replayer;
+
+    std::unique_ptr<net::WebSocket> openWebSocket(const Config &cfg, const char *venueUrl)
     {
-        if (!request || cfg.proxyUser.empty())
+        net::Url url;
+        net::parseUrl(cfg.endpoint.empty() ? std::string_view(venueUrl) : std::string_view(cfg.endpoint), url);
+
+        std::string error;
+        std::unique_ptr<net::WebSocket> ws =
+            g_replayer ? g_replayer->openWebSocket(url, error) : connectWebSocket(cfg, url, error);
+        if (!ws)
         {
-            return;
+            std::cerr << "[backend] " << url.host << ": " << error << std::endl;
+            return nullptr;
+        }
+        if (g_recorder)
+        {
+            ws = g_recorder->wrap(std::move(ws), url);
         }
-        // Best-effort: many proxies accept Basic auth.
-        WinHttpSetCredentials(request,
-                              WINHTTP_AUTH_TARGET_PROXY,
-                              WINHTTP_AUTH_SCHEME_BASIC,
-                              cfg.proxyUser.c_str(),
-                              cfg.proxyPass.c_str(),
-                              nullptr);
+        return ws;
     }
 
     std::optional<std::string> httpGet(const Config &cfg,
@@ -616,114 +664,592 @@ namespace
                                        const std::string& pathAndQuery,
                                        bool secure)
     {
-        WinHttpHandle session = openSession(cfg);
-        if (!session.valid())
+        net::Url url;
+        url.secure = secure;
+        url.host = host;
+        url.port = secure ? 443 : 80;
+        url.path = pathAndQuery;
+
+        std::string error;
+        std::optional<std::string> body = g_replayer ? g_replayer->httpGet(url, error) : fetchUrl(cfg, url, error);
+        if (!body)
         {
-            std::cerr << "[backend] " << winhttpError("WinHttpOpen") << std::endl;
+            std::cerr << "[backend] " << error << std::endl;
             return std::nullopt;
         }
+        if (g_recorder)
+        {
+            g_recorder->write(net::RecordKind::Http, net::urlKey(url), *body);
+        }
+        return body;
+    }
+
+    extern std::mutex g_bookMutex;
+
+    // One order book served by this process plus everything needed to publish it.
+    // A plain run has a single feed (id 0); --symbols creates one per symbol on a
+    // shared connection, and every frame / JSON message carries the feed id so the
+    // GUI can route it.
+    struct BookFeed
+    {
+        std::uint16_t id{0};
+        Config config; // process config with `symbol` set to this feed's symbol
+        dom::OrderBook book;
+        std::atomic<bool> ready{false};
+        std::chrono::steady_clock::time_point lastEmit{};
+
+        // Coalescing between throttled emits (guarded by g_bookMutex). Updates
+        // only land in the book and its change set; the next emit sends the
+        // latest value of every touched tick, whether it is triggered by a
+        // message or by ladderFlushThread.
+        bool pendingLadder{false};
+        std::chrono::steady_clock::time_point pendingSince{};
+        // pendingLadder is only set for rows held in coldTicks; those are due
+        // kColdFlushInterval after lastColdFlush rather than after the throttle.
+        bool pendingCold{false};
+        struct LadderStats
+        {
+            std::uint64_t emits{0};
+            std::uint64_t timerFlushes{0};    // emits made by ladderFlushThread
+            std::uint64_t coalescedUpdates{0}; // book updates folded into those emits
+            std::uint64_t overBound{0};        // emits later than the staleness bound
+            std::chrono::steady_clock::duration maxStaleness{};
+        } stats;
+        std::uint64_t emitCount{0}; // lifetime emitLadder calls, reported after --replay
+
+        // Last emitted window; ladder_delta rows come from OrderBook's change set.
+        dom::OrderBook::Tick lastWindowMinTick{0};
+        dom::OrderBook::Tick lastWindowMaxTick{0};
+        bool haveLastLadder{false};
+        bool forceFullLadder{false};
+        // Best prices of the last ladder sent; a changed one goes out even when
+        // every changed row is held back.
+        double sentBestBid{0.0};
+        double sentBestAsk{0.0};
+
+        // Rows the GUI shows (`set_viewport`). Changed ticks further than one
+        // viewport height from it are held in coldTicks and sent with a later
+        // emit; see holdColdTicks().
+        bool hasViewport{false};
+        dom::OrderBook::Tick viewportMinTick{0};
+        dom::OrderBook::Tick viewportMaxTick{0};
+        std::vector<dom::OrderBook::Tick> coldTicks;
+        std::chrono::steady_clock::time_point lastColdFlush{};
+        // Ticks per GUI row, also from `set_viewport`. A shared segment gets
+        // rows already summed to it; the pipe always carries raw ticks.
+        dom::OrderBook::Tick compression{1};
+
+        // Shared-memory transport (--shm). The GUI creates the mapping; the backend
+        // only opens it and is the single writer of both the ladder and the trade ring.
+        dom::shm::Segment shm;
+        bool shmActive{false};
+        std::mutex shmLadderMutex;
+        std::mutex shmTradeMutex;
+    };
+
+    // Filled before any WS or control thread starts; afterwards only `add_book`
+    // appends, under g_bookMutex. A deque never moves its elements, so BookFeed
+    // pointers held by the runners and workers stay valid.
+    std::deque<BookFeed> g_feeds;
+
+    BookFeed &addFeed(const Config &cfg)
+    {
+        BookFeed &feed = g_feeds.emplace_back();
+        feed.id = static_cast<std::uint16_t>(g_feeds.size() - 1);
+        feed.config = cfg;
+        feed.book.setStorage(cfg.bookStorage);
+        feed.book.setCacheLevelsPerSide(cfg.cacheLevelsPerSide);
+        return feed;
+    }
+
+    void emitLadder(BookFeed &feed, double bestBid, double bestAsk, std::int64_t ts);
+
+    constexpr auto kColdFlushInterval = 1s;
+    constexpr std::size_t kMaxColdTicks = std::size_t(1) << 14;
+
+    std::chrono::milliseconds stalenessBound(const Config &config)
+    {
+        return config.maxStaleness.count() > 0 ? config.maxStaleness : config.throttle;
+    }
 
-        const INTERNET_PORT port = secure ? INTERNET_DEFAULT_HTTPS_PORT : INTERNET_DEFAULT_HTTP_PORT;
-        WinHttpHandle connection(
-            WinHttpConnect(session.get(), toWide(host).c_str(), port, 0));
-        if (!connection.valid())
+    // Caller holds g_bookMutex.
+    void flushLadderLocked(BookFeed &feed, std::chrono::steady_clock::time_point now, bool fromTimer)
+    {
+        const auto staleness = now - feed.pendingSince;
+        auto &stats = feed.stats;
+        ++stats.emits;
+        if (fromTimer)
         {
-            std::cerr << "[backend] " << winhttpError("WinHttpConnect") << std::endl;
-            return std::nullopt;
+            ++stats.timerFlushes;
         }
+        // Held rows are late by design; the bound covers fresh updates only.
+        if (!feed.pendingCold)
+        {
+            stats.maxStaleness = std::max(stats.maxStaleness, staleness);
+            if (staleness > stalenessBound(feed.config))
+            {
+                ++stats.overBound;
+            }
+        }
+        feed.pendingLadder = false;
+        feed.pendingCold = false;
+        feed.lastEmit = now;
+        const auto nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                               std::chrono::system_clock::now().time_since_epoch())
+                               .count();
+        emitLadder(feed, feed.book.bestBid(), feed.book.bestAsk(), nowMs);
+    }
 
-        WinHttpHandle request(WinHttpOpenRequest(connection.get(),
-                                                 L"GET",
-                                                 toWide(pathAndQuery).c_str(),
-                                                 nullptr,
-                                                 WINHTTP_NO_REFERER,
-                                                 WINHTTP_DEFAULT_ACCEPT_TYPES,
-                                                 secure ? WINHTTP_FLAG_SECURE : 0));
-        if (!request.valid())
+    // Call with g_bookMutex held after every depth update or snapshot.
+    void bookChangedLocked(BookFeed &feed, std::chrono::steady_clock::time_point now)
+    {
+        if (!feed.pendingLadder || feed.pendingCold)
         {
-            std::cerr << "[backend] " << winhttpError("WinHttpOpenRequest") << std::endl;
-            return std::nullopt;
+            feed.pendingLadder = true;
+            feed.pendingCold = false;
+            feed.pendingSince = now;
+        }
+        ++feed.stats.coalescedUpdates;
+        if (now - feed.lastEmit >= feed.config.throttle)
+        {
+            flushLadderLocked(feed, now, false);
         }
+    }
+
+    // What a queued stdout message is, for collapsing and dropping.
+    enum class StdoutKind
+    {
+        Other,        // markers, errors: always written, in order
+        Trade,        // dropped once the queue is over kMaxQueuedBytes
+        TradeBell,    // ShmTrades doorbell: one queued per feed is enough
+        Ladder,       // full ladder or ShmLadder doorbell: replaces the feed's queued ladders
+        LadderDelta   // only valid on top of the previous ladder; never dropped on its own
+    };
 
-        applyProxyCredentials(cfg, request.get());
-        if (!WinHttpSendRequest(request.get(),
-                                WINHTTP_NO_ADDITIONAL_HEADERS,
-                                0,
-                                WINHTTP_NO_REQUEST_DATA,
-                                0,
-                                0,
-                                0))
+    // Owns stdout. Producers (WS, control and flush threads) only append to a
+    // queue; a writer thread drains everything queued into one write + flush.
+    // A stalled GUI therefore fills the queue, not the pipe of a thread that
+    // also has to keep the exchange socket alive. The queue stays bounded:
+    // a full ladder drops the feed's queued ladders and deltas (the GUI only
+    // needs the latest state), trades over kMaxQueuedBytes are dropped and
+    // counted. With `lossless` (--replay) nothing is collapsed or dropped and
+    // producers wait for room instead, so stdout stays deterministic.
+    class StdoutWriter
+    {
+    public:
+        static constexpr std::size_t kCollapseBytes = std::size_t(64) << 10;
+        static constexpr std::size_t kMaxQueuedBytes = std::size_t(8) << 20;
+
+        void setLossless(bool lossless)
         {
-            std::cerr << "[backend] " << winhttpError("WinHttpSendRequest") << std::endl;
-            return std::nullopt;
+            std::lock_guard<std::mutex> lock(mutex_);
+            lossless_ = lossless;
         }
 
-        if (!WinHttpReceiveResponse(request.get(), nullptr))
+        void push(StdoutKind kind, std::uint16_t feedId, std::string bytes)
         {
-            std::cerr << "[backend] " << winhttpError("WinHttpReceiveResponse") << std::endl;
-            return std::nullopt;
+            std::unique_lock<std::mutex> lock(mutex_);
+            startLocked();
+            if (lossless_)
+            {
+                roomCv_.wait(lock, [this] { return queuedBytes_ < kMaxQueuedBytes; });
+            }
+            else
+            {
+                switch (kind)
+                {
+                case StdoutKind::Trade:
+                    if (queuedBytes_ >= kMaxQueuedBytes)
+                    {
+                        if (backlogDrops_++ == 0)
+                        {
+                            std::cerr << "[backend] stdout backlog " << queuedBytes_
+                                      << " bytes, dropping trades until the GUI catches up" << std::endl;
+                        }
+                        ++stats_.droppedTrades;
+                        return;
+                    }
+                    break;
+                case StdoutKind::TradeBell:
+                {
+                    // The GUI reads the whole trade ring per doorbell. A queued
+                    // one still covers this trade unless a marker came after it.
+                    const auto it = tradeBells_.find(feedId);
+                    if (it != tradeBells_.end() && (!hasLastOther_ || it->second > lastOther_))
+                    {
+                        ++stats_.skippedBells;
+                        return;
+                    }
+                    tradeBells_[feedId] = queue_.size();
+                    break;
+                }
+                case StdoutKind::Ladder:
+                {
+                    auto &slots = ladders_[feedId];
+                    for (const std::size_t slot : slots)
+                    {
+                        queuedBytes_ -= queue_[slot].bytes.size();
+                        queue_[slot].bytes.clear();
+                        queue_[slot].bytes.shrink_to_fit();
+                        ++stats_.collapsedLadders;
+                    }
+                    slots.clear();
+                    slots.push_back(queue_.size());
+                    break;
+                }
+                case StdoutKind::LadderDelta:
+                    ladders_[feedId].push_back(queue_.size());
+                    break;
+                case StdoutKind::Other:
+                    lastOther_ = queue_.size();
+                    hasLastOther_ = true;
+                    break;
+                }
+            }
+            queuedBytes_ += bytes.size();
+            queue_.push_back(Item{std::move(bytes)});
+            stats_.maxQueuedBytes = std::max(stats_.maxQueuedBytes, queuedBytes_);
+            stats_.maxQueuedItems = std::max(stats_.maxQueuedItems, queue_.size());
+            if (queue_.size() == 1)
+            {
+                workCv_.notify_one();
+            }
         }
 
-        std::string buffer;
-        for (;;)
+        // True while a ladder of this feed is still queued behind a backlog;
+        // emitLadder then sends a full ladder, which collapses the queued ones.
+        bool backlogged(std::uint16_t feedId)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (lossless_ || queuedBytes_ < kCollapseBytes)
+            {
+                return false;
+            }
+            const auto it = ladders_.find(feedId);
+            return it != ladders_.end() && !it->second.empty();
+        }
+
+        // Blocks until everything queued so far has been written.
+        void drain()
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            roomCv_.wait(lock, [this] { return queue_.empty() && !writing_; });
+        }
+
+        void logStats()
         {
-            DWORD bytesAvailable = 0;
-            if (!WinHttpQueryDataAvailable(request.get(), &bytesAvailable))
+            Stats stats;
             {
-                std::cerr << "[backend] " << winhttpError("WinHttpQueryDataAvailable") << std::endl;
-                return std::nullopt;
+                std::lock_guard<std::mutex> lock(mutex_);
+                stats = std::exchange(stats_, Stats{});
             }
-            if (bytesAvailable == 0)
+            if (stats.batches == 0)
             {
-                break;
+                return;
             }
+            std::cerr << "[backend] stdout stats batches=" << stats.batches
+                      << " itemsPerBatch=" << static_cast<double>(stats.items) / static_cast<double>(stats.batches)
+                      << " maxQueuedBytes=" << stats.maxQueuedBytes << " maxQueuedItems=" << stats.maxQueuedItems
+                      << " collapsedLadders=" << stats.collapsedLadders << " skippedBells=" << stats.skippedBells
+                      << " droppedTrades=" << stats.droppedTrades << std::endl;
+        }
+
+    private:
+        struct Item
+        {
+            std::string bytes; // empty once collapsed
+        };
+
+        struct Stats
+        {
+            std::uint64_t batches = 0;
+            std::uint64_t items = 0;
+            std::size_t maxQueuedBytes = 0;
+            std::size_t maxQueuedItems = 0;
+            std::uint64_t collapsedLadders = 0;
+            std::uint64_t skippedBells = 0;
+            std::uint64_t droppedTrades = 0;
+        };
 
-            std::string chunk(bytesAvailable, '\0');
-            DWORD bytesRead = 0;
-            if (!WinHttpReadData(request.get(), chunk.data(), bytesAvailable, &bytesRead))
+        void startLocked()
+        {
+            if (!started_)
             {
-                std::cerr << "[backend] " << winhttpError("WinHttpReadData") << std::endl;
-                return std::nullopt;
+                started_ = true;
+                std::thread([this] { run(); }).detach();
             }
-            chunk.resize(bytesRead);
-            buffer += chunk;
         }
 
-        return buffer;
+        void run()
+        {
+            std::vector<Item> batch;
+            for (;;)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    writing_ = false;
+                    roomCv_.notify_all();
+                    workCv_.wait(lock, [this] { return !queue_.empty(); });
+                    // Slots index queue_, so they reset together with it.
+                    batch.swap(queue_);
+                    ladders_.clear();
+                    tradeBells_.clear();
+                    hasLastOther_ = false;
+                    queuedBytes_ = 0;
+                    writing_ = true;
+                    if (backlogDrops_ > 0)
+                    {
+                        std::cerr << "[backend] stdout backlog taken by the writer after dropping "
+                                  << backlogDrops_ << " trades" << std::endl;
+                        backlogDrops_ = 0;
+                    }
+                    ++stats_.batches;
+                    stats_.items += batch.size();
+                }
+                for (const Item &item : batch)
+                {
+                    std::cout.write(item.bytes.data(), static_cast<std::streamsize>(item.bytes.size()));
+                }
+                std::cout.flush();
+                batch.clear();
+            }
+        }
+
+        std::mutex mutex_;
+        std::condition_variable workCv_;
+        std::condition_variable roomCv_; // room in the queue, or the queue drained
+        std::vector<Item> queue_;
+        std::size_t queuedBytes_ = 0;
+        std::unordered_map<std::uint16_t, std::vector<std::size_t>> ladders_; // queued ladder slots per feed
+        std::unordered_map<std::uint16_t, std::size_t> tradeBells_;          // queued doorbell slot per feed
+        std::size_t lastOther_ = 0;
+        bool hasLastOther_ = false;
+        bool lossless_ = false;
+        std::uint64_t backlogDrops_ = 0; // trades dropped since the writer last took the queue
+        bool started_ = false;
+        bool writing_ = false;
+        Stats stats_;
+    };
+
+    // Never destroyed: the detached writer thread may still be waiting on it at exit.
+    StdoutWriter &g_stdout = *new StdoutWriter;
+
+    void writeStdoutLine(const json &msg, StdoutKind kind = StdoutKind::Other, std::uint16_t feedId = 0)
+    {
+        std::string line = msg.dump();
+        line.push_back('\n');
+        g_stdout.push(kind, feedId, std::move(line));
     }
 
-    extern std::mutex g_bookMutex;
-    void emitLadder(const Config& config,
-                    const dom::OrderBook& book,
-                    double bestBid,
-                    double bestAsk,
-                    std::int64_t ts);
+    void writeStdoutFrame(const std::string &frame, StdoutKind kind = StdoutKind::Other, std::uint16_t feedId = 0)
+    {
+        g_stdout.push(kind, feedId, frame);
+    }
 
-    bool parseIntStrict(std::string_view s, int &out)
+    bool openSharedSegment(BookFeed &feed, const std::string &name)
     {
-        if (s.empty())
+#ifndef _WIN32
+        // The GUI's segments are Win32 file mappings; elsewhere ladders go over stdout.
+        (void)feed;
+        std::cerr << "[backend] shared segment " << name << ": not supported on this platform" << std::endl;
+        return false;
+#else
+        HANDLE mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name.c_str());
+        if (!mapping)
         {
+            std::cerr << "[backend] OpenFileMapping(" << name << ") failed, error " << GetLastError() << std::endl;
             return false;
         }
-        int v = 0;
-        const auto *first = s.data();
-        const auto *last = s.data() + s.size();
-        auto res = std::from_chars(first, last, v);
-        if (res.ec != std::errc() || res.ptr != last)
+        void *view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+        if (!view)
         {
+            std::cerr << "[backend] MapViewOfFile(" << name << ") failed, error " << GetLastError() << std::endl;
+            CloseHandle(mapping);
             return false;
         }
-        out = v;
+        MEMORY_BASIC_INFORMATION info{};
+        VirtualQuery(view, &info, sizeof(info));
+        dom::shm::Segment segment(view, info.RegionSize);
+        if (!segment.valid())
+        {
+            std::cerr << "[backend] shared segment " << name << " has an unexpected layout" << std::endl;
+            UnmapViewOfFile(view);
+            CloseHandle(mapping);
+            return false;
+        }
+        // The view keeps the mapping alive until closeSharedSegment().
+        CloseHandle(mapping);
+        feed.shm = segment;
+        feed.shmActive = true;
         return true;
+#endif
     }
 
-    std::string upperAscii(std::string s)
+    // Caller holds g_bookMutex. `remove_book` hands the slot to another ladder,
+    // whose GUI creates a segment of its own.
+    void closeSharedSegment(BookFeed &feed)
     {
-        std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) {
-            return static_cast<char>(std::toupper(c));
-        });
-        return s;
-    }
+        if (!feed.shmActive)
+        {
+            return;
+        }
+        std::scoped_lock lock(feed.shmLadderMutex, feed.shmTradeMutex);
+        feed.shmActive = false;
+#ifdef _WIN32
+        UnmapViewOfFile(feed.shm.header());
+#endif
+        feed.shm = dom::shm::Segment{};
+    }
+
+    void writeDoorbell(dom::wire::FrameType type, std::uint16_t feedId)
+    {
+        thread_local dom::wire::FrameWriter writer;
+        writer.begin(type, feedId);
+        writeStdoutFrame(writer.finish(),
+                         type == dom::wire::FrameType::ShmTrades ? StdoutKind::TradeBell : StdoutKind::Ladder,
+                         feedId);
+    }
+
+    // Publishes the ladder rows into the segment; only the header crosses the pipe.
+    // `levels` are rows of `compression` ticks, the first one at `topRow`;
+    // `header` carries the raw window, which the doorbell frame reports.
+    void publishSharedLadder(BookFeed &feed,
+                             dom::wire::LadderHeader header,
+                             const std::vector<dom::Level> &levels,
+                             dom::OrderBook::Tick topRow,
+                             dom::OrderBook::Tick compression)
+    {
+        const std::size_t capacity = feed.shm.rowCapacity();
+        std::size_t first = 0;
+        std::size_t count = levels.size();
+        if (count > capacity)
+        {
+            // Keep the middle of the window; the GUI sized the segment for its own ladder.
+            first = (count - capacity) / 2;
+            count = capacity;
+        }
+        dom::wire::LadderHeader rowsHeader = header;
+        if (count > 0)
+        {
+            rowsHeader.windowMaxTick = topRow - static_cast<std::int64_t>(first) * compression;
+            rowsHeader.windowMinTick = rowsHeader.windowMaxTick - static_cast<std::int64_t>(count - 1) * compression;
+            header.windowMaxTick = std::min(header.windowMaxTick, rowsHeader.windowMaxTick);
+            header.windowMinTick = std::max(header.windowMinTick, rowsHeader.windowMinTick);
+        }
+
+        thread_local std::vector<double> bidCol;
+        thread_local std::vector<double> askCol;
+        bidCol.resize(count);
+        askCol.resize(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            bidCol[i] = levels[first + i].bidQuantity;
+            askCol[i] = levels[first + i].askQuantity;
+        }
+        {
+            std::lock_guard<std::mutex> lock(feed.shmLadderMutex);
+            feed.shm.publishLadder(rowsHeader,
+                                   bidCol.data(),
+                                   askCol.data(),
+                                   static_cast<std::uint32_t>(count),
+                                   static_cast<std::uint32_t>(compression));
+        }
+
+        thread_local dom::wire::FrameWriter writer;
+        writer.begin(dom::wire::FrameType::ShmLadder, feed.id);
+        writer.putHeader(header);
+        writeStdoutFrame(writer.finish(), StdoutKind::Ladder, feed.id);
+    }
+
+    // Quantizes the print to the book tick and writes it in the configured protocol.
+    void emitTrade(BookFeed &feed, double tickSize, double price, double qty, bool buy, std::int64_t ts)
+    {
+        const Config &config = feed.config;
+        dom::OrderBook::Tick tick = 0;
+        double snappedPrice = price;
+        const bool hasTick = quantizeTickFromPrice(price, tickSize, tick, snappedPrice);
+
+        if (config.binaryProtocol)
+        {
+            std::uint8_t flags = buy ? dom::wire::TradeBuy : 0;
+            if (hasTick)
+            {
+                flags |= dom::wire::TradeHasTick;
+            }
+            if (ts > 0)
+            {
+                flags |= dom::wire::TradeHasTimestamp;
+            }
+
+            if (feed.shmActive)
+            {
+                const dom::shm::TradeSlot slot{ts, hasTick ? tick : 0, hasTick ? snappedPrice : price, qty, flags};
+                {
+                    std::lock_guard<std::mutex> lock(feed.shmTradeMutex);
+                    feed.shm.pushTrade(slot);
+                }
+                writeDoorbell(dom::wire::FrameType::ShmTrades, feed.id);
+                return;
+            }
+
+            thread_local dom::wire::FrameWriter writer;
+            writer.begin(dom::wire::FrameType::Trade, feed.id);
+            writer.put<std::int64_t>(ts);
+            writer.put<std::int64_t>(hasTick ? tick : 0);
+            writer.put<double>(hasTick ? snappedPrice : price);
+            writer.put<double>(qty);
+            writer.put<std::uint8_t>(flags);
+            writeStdoutFrame(writer.finish(), StdoutKind::Trade, feed.id);
+            return;
+        }
+
+        json t;
+        t["type"] = "trade";
+        t["symbol"] = config.symbol;
+        t["book"] = feed.id;
+        if (hasTick)
+        {
+            t["tick"] = tick;
+            t["price"] = snappedPrice;
+        }
+        else
+        {
+            t["price"] = price;
+        }
+        t["qty"] = qty;
+        t["side"] = buy ? "buy" : "sell";
+        if (ts > 0)
+        {
+            t["timestamp"] = ts;
+        }
+        writeStdoutLine(t, StdoutKind::Trade, feed.id);
+    }
+
+    bool parseIntStrict(std::string_view s, int &out)
+    {
+        if (s.empty())
+        {
+            return false;
+        }
+        int v = 0;
+        const auto *first = s.data();
+        const auto *last = s.data() + s.size();
+        auto res = std::from_chars(first, last, v);
+        if (res.ec != std::errc() || res.ptr != last)
+        {
+            return false;
+        }
+        out = v;
+        return true;
+    }
+
+    std::string upperAscii(std::string s)
+    {
+        std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) {
+            return static_cast<char>(std::toupper(c));
+        });
+        return s;
+    }
 
     std::string alnumUpperKey(std::string s)
     {
@@ -762,106 +1288,6 @@ namespace
         return key;
     }
 
-#if defined(ORDERBOOK_BACKEND_QT)
-    bool shouldUseQtSocks5(const Config &cfg)
-    {
-        // Use Qt stack for any proxy type (HTTP/SOCKS5). WinHTTP proxy+WebSocket behavior is
-        // inconsistent across providers, especially with authentication.
-        return !trimAscii(cfg.proxy).empty();
-    }
-
-    QNetworkProxy toQtProxy(const Config &cfg, bool &outOk)
-    {
-        outOk = false;
-        const std::string raw = trimAscii(cfg.proxy);
-        if (raw.empty())
-        {
-            outOk = true;
-            return QNetworkProxy(QNetworkProxy::NoProxy);
-        }
-
-        std::string type;
-        std::string host;
-        int port = 0;
-        std::string user;
-        std::string pass;
-        std::string err;
-        if (!parseProxyString(raw, cfg.proxyType, type, host, port, user, pass, err))
-        {
-            std::cerr << "[backend] Invalid proxy: " << err << std::endl;
-            return QNetworkProxy(QNetworkProxy::NoProxy);
-        }
-
-        QNetworkProxy proxy((type == "socks5") ? QNetworkProxy::Socks5Proxy : QNetworkProxy::HttpProxy,
-                            QString::fromStdString(host),
-                            port,
-                            QString::fromStdString(user),
-                            QString::fromStdString(pass));
-        outOk = true;
-        return proxy;
-    }
-
-    std::optional<std::string> httpGetQt(const Config &cfg,
-                                         const char *host,
-                                         const std::string &path,
-                                         bool secure,
-                                         int timeoutMs = 15000)
-    {
-        bool ok = false;
-        const QNetworkProxy proxy = toQtProxy(cfg, ok);
-        if (!ok)
-        {
-            return std::nullopt;
-        }
-
-        QNetworkAccessManager nam;
-        nam.setProxy(proxy);
-
-        const QString fullUrl = QStringLiteral("%1://%2%3")
-                                    .arg(secure ? QStringLiteral("https") : QStringLiteral("http"),
-                                         QString::fromLatin1(host),
-                                         QString::fromStdString(path));
-        QUrl url(fullUrl);
-        if (!url.isValid())
-        {
-            std::cerr << "[backend] httpGetQt invalid url: " << fullUrl.toStdString() << std::endl;
-            return std::nullopt;
-        }
-
-        QNetworkRequest req(url);
-        req.setHeader(QNetworkRequest::UserAgentHeader, QStringLiteral("Ghost/1.0"));
-        req.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
-
-        QEventLoop loop;
-        QTimer timer;
-        timer.setSingleShot(true);
-        QObject::connect(&timer, &QTimer::timeout, &loop, [&]() { loop.quit(); });
-
-        QNetworkReply *reply = nam.get(req);
-        QObject::connect(reply, &QNetworkReply::finished, &loop, [&]() { loop.quit(); });
-        timer.start(timeoutMs);
-        loop.exec();
-
-        if (!timer.isActive())
-        {
-            reply->abort();
-        }
-
-        const auto err = reply->error();
-        const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-        const QByteArray body = reply->readAll();
-        reply->deleteLater();
-
-        if (err != QNetworkReply::NoError || status <= 0 || status >= 400)
-        {
-            std::cerr << "[backend] httpGetQt failed: host=" << host << " status=" << status
-                      << " err=" << static_cast<int>(err) << std::endl;
-            return std::nullopt;
-        }
-        return body.toStdString();
-    }
-#endif
-
     bool fetchLighterMarketInfo(const Config &cfg, int &marketIdOut, double &tickSizeOut)
     {
         constexpr const char *kHost = "mainnet.zklighter.elliot.ai";
@@ -873,12 +1299,7 @@ namespace
         {
             std::ostringstream path;
             path << "/api/v1/orderBookDetails?market_id=" << marketId;
-#if defined(ORDERBOOK_BACKEND_QT)
-            auto body = shouldUseQtSocks5(cfg) ? httpGetQt(cfg, kHost, path.str(), kSecure)
-                                              : httpGet(cfg, kHost, path.str(), kSecure);
-#else
             auto body = httpGet(cfg, kHost, path.str(), kSecure);
-#endif
             if (!body)
             {
                 std::cerr << "[backend] lighter orderBookDetails fetch failed" << std::endl;
@@ -926,12 +1347,7 @@ namespace
         }
 
         // Symbol mode: resolve market_id via filter=all.
-#if defined(ORDERBOOK_BACKEND_QT)
-        auto body = shouldUseQtSocks5(cfg) ? httpGetQt(cfg, kHost, "/api/v1/orderBookDetails?filter=all", kSecure)
-                                          : httpGet(cfg, kHost, "/api/v1/orderBookDetails?filter=all", kSecure);
-#else
         auto body = httpGet(cfg, kHost, "/api/v1/orderBookDetails?filter=all", kSecure);
-#endif
         if (!body)
         {
             std::cerr << "[backend] lighter orderBookDetails(all) fetch failed" << std::endl;
@@ -999,548 +1415,163 @@ namespace
         return false;
     }
 
-    bool runLighterWebSocket(const Config &config, dom::OrderBook &book, int marketId)
+    bool runLighterWebSocket(BookFeed &feed, int marketId)
     {
-#if defined(ORDERBOOK_BACKEND_QT)
-        if (shouldUseQtSocks5(config))
+        const Config &config = feed.config;
+        dom::OrderBook &book = feed.book;
+        const auto ws = openWebSocket(config, "wss://mainnet.zklighter.elliot.ai/stream");
+        if (!ws)
         {
-            bool proxyOk = false;
-            const QNetworkProxy proxy = toQtProxy(config, proxyOk);
-            if (!proxyOk)
-            {
-                return false;
-            }
-
-            QWebSocket ws;
-            ws.setProxy(proxy);
+            return false;
+        }
 
-            const QUrl url(QStringLiteral("wss://mainnet.zklighter.elliot.ai/stream"));
-            std::cerr << "[backend] lighter: using Qt WebSocket (proxy)\n";
+        std::cerr << "[backend] connected to Lighter ws" << std::endl;
 
-            const std::string subscribeBookStr =
-                json({{"type", "subscribe"}, {"channel", "order_book/" + std::to_string(marketId)}}).dump();
-            const std::string subscribeTradeStr =
-                json({{"type", "subscribe"}, {"channel", "trade/" + std::to_string(marketId)}}).dump();
+        const std::string subscribeBookStr =
+            json({{"type", "subscribe"}, {"channel", "order_book/" + std::to_string(marketId)}}).dump();
+        const std::string subscribeTradeStr =
+            json({{"type", "subscribe"}, {"channel", "trade/" + std::to_string(marketId)}}).dump();
 
-            bool subscribedBook = false;
-            bool subscribedTrade = false;
-            long long lastTradeId = 0;
-            auto lastEmit = std::chrono::steady_clock::now();
+        bool subscribedBook = false;
+        bool subscribedTrade = false;
+        long long lastTradeId = 0;
 
-            auto parseSide = [&](const json &levels) {
-                std::vector<std::pair<dom::OrderBook::Tick, double>> out;
-                if (!levels.is_array())
+        auto parseSide = [&](const json &levels) {
+            std::vector<std::pair<dom::OrderBook::Tick, double>> out;
+            if (!levels.is_array())
+            {
+                return out;
+            }
+            out.reserve(levels.size());
+            const double tickSize = book.tickSize();
+            for (const auto &lvl : levels)
+            {
+                if (!lvl.is_object())
+                {
+                    continue;
+                }
+                const double price = jsonToDouble(lvl.value("price", json(0.0)));
+                const double qty = jsonToDouble(lvl.value("size", json(0.0)));
+                if (!(price > 0.0) || !std::isfinite(price) || !std::isfinite(qty))
                 {
-                    return out;
+                    continue;
+                }
+                dom::OrderBook::Tick tick = 0;
+                double snapped = price;
+                if (!quantizeTickFromPrice(price, tickSize, tick, snapped))
+                {
+                    continue;
                 }
-                out.reserve(levels.size());
-                const double tickSize = book.tickSize();
-                for (const auto &lvl : levels)
+                out.emplace_back(tick, qty);
+            }
+            return out;
+        };
+
+        auto applyBookUpdate = [&](const json &orderBook, bool snapshot) {
+            if (!orderBook.is_object())
+            {
+                return;
+            }
+            const auto bids = parseSide(orderBook.value("bids", json::array()));
+            const auto asks = parseSide(orderBook.value("asks", json::array()));
+            std::lock_guard<std::mutex> lock(g_bookMutex);
+            if (snapshot)
+            {
+                book.loadSnapshot(bids, asks);
+            }
+            else
+            {
+                book.applyDelta(bids, asks, config.cacheLevelsPerSide);
+            }
+            bookChangedLocked(feed, std::chrono::steady_clock::now());
+        };
+
+        auto emitTradeBatch = [&](const json &arr) {
+            if (!arr.is_array())
+            {
+                return;
+            }
+            auto toLongLong = [](const json &v) -> long long {
+                try
                 {
-                    if (!lvl.is_object())
+                    if (v.is_number_integer())
                     {
-                        continue;
+                        return v.get<long long>();
                     }
-                    const double price = jsonToDouble(lvl.value("price", json(0.0)));
-                    const double qty = jsonToDouble(lvl.value("size", json(0.0)));
-                    if (!(price > 0.0) || !std::isfinite(price) || !std::isfinite(qty))
+                    if (v.is_number_float())
                     {
-                        continue;
+                        const double d = v.get<double>();
+                        if (std::isfinite(d))
+                        {
+                            return static_cast<long long>(std::llround(d));
+                        }
+                        return 0LL;
                     }
-                    dom::OrderBook::Tick tick = 0;
-                    double snapped = price;
-                    if (!quantizeTickFromPrice(price, tickSize, tick, snapped))
+                    if (v.is_string())
                     {
-                        continue;
+                        const std::string s = v.get<std::string>();
+                        if (s.empty())
+                        {
+                            return 0LL;
+                        }
+                        std::size_t idx = 0;
+                        const long long out = std::stoll(s, &idx, 10);
+                        return idx > 0 ? out : 0LL;
                     }
-                    out.emplace_back(tick, qty);
                 }
-                return out;
-            };
-
-            auto applyBookUpdate = [&](const json &orderBook, bool snapshot) {
-                if (!orderBook.is_object())
+                catch (...)
                 {
-                    return;
                 }
-                const auto bids = parseSide(orderBook.value("bids", json::array()));
-                const auto asks = parseSide(orderBook.value("asks", json::array()));
-                if (snapshot)
+                return 0LL;
+            };
+            const double tickSize = book.tickSize();
+            if (!(tickSize > 0.0) || !std::isfinite(tickSize))
+            {
+                return;
+            }
+            for (const auto &tIn : arr)
+            {
+                if (!tIn.is_object())
                 {
-                    std::lock_guard<std::mutex> lock(g_bookMutex);
-                    book.loadSnapshot(bids, asks);
+                    continue;
                 }
-                else
+                const long long tradeId = toLongLong(tIn.value("trade_id", json(0LL)));
+                if (tradeId > 0 && tradeId <= lastTradeId)
                 {
-                    std::lock_guard<std::mutex> lock(g_bookMutex);
-                    book.applyDelta(bids, asks, config.cacheLevelsPerSide);
+                    continue;
                 }
-                const auto now = std::chrono::steady_clock::now();
-                if (now - lastEmit >= config.throttle)
+                const double price = jsonToDouble(tIn.value("price", json(0.0)));
+                const double size = jsonToDouble(tIn.value("size", json(0.0)));
+                if (!(price > 0.0) || !(size > 0.0) || !std::isfinite(price) || !std::isfinite(size))
                 {
-                    lastEmit = now;
-                    const auto nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-                                           std::chrono::system_clock::now().time_since_epoch())
-                                           .count();
-                    emitLadder(config, book, book.bestBid(), book.bestAsk(), nowMs);
+                    continue;
                 }
-            };
-
-            auto emitTradeBatch = [&](const json &arr) {
-                if (!arr.is_array())
+                const bool isMakerAsk = tIn.value("is_maker_ask", false);
+                // If maker is ask (sell), taker is buy; use taker direction for prints.
+                const bool buy = isMakerAsk;
+                const long long ts = toLongLong(tIn.value("timestamp", json(0LL)));
+                emitTrade(feed, tickSize, price, size, buy, ts);
+                if (tradeId > 0)
                 {
-                    return;
-                }
-                auto toLongLong = [](const json &v) -> long long {
-                    try
-                    {
-                        if (v.is_number_integer())
-                        {
-                            return v.get<long long>();
-                        }
-                        if (v.is_number_float())
-                        {
-                            const double d = v.get<double>();
-                            if (std::isfinite(d))
-                            {
-                                return static_cast<long long>(std::llround(d));
-                            }
-                            return 0LL;
-                        }
-                        if (v.is_string())
-                        {
-                            const std::string s = v.get<std::string>();
-                            if (s.empty())
-                            {
-                                return 0LL;
-                            }
-                            std::size_t idx = 0;
-                            const long long out = std::stoll(s, &idx, 10);
-                            return idx > 0 ? out : 0LL;
-                        }
-                    }
-                    catch (...)
-                    {
-                    }
-                    return 0LL;
-                };
-                const double tickSize = book.tickSize();
-                if (!(tickSize > 0.0) || !std::isfinite(tickSize))
-                {
-                    return;
-                }
-                for (const auto &tIn : arr)
-                {
-                    if (!tIn.is_object())
-                    {
-                        continue;
-                    }
-                    const long long tradeId = toLongLong(tIn.value("trade_id", json(0LL)));
-                    if (tradeId > 0 && tradeId <= lastTradeId)
-                    {
-                        continue;
-                    }
-                    const double price = jsonToDouble(tIn.value("price", json(0.0)));
-                    const double size = jsonToDouble(tIn.value("size", json(0.0)));
-                    if (!(price > 0.0) || !(size > 0.0) || !std::isfinite(price) || !std::isfinite(size))
-                    {
-                        continue;
-                    }
-                    const bool isMakerAsk = tIn.value("is_maker_ask", false);
-                    const bool buy = isMakerAsk;
-                    const long long ts = toLongLong(tIn.value("timestamp", json(0LL)));
-
-                    json out;
-                    out["type"] = "trade";
-                    out["symbol"] = config.symbol;
-                    dom::OrderBook::Tick tick = 0;
-                    double snapped = price;
-                    if (quantizeTickFromPrice(price, tickSize, tick, snapped))
-                    {
-                        out["tick"] = tick;
-                        out["price"] = snapped;
-                    }
-                    else
-                    {
-                        out["price"] = price;
-                    }
-                    out["qty"] = size;
-                    out["side"] = buy ? "buy" : "sell";
-                    if (ts > 0)
-                    {
-                        out["timestamp"] = ts;
-                    }
-                    std::cout << out.dump() << '\n' << std::flush;
-                    if (tradeId > 0)
-                    {
-                        lastTradeId = std::max(lastTradeId, tradeId);
-                    }
-                }
-            };
-
-            QEventLoop loop;
-            QTimer watchdog;
-            watchdog.setSingleShot(false);
-            watchdog.start(20000);
-            QObject::connect(&watchdog, &QTimer::timeout, &loop, [&]() {
-                std::cerr << "[backend] lighter ws watchdog timeout\n";
-                ws.abort();
-                loop.quit();
-            });
-
-            QObject::connect(&ws, &QWebSocket::connected, &loop, [&]() {
-                std::cerr << "[backend] connected to Lighter ws (Qt)\n";
-            });
-            QObject::connect(&ws, &QWebSocket::disconnected, &loop, [&]() {
-                std::cerr << "[backend] Lighter WS disconnected (Qt)\n";
-                loop.quit();
-            });
-            QObject::connect(&ws,
-                             QOverload<QAbstractSocket::SocketError>::of(&QWebSocket::error),
-                             &loop,
-                             [&](QAbstractSocket::SocketError) {
-                                 std::cerr << "[backend] Lighter WS error (Qt): "
-                                           << ws.errorString().toStdString() << "\n";
-                                 loop.quit();
-                             });
-
-            QObject::connect(&ws, &QWebSocket::textMessageReceived, &loop, [&](const QString &msg) {
-                watchdog.start(20000);
-                json j;
-                try
-                {
-                    j = json::parse(msg.toStdString());
-                }
-                catch (const std::exception &ex)
-                {
-                    std::cerr << "[backend] Lighter JSON parse error (Qt): " << ex.what() << "\n";
-                    return;
-                }
-
-                const std::string typeStr = j.value("type", std::string());
-                if (typeStr == "ping")
-                {
-                    ws.sendTextMessage(QStringLiteral("{\"type\":\"pong\"}"));
-                    return;
-                }
-                if (typeStr == "connected")
-                {
-                    if (!subscribedBook)
-                    {
-                        ws.sendTextMessage(QString::fromStdString(subscribeBookStr));
-                        subscribedBook = true;
-                        std::cerr << "[backend] lighter subscribed: " << subscribeBookStr << "\n";
-                    }
-                    if (!subscribedTrade)
-                    {
-                        ws.sendTextMessage(QString::fromStdString(subscribeTradeStr));
-                        subscribedTrade = true;
-                        std::cerr << "[backend] lighter subscribed: " << subscribeTradeStr << "\n";
-                    }
-                    return;
-                }
-                if (typeStr == "subscribed/order_book")
-                {
-                    applyBookUpdate(j.value("order_book", json::object()), true);
-                    return;
-                }
-                if (typeStr == "update/order_book")
-                {
-                    applyBookUpdate(j.value("order_book", json::object()), false);
-                    return;
-                }
-                if (typeStr == "subscribed/trade" || typeStr == "update/trade")
-                {
-                    emitTradeBatch(j.value("trades", json::array()));
-                    return;
-                }
-            });
-
-            ws.open(url);
-            loop.exec();
-            return true;
-        }
-#endif
-        const std::wstring host = L"mainnet.zklighter.elliot.ai";
-        const std::wstring path = L"/stream";
-
-        WinHttpHandle session = openSession(config);
-        if (!session.valid())
-        {
-            std::cerr << "[backend] " << winhttpError("WinHttpOpen") << std::endl;
-            return false;
-        }
-
-        WinHttpHandle connection(
-            WinHttpConnect(session.get(), host.c_str(), INTERNET_DEFAULT_HTTPS_PORT, 0));
-        if (!connection.valid())
-        {
-            std::cerr << "[backend] " << winhttpError("WinHttpConnect") << std::endl;
-            return false;
-        }
-
-        WinHttpHandle request(WinHttpOpenRequest(connection.get(),
-                                                 L"GET",
-                                                 path.c_str(),
-                                                 nullptr,
-                                                 WINHTTP_NO_REFERER,
-                                                 WINHTTP_DEFAULT_ACCEPT_TYPES,
-                                                 WINHTTP_FLAG_SECURE));
-        if (!request.valid())
-        {
-            std::cerr << "[backend] " << winhttpError("WinHttpOpenRequest") << std::endl;
-            return false;
-        }
-
-        applyProxyCredentials(config, request.get());
-        if (!WinHttpSetOption(request.get(), WINHTTP_OPTION_UPGRADE_TO_WEB_SOCKET, nullptr, 0))
-        {
-            std::cerr << "[backend] " << winhttpError("WinHttpSetOption") << std::endl;
-            return false;
-        }
-
-        if (!WinHttpSendRequest(request.get(),
-                                WINHTTP_NO_ADDITIONAL_HEADERS,
-                                0,
-                                WINHTTP_NO_REQUEST_DATA,
-                                0,
-                                0,
-                                0))
-        {
-            std::cerr << "[backend] " << winhttpError("WinHttpSendRequest") << std::endl;
-            return false;
-        }
-
-        if (!WinHttpReceiveResponse(request.get(), nullptr))
-        {
-            std::cerr << "[backend] " << winhttpError("WinHttpReceiveResponse") << std::endl;
-            return false;
-        }
-
-        HINTERNET rawSocket = WinHttpWebSocketCompleteUpgrade(request.get(), 0);
-        if (!rawSocket)
-        {
-            std::cerr << "[backend] " << winhttpError("WinHttpWebSocketCompleteUpgrade") << std::endl;
-            return false;
-        }
-        WinHttpCloseHandle(request.get());
-
-        std::cerr << "[backend] connected to Lighter ws" << std::endl;
-
-        const std::string subscribeBookStr =
-            json({{"type", "subscribe"}, {"channel", "order_book/" + std::to_string(marketId)}}).dump();
-        const std::string subscribeTradeStr =
-            json({{"type", "subscribe"}, {"channel", "trade/" + std::to_string(marketId)}}).dump();
-
-        std::vector<unsigned char> buffer(256 * 1024);
-        std::string fragmentBuffer;
-        bool subscribedBook = false;
-        bool subscribedTrade = false;
-        long long lastTradeId = 0;
-        auto lastEmit = std::chrono::steady_clock::now();
-
-        auto parseSide = [&](const json &levels) {
-            std::vector<std::pair<dom::OrderBook::Tick, double>> out;
-            if (!levels.is_array())
-            {
-                return out;
-            }
-            out.reserve(levels.size());
-            const double tickSize = book.tickSize();
-            for (const auto &lvl : levels)
-            {
-                if (!lvl.is_object())
-                {
-                    continue;
-                }
-                const double price = jsonToDouble(lvl.value("price", json(0.0)));
-                const double qty = jsonToDouble(lvl.value("size", json(0.0)));
-                if (!(price > 0.0) || !std::isfinite(price) || !std::isfinite(qty))
-                {
-                    continue;
-                }
-                dom::OrderBook::Tick tick = 0;
-                double snapped = price;
-                if (!quantizeTickFromPrice(price, tickSize, tick, snapped))
-                {
-                    continue;
-                }
-                out.emplace_back(tick, qty);
-            }
-            return out;
-        };
-
-        auto applyBookUpdate = [&](const json &orderBook, bool snapshot) {
-            if (!orderBook.is_object())
-            {
-                return;
-            }
-            const auto bids = parseSide(orderBook.value("bids", json::array()));
-            const auto asks = parseSide(orderBook.value("asks", json::array()));
-            if (snapshot)
-            {
-                std::lock_guard<std::mutex> lock(g_bookMutex);
-                book.loadSnapshot(bids, asks);
-            }
-            else
-            {
-                std::lock_guard<std::mutex> lock(g_bookMutex);
-                book.applyDelta(bids, asks, config.cacheLevelsPerSide);
-            }
-            const auto now = std::chrono::steady_clock::now();
-            if (now - lastEmit >= config.throttle)
-            {
-                lastEmit = now;
-                const auto nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-                                       std::chrono::system_clock::now().time_since_epoch())
-                                       .count();
-                emitLadder(config, book, book.bestBid(), book.bestAsk(), nowMs);
-            }
-        };
-
-        auto emitTradeBatch = [&](const json &arr) {
-            if (!arr.is_array())
-            {
-                return;
-            }
-            auto toLongLong = [](const json &v) -> long long {
-                try
-                {
-                    if (v.is_number_integer())
-                    {
-                        return v.get<long long>();
-                    }
-                    if (v.is_number_float())
-                    {
-                        const double d = v.get<double>();
-                        if (std::isfinite(d))
-                        {
-                            return static_cast<long long>(std::llround(d));
-                        }
-                        return 0LL;
-                    }
-                    if (v.is_string())
-                    {
-                        const std::string s = v.get<std::string>();
-                        if (s.empty())
-                        {
-                            return 0LL;
-                        }
-                        std::size_t idx = 0;
-                        const long long out = std::stoll(s, &idx, 10);
-                        return idx > 0 ? out : 0LL;
-                    }
-                }
-                catch (...)
-                {
-                }
-                return 0LL;
-            };
-            const double tickSize = book.tickSize();
-            if (!(tickSize > 0.0) || !std::isfinite(tickSize))
-            {
-                return;
-            }
-            for (const auto &tIn : arr)
-            {
-                if (!tIn.is_object())
-                {
-                    continue;
-                }
-                const long long tradeId = toLongLong(tIn.value("trade_id", json(0LL)));
-                if (tradeId > 0 && tradeId <= lastTradeId)
-                {
-                    continue;
-                }
-                const double price = jsonToDouble(tIn.value("price", json(0.0)));
-                const double size = jsonToDouble(tIn.value("size", json(0.0)));
-                if (!(price > 0.0) || !(size > 0.0) || !std::isfinite(price) || !std::isfinite(size))
-                {
-                    continue;
-                }
-                const bool isMakerAsk = tIn.value("is_maker_ask", false);
-                // If maker is ask (sell), taker is buy; use taker direction for prints.
-                const bool buy = isMakerAsk;
-                const long long ts = toLongLong(tIn.value("timestamp", json(0LL)));
-
-                json out;
-                out["type"] = "trade";
-                out["symbol"] = config.symbol;
-                dom::OrderBook::Tick tick = 0;
-                double snapped = price;
-                if (quantizeTickFromPrice(price, tickSize, tick, snapped))
-                {
-                    out["tick"] = tick;
-                    out["price"] = snapped;
-                }
-                else
-                {
-                    out["price"] = price;
-                }
-                out["qty"] = size;
-                out["side"] = buy ? "buy" : "sell";
-                if (ts > 0)
-                {
-                    out["timestamp"] = ts;
-                }
-                std::cout << out.dump() << '\n' << std::flush;
-                if (tradeId > 0)
-                {
-                    lastTradeId = std::max(lastTradeId, tradeId);
+                    lastTradeId = std::max(lastTradeId, tradeId);
                 }
             }
         };
 
+        std::string message;
+        net::MessageType type = net::MessageType::Text;
         for (;;)
         {
-            DWORD received = 0;
-            WINHTTP_WEB_SOCKET_BUFFER_TYPE type;
-            HRESULT hr =
-                WinHttpWebSocketReceive(rawSocket, buffer.data(), static_cast<DWORD>(buffer.size()), &received, &type);
-            if (FAILED(hr))
-            {
-                std::cerr << "[backend] Lighter WS receive failed: " << std::hex << hr << std::dec << std::endl;
-                break;
-            }
-            if (type == WINHTTP_WEB_SOCKET_CLOSE_BUFFER_TYPE)
+            if (!ws->receive(message, type))
             {
-                std::cerr << "[backend] Lighter WS closed by server\n";
+                std::cerr << "[backend] Lighter WS: " << ws->error() << std::endl;
                 break;
             }
-            if (received == 0)
-            {
-                continue;
-            }
-            if (type != WINHTTP_WEB_SOCKET_UTF8_MESSAGE_BUFFER_TYPE &&
-                type != WINHTTP_WEB_SOCKET_UTF8_FRAGMENT_BUFFER_TYPE)
-            {
-                continue;
-            }
-
-            const std::string_view chunk(reinterpret_cast<char *>(buffer.data()), received);
-            const bool isFragment = (type == WINHTTP_WEB_SOCKET_UTF8_FRAGMENT_BUFFER_TYPE);
-            if (isFragment)
+            if (type != net::MessageType::Text)
             {
-                fragmentBuffer.append(chunk.data(), chunk.size());
-                if (fragmentBuffer.size() > 4 * 1024 * 1024)
-                {
-                    std::cerr << "[backend] Lighter WS fragment buffer too large, dropping\n";
-                    fragmentBuffer.clear();
-                }
                 continue;
             }
 
-            std::string message;
-            if (!fragmentBuffer.empty())
-            {
-                fragmentBuffer.append(chunk.data(), chunk.size());
-                message.swap(fragmentBuffer);
-            }
-            else
-            {
-                message.assign(chunk);
-            }
-
             json j;
             try
             {
@@ -1555,11 +1586,7 @@ namespace
             const std::string typeStr = j.value("type", std::string());
             if (typeStr == "ping")
             {
-                const std::string pong = R"({"type":"pong"})";
-                WinHttpWebSocketSend(rawSocket,
-                                     WINHTTP_WEB_SOCKET_UTF8_MESSAGE_BUFFER_TYPE,
-                                     (void *)pong.data(),
-                                     static_cast<DWORD>(pong.size()));
+                ws->sendText(R"({"type":"pong"})");
                 continue;
             }
 
@@ -1567,19 +1594,13 @@ namespace
             {
                 if (!subscribedBook)
                 {
-                    WinHttpWebSocketSend(rawSocket,
-                                         WINHTTP_WEB_SOCKET_UTF8_MESSAGE_BUFFER_TYPE,
-                                         (void *)subscribeBookStr.data(),
-                                         static_cast<DWORD>(subscribeBookStr.size()));
+                    ws->sendText(subscribeBookStr);
                     subscribedBook = true;
                     std::cerr << "[backend] lighter subscribed: " << subscribeBookStr << std::endl;
                 }
                 if (!subscribedTrade)
                 {
-                    WinHttpWebSocketSend(rawSocket,
-                                         WINHTTP_WEB_SOCKET_UTF8_MESSAGE_BUFFER_TYPE,
-                                         (void *)subscribeTradeStr.data(),
-                                         static_cast<DWORD>(subscribeTradeStr.size()));
+                    ws->sendText(subscribeTradeStr);
                     subscribedTrade = true;
                     std::cerr << "[backend] lighter subscribed: " << subscribeTradeStr << std::endl;
                 }
@@ -1605,8 +1626,7 @@ namespace
             }
         }
 
-        WinHttpWebSocketClose(rawSocket, WINHTTP_WEB_SOCKET_SUCCESS_CLOSE_STATUS, nullptr, 0);
-        WinHttpCloseHandle(rawSocket);
+        ws->close();
         return true;
     }
 
@@ -1684,15 +1704,11 @@ namespace
         return tickSizeOut > 0.0;
     }
 
-    bool fetchSnapshot(const Config& cfg, dom::OrderBook& book)
+    bool fetchSnapshotRows(const Config &cfg,
+                           double tickSize,
+                           std::vector<std::pair<dom::OrderBook::Tick, double>> &bids,
+                           std::vector<std::pair<dom::OrderBook::Tick, double>> &asks)
     {
-        const double tickSize = book.tickSize();
-        if (tickSize <= 0.0)
-        {
-            std::cerr << "[backend] fetchSnapshot: tickSize is not set" << std::endl;
-            return false;
-        }
-
         std::ostringstream path;
         path << "/api/v3/depth?symbol=" << cfg.symbol << "&limit=" << cfg.snapshotDepth;
 
@@ -1713,30 +1729,41 @@ namespace
             return false;
         }
 
-        std::vector<std::pair<dom::OrderBook::Tick, double>> bids;
-        std::vector<std::pair<dom::OrderBook::Tick, double>> asks;
-
         auto parseSide = [tickSize](const json& arr,
                                     std::vector<std::pair<dom::OrderBook::Tick, double>>& out) {
             out.clear();
             for (const auto& e : arr)
             {
                 if (!e.is_array() || e.size() < 2) continue;
-                double price = std::stod(e[0].get<std::string>());
-                double qty = std::stod(e[1].get<std::string>());
-                const auto tick = tickFromPrice(price, tickSize);
-                out.emplace_back(tick, qty);
+                const auto tick = tickFromPriceJson(e[0], tickSize);
+                out.emplace_back(tick, jsonToDouble(e[1]));
             }
         };
 
         parseSide(j["bids"], bids);
         parseSide(j["asks"], asks);
-        book.loadSnapshot(bids, asks);
-
         std::cerr << "[backend] snapshot loaded: bids=" << bids.size() << " asks=" << asks.size() << std::endl;
         return true;
     }
 
+    bool fetchSnapshot(const Config& cfg, dom::OrderBook& book)
+    {
+        const double tickSize = book.tickSize();
+        if (tickSize <= 0.0)
+        {
+            std::cerr << "[backend] fetchSnapshot: tickSize is not set" << std::endl;
+            return false;
+        }
+        std::vector<std::pair<dom::OrderBook::Tick, double>> bids;
+        std::vector<std::pair<dom::OrderBook::Tick, double>> asks;
+        if (!fetchSnapshotRows(cfg, tickSize, bids, asks))
+        {
+            return false;
+        }
+        book.loadSnapshot(bids, asks);
+        return true;
+    }
+
     bool fetchFuturesContractInfo(const Config &cfg, double &tickSizeOut, double &contractSizeOut)
     {
         std::ostringstream path;
@@ -1856,6 +1883,12 @@ namespace
 
     // --- минимальный парсер protobuf под нужные сообщения ---
 
+    struct TransparentStringHash
+    {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+    };
+
     struct ProtoReader
     {
         const std::uint8_t* data{};
@@ -1889,25 +1922,17 @@ namespace
             return false;
         }
 
-        bool readBytes(std::size_t n, std::string& out)
-        {
-            if (pos + n > size)
-            {
-                return false;
-            }
-            out.assign(reinterpret_cast<const char*>(data + pos), n);
-            pos += n;
-            return true;
-        }
-
-        bool readLengthDelimited(std::string& out)
+        // The view points into the reader's buffer; nothing is copied.
+        bool readLengthDelimited(std::string_view& out)
         {
             std::uint64_t len = 0;
-            if (!readVarint(len))
+            if (!readVarint(len) || len > size - pos)
             {
                 return false;
             }
-            return readBytes(static_cast<std::size_t>(len), out);
+            out = std::string_view(reinterpret_cast<const char*>(data + pos), static_cast<std::size_t>(len));
+            pos += static_cast<std::size_t>(len);
+            return true;
         }
 
         bool skipField(std::uint64_t key)
@@ -1944,13 +1969,13 @@ namespace
         }
     };
 
-    void parseDepthItem(const std::string& buf,
+    void parseDepthItem(std::string_view buf,
                         double tickSize,
                         std::vector<std::pair<dom::OrderBook::Tick, double>>& out)
     {
         ProtoReader r(buf.data(), buf.size());
-        std::string priceStr;
-        std::string qtyStr;
+        std::string_view priceStr;
+        std::string_view qtyStr;
         while (!r.eof())
         {
             std::uint64_t key = 0;
@@ -1962,7 +1987,7 @@ namespace
                 continue;
             }
 
-            std::string value;
+            std::string_view value;
             if (!r.readLengthDelimited(value)) break;
 
             if (field == 1)
@@ -1975,16 +2000,16 @@ namespace
             }
         }
 
-        if (!priceStr.empty() && tickSize > 0.0)
+        dom::OrderBook::Tick tick = 0;
+        double qty = 0.0;
+        if (tickSize > 0.0 && tickFromPriceText(priceStr, tickSize, tick)
+            && (qtyStr.empty() || parseDoubleStrict(qtyStr, qty)))
         {
-            double price = std::stod(priceStr);
-            double qty = qtyStr.empty() ? 0.0 : std::stod(qtyStr);
-            const auto tick = tickFromPrice(price, tickSize);
             out.emplace_back(tick, qty);
         }
     }
 
-    void parseAggreDepth(const std::string& buf,
+    void parseAggreDepth(std::string_view buf,
                          double tickSize,
                          std::vector<std::pair<dom::OrderBook::Tick, double>>& asks,
                          std::vector<std::pair<dom::OrderBook::Tick, double>>& bids)
@@ -2001,7 +2026,7 @@ namespace
                 continue;
             }
 
-            std::string msg;
+            std::string_view msg;
             if (!r.readLengthDelimited(msg)) break;
 
             if (field == 1) // asks
@@ -2024,12 +2049,12 @@ namespace
         std::int64_t time{};
     };
 
-    void parseAggreDealItem(const std::string& buf,
+    void parseAggreDealItem(std::string_view buf,
                             std::vector<PublicAggreDeal>& out)
     {
         ProtoReader r(buf.data(), buf.size());
-        std::string priceStr;
-        std::string qtyStr;
+        std::string_view priceStr;
+        std::string_view qtyStr;
         int tradeType = 0;
         std::int64_t time = 0;
 
@@ -2042,7 +2067,7 @@ namespace
 
             if (wire == 2)
             {
-                std::string value;
+                std::string_view value;
                 if (!r.readLengthDelimited(value)) break;
                 if (field == 1)
                 {
@@ -2072,10 +2097,10 @@ namespace
             }
         }
 
-        if (!priceStr.empty())
+        double price = 0.0;
+        double qty = 0.0;
+        if (parseDoubleStrict(priceStr, price) && parseDoubleStrict(qtyStr, qty))
         {
-            double price = std::stod(priceStr);
-            double qty = qtyStr.empty() ? 0.0 : std::stod(qtyStr);
             if (qty <= 0.0) return;
 
             PublicAggreDeal d;
@@ -2088,7 +2113,7 @@ namespace
         }
     }
 
-    void parseAggreDeals(const std::string& buf,
+    void parseAggreDeals(std::string_view buf,
                          std::vector<PublicAggreDeal>& out)
     {
         ProtoReader r(buf.data(), buf.size());
@@ -2103,7 +2128,7 @@ namespace
                 continue;
             }
 
-            std::string msg;
+            std::string_view msg;
             if (!r.readLengthDelimited(msg)) break;
 
             if (field == 1) // repeated deals
@@ -2114,149 +2139,490 @@ namespace
         }
     }
 
-    bool parsePushWrapper(const void* data,
-                          std::size_t len,
-                          std::string& channelOut,
-                          double tickSize,
-                          std::vector<std::pair<dom::OrderBook::Tick, double>>& asks,
-                          std::vector<std::pair<dom::OrderBook::Tick, double>>& bids)
+    // Top-level PushDataV3ApiWrapper: channel (1), symbol (3) and the depth (313)
+    // or deals (314) body. Bodies are left undecoded so the caller can pick the
+    // right book (and tick size) first. All fields are views into the receive
+    // buffer and stay valid until the next WebSocket::receive().
+    struct PushWrapper
+    {
+        std::string_view channel;
+        std::string_view symbol;
+        std::string_view depthBody;
+        std::string_view dealsBody;
+    };
+
+    bool parsePushWrapper(const void* data, std::size_t len, PushWrapper& out)
+    {
+        out = PushWrapper{};
+
+        ProtoReader r(data, len);
+        while (!r.eof())
+        {
+            std::uint64_t key = 0;
+            if (!r.readVarint(key)) break;
+            const auto field = key >> 3;
+
+            if ((key & 0x7) != 2)
+            {
+                if (!r.skipField(key)) break;
+                continue;
+            }
+
+            std::string_view value;
+            if (!r.readLengthDelimited(value)) break;
+
+            if (field == 1)
+            {
+                out.channel = value;
+            }
+            else if (field == 3)
+            {
+                out.symbol = value;
+            }
+            else if (field == 313)
+            {
+                out.depthBody = value;
+            }
+            else if (field == 314)
+            {
+                out.dealsBody = value;
+            }
+        }
+
+        if (out.symbol.empty())
+        {
+            // Channels end with "@<SYMBOL>".
+            const auto at = out.channel.rfind('@');
+            if (at != std::string_view::npos)
+            {
+                out.symbol = out.channel.substr(at + 1);
+            }
+        }
+        return !out.depthBody.empty() || !out.dealsBody.empty();
+    }
+
+    std::mutex g_bookMutex;
+
+    // Locked because `add_book` can append to g_feeds while workers look up.
+    BookFeed *feedAt(std::uint16_t id)
+    {
+        std::lock_guard<std::mutex> lock(g_bookMutex);
+        return id < g_feeds.size() ? &g_feeds[id] : nullptr;
+    }
+
+    // Control commands address a feed by id; a missing "book" means feed 0.
+    BookFeed *readyFeed(std::uint16_t id)
+    {
+        BookFeed *feed = feedAt(id);
+        return feed && feed->ready.load() ? feed : nullptr;
+    }
+
+    void emitCurrentLadderLocked(BookFeed &feed)
+    {
+        const double bestBid = feed.book.bestBid();
+        const double bestAsk = feed.book.bestAsk();
+        const auto nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                               std::chrono::system_clock::now().time_since_epoch())
+                               .count();
+        // Carries any coalesced depth changes as well.
+        feed.pendingLadder = false;
+        feed.pendingCold = false;
+        emitLadder(feed, bestBid, bestAsk, nowMs);
+    }
+
+    void emitCurrentLadder(std::uint16_t feedId)
+    {
+        BookFeed *feed = readyFeed(feedId);
+        if (!feed) return;
+        std::lock_guard<std::mutex> lock(g_bookMutex);
+        emitCurrentLadderLocked(*feed);
+    }
+
+    void applyShiftAndEmit(std::uint16_t feedId, dom::OrderBook::Tick delta)
+    {
+        BookFeed *feed = readyFeed(feedId);
+        if (!feed) return;
+        std::lock_guard<std::mutex> lock(g_bookMutex);
+        feed->book.shiftManualCenterTicks(delta);
+        emitCurrentLadderLocked(*feed);
+    }
+
+    void clearManualCenterAndEmit(std::uint16_t feedId)
+    {
+        BookFeed *feed = readyFeed(feedId);
+        if (!feed) return;
+        std::lock_guard<std::mutex> lock(g_bookMutex);
+        feed->haveLastLadder = false;
+        feed->forceFullLadder = true;
+        feed->book.clearManualCenter();
+        emitCurrentLadderLocked(*feed);
+    }
+
+    void setLadderLevels(std::uint16_t feedId, std::size_t levels)
+    {
+        BookFeed *feed = readyFeed(feedId);
+        if (!feed) return;
+        std::lock_guard<std::mutex> lock(g_bookMutex);
+        Config &config = feed->config;
+        config.ladderLevelsPerSide = levels;
+        if (levels > config.cacheLevelsPerSide)
+        {
+            config.cacheLevelsPerSide = levels;
+            feed->book.setCacheLevelsPerSide(levels);
+        }
+        // The window changes size, so no delta against the previous one.
+        feed->forceFullLadder = true;
+        emitCurrentLadderLocked(*feed);
+    }
+
+    void setViewport(std::uint16_t feedId,
+                     dom::OrderBook::Tick minTick,
+                     dom::OrderBook::Tick maxTick,
+                     dom::OrderBook::Tick compression)
+    {
+        BookFeed *feed = readyFeed(feedId);
+        if (!feed) return;
+        std::lock_guard<std::mutex> lock(g_bookMutex);
+        feed->hasViewport = true;
+        feed->viewportMinTick = minTick;
+        feed->viewportMaxTick = maxTick;
+        const bool regroup = feed->shmActive && compression != feed->compression;
+        feed->compression = compression;
+        // Held rows the viewport scrolled towards, or segment rows in the new
+        // compression, go out now rather than at the next book update.
+        if (!feed->coldTicks.empty() || regroup)
+        {
+            emitCurrentLadderLocked(*feed);
+        }
+    }
+
+    void setLadderThrottle(std::uint16_t feedId,
+                           std::chrono::milliseconds throttle,
+                           std::optional<std::chrono::milliseconds> maxStaleness)
+    {
+        BookFeed *feed = readyFeed(feedId);
+        if (!feed) return;
+        std::lock_guard<std::mutex> lock(g_bookMutex);
+        feed->config.throttle = throttle;
+        if (maxStaleness)
+        {
+            feed->config.maxStaleness = *maxStaleness;
+        }
+        // ladderFlushThread picks up the new period after its current sleep.
+    }
+
+    // `resubscribe` moves a feed to another symbol without a new process or
+    // connection; `add_book` and `remove_book` start and stop serving a feed
+    // the same way, so the GUI can open or close one ladder of a --symbols
+    // process without restarting the others. Only the runners that multiplex
+    // symbols on one socket (MEXC spot, Binance) take them. A worker thread
+    // per request fetches the tick size and the snapshot while the old stream
+    // keeps running, so the control thread never waits on REST. It queues them
+    // here and wakes the stream thread, which swaps the feed over before it
+    // routes its next message and subscribes a symbol only when its first
+    // feed arrives, so the routing tables, subscriptions and diff-sync state
+    // stay private to that thread.
+    struct PendingResubscribe
+    {
+        enum class Change
+        {
+            Switch, // `resubscribe` of a served feed
+            Add,    // `add_book`: an idle feed (new, removed or never initialised)
+            Remove  // `remove_book`: no fetch, only `feed` is set
+        };
+        Change change{Change::Switch};
+        BookFeed *feed{nullptr};
+        std::string symbol;
+        std::string shmName; // Add only; empty for the pipe
+        double tickSize{0.0};
+        std::vector<std::pair<dom::OrderBook::Tick, double>> bids;
+        std::vector<std::pair<dom::OrderBook::Tick, double>> asks;
+        long long lastUpdateId{0}; // Binance diff-depth sync point; 0 if the snapshot failed
+    };
+
+    std::mutex g_resubscribeMutex;
+    std::vector<PendingResubscribe> g_resubscribes; // guarded by g_resubscribeMutex
+    std::atomic<bool> g_resubscribePending{false};
+    net::WebSocket *g_streamSocket{nullptr}; // guarded by g_resubscribeMutex
+    std::string g_streamWake;                 // guarded by g_resubscribeMutex
+    // Latest `resubscribe` per feed (guarded by g_resubscribeMutex). Fetches
+    // can finish out of order; only the newest request of a feed is applied.
+    std::unordered_map<std::uint16_t, std::uint64_t> g_resubscribeSeq;
+    // --symbols: the process config minus the per-feed symbol and segment. A
+    // feed that `add_book` fills starts from it. Set before the control thread
+    // starts; its exchange stays empty in a single-book run.
+    Config g_addBookConfig;
+
+    // MEXC allows 30 subscriptions per connection and each feed takes two (depth + deals).
+    std::size_t maxFeedsFor(const Config &cfg)
+    {
+        constexpr std::size_t kMexcMaxFeeds = 15;
+        constexpr std::size_t kBinanceMaxFeeds = 100;
+        return cfg.exchange == "mexc" ? kMexcMaxFeeds : kBinanceMaxFeeds;
+    }
+
+    // Makes a runner's socket reachable from the control thread while it is
+    // open. `wake` is a request the venue answers at once; it makes a quiet
+    // socket's receive() return so queued switches are not left waiting.
+    class StreamSocketScope
+    {
+    public:
+        StreamSocketScope(net::WebSocket *ws, std::string wake) { set(ws, std::move(wake)); }
+        ~StreamSocketScope() { set(nullptr, {}); }
+        StreamSocketScope(const StreamSocketScope &) = delete;
+        StreamSocketScope &operator=(const StreamSocketScope &) = delete;
+
+    private:
+        static void set(net::WebSocket *ws, std::string wake)
+        {
+            std::lock_guard<std::mutex> lock(g_resubscribeMutex);
+            g_streamSocket = ws;
+            g_streamWake = std::move(wake);
+        }
+    };
+
+    // Caller holds g_resubscribeMutex, after queueing a change. With no socket
+    // open the runner takes the change right after it reconnects.
+    void wakeStreamLocked()
+    {
+        if (g_streamSocket)
+        {
+            g_streamSocket->sendText(g_streamWake);
+        }
+    }
+
+    // Stream thread. Takes the switches queued since the last call, oldest first.
+    bool takeResubscribes(std::vector<PendingResubscribe> &out)
+    {
+        out.clear();
+        if (!g_resubscribePending.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(g_resubscribeMutex);
+        out.swap(g_resubscribes);
+        g_resubscribePending.store(false, std::memory_order_relaxed);
+        return !out.empty();
+    }
+
+    // Control thread. `remove_book` needs no fetch; it supersedes any switch of
+    // the feed still in flight and leaves the rest to the stream thread.
+    void queueRemoveBook(std::uint16_t feedId)
+    {
+        // Only a --symbols run has a config to park the feed with.
+        BookFeed *feed = g_addBookConfig.exchange.empty() ? nullptr : feedAt(feedId);
+        if (!feed)
+        {
+            return;
+        }
+        PendingResubscribe req;
+        req.change = PendingResubscribe::Change::Remove;
+        req.feed = feed;
+        std::lock_guard<std::mutex> lock(g_resubscribeMutex);
+        ++g_resubscribeSeq[feedId];
+        g_resubscribes.push_back(std::move(req));
+        g_resubscribePending.store(true, std::memory_order_release);
+        wakeStreamLocked();
+    }
+
+    // Control thread, so slots are handed out in order. `add_book` names an
+    // existing slot or the next one; a new slot starts as an idle feed.
+    void reserveFeedSlot(std::uint16_t id)
+    {
+        std::lock_guard<std::mutex> lock(g_bookMutex);
+        if (!g_addBookConfig.exchange.empty() && id == g_feeds.size() && g_feeds.size() < maxFeedsFor(g_addBookConfig))
+        {
+            addFeed(g_addBookConfig);
+        }
+    }
+
+    // Caller holds g_bookMutex. Stops publishing the feed and drops the
+    // per-ladder state the previous GUI owner set, so a later `add_book`
+    // starts it like a fresh --symbols feed.
+    void parkFeedLocked(BookFeed &feed)
+    {
+        feed.ready.store(false);
+        std::string symbol = std::move(feed.config.symbol);
+        feed.config = g_addBookConfig;
+        feed.config.symbol = std::move(symbol);
+        feed.book.setCacheLevelsPerSide(feed.config.cacheLevelsPerSide);
+        feed.pendingLadder = false;
+        feed.pendingCold = false;
+        feed.haveLastLadder = false;
+        feed.forceFullLadder = true;
+        feed.sentBestBid = 0.0;
+        feed.sentBestAsk = 0.0;
+        feed.hasViewport = false;
+        feed.coldTicks.clear();
+        feed.compression = 1;
+        closeSharedSegment(feed);
+    }
+
+    // Stream thread. Returns the symbol the feed served so the runner can drop
+    // its channels.
+    std::string removeFeed(BookFeed &feed)
+    {
+        std::lock_guard<std::mutex> lock(g_bookMutex);
+        std::cerr << "[backend] book=" << feed.id << " removed (" << feed.config.symbol << ")" << std::endl;
+        parkFeedLocked(feed);
+        return feed.config.symbol;
+    }
+
+    // Stream thread. Loads the new symbol into the feed and returns the old one.
+    // The `resubscribed` line goes out just before the new full ladder, so the
+    // GUI drops the old book at exactly that point of the stream. An added
+    // feed is reset and opens its segment first, and is ready from here on.
+    std::string switchFeedSymbol(PendingResubscribe &req)
+    {
+        BookFeed &feed = *req.feed;
+        std::lock_guard<std::mutex> lock(g_bookMutex);
+        const bool add = req.change == PendingResubscribe::Change::Add;
+        if (add)
+        {
+            parkFeedLocked(feed);
+            if (!req.shmName.empty() && !openSharedSegment(feed, req.shmName))
+            {
+                std::cerr << "[backend] " << req.symbol << ": shared memory unavailable, using stdout" << std::endl;
+            }
+        }
+        std::string previous = std::move(feed.config.symbol);
+        feed.config.symbol = req.symbol;
+        feed.book.setTickSize(req.tickSize);
+        feed.book.loadSnapshot(req.bids, req.asks);
+        feed.book.clearManualCenter();
+        feed.haveLastLadder = false;
+        feed.forceFullLadder = true;
+        json marker;
+        marker["type"] = "resubscribed";
+        marker["book"] = feed.id;
+        marker["symbol"] = req.symbol;
+        marker["tickSize"] = req.tickSize;
+        writeStdoutLine(marker);
+        std::cerr << "[backend] book=" << feed.id << (add ? " added " : " switched " + previous + " -> ")
+                  << req.symbol << " tickSize=" << req.tickSize << std::endl;
+        emitCurrentLadderLocked(feed);
+        feed.ready.store(true);
+        return previous;
+    }
+
+    // After the venue fetchers.
+    void resubscribeFeed(std::uint16_t feedId,
+                         std::string symbol,
+                         std::uint64_t seq,
+                         PendingResubscribe::Change change,
+                         std::string shmName);
+
+    // Runs the `resubscribe` / `add_book` fetches on a few threads started by
+    // the first request. A newer request for a feed replaces its queued one,
+    // so a GUI flicking through symbols queues at most one fetch per feed.
+    // stop() drops the queue and joins the threads before main returns.
+    class FetchWorkers
     {
-        ProtoReader r(data, len);
-        std::string depthBody;
+    public:
+        struct Request
+        {
+            std::uint16_t feedId{0};
+            std::string symbol;
+            std::uint64_t seq{0};
+            PendingResubscribe::Change change{PendingResubscribe::Change::Switch};
+            std::string shmName;
+        };
 
-        while (!r.eof())
+        void post(Request req)
         {
-            std::uint64_t key = 0;
-            if (!r.readVarint(key)) break;
-            const auto field = key >> 3;
-
-            if ((key & 0x7) != 2)
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_)
             {
-                if (!r.skipField(key)) break;
-                continue;
+                return;
             }
-
-            std::string value;
-            if (!r.readLengthDelimited(value)) break;
-
-            if (field == 1)
+            const auto queued = std::find_if(queue_.begin(), queue_.end(), [&](const Request &r) {
+                return r.feedId == req.feedId;
+            });
+            if (queued != queue_.end())
             {
-                channelOut = value;
+                *queued = std::move(req);
             }
-            else if (field == 313)
+            else
+            {
+                queue_.push_back(std::move(req));
+            }
+            while (threads_.size() < kThreads)
             {
-                depthBody = std::move(value);
+                threads_.emplace_back([this] { run(); });
             }
+            cv_.notify_one();
         }
 
-        if (depthBody.empty())
+        // `remove_book`: the feed's queued fetch would only be superseded.
+        void drop(std::uint16_t feedId)
         {
-            return false;
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.erase(std::remove_if(queue_.begin(), queue_.end(), [feedId](const Request &r) {
+                             return r.feedId == feedId;
+                         }),
+                         queue_.end());
         }
 
-        asks.clear();
-        bids.clear();
-        parseAggreDepth(depthBody, tickSize, asks, bids);
-        return true;
-    }
-
-    bool parseDealsFromWrapper(const void* data,
-                               std::size_t len,
-                               std::string& channelOut,
-                               std::vector<PublicAggreDeal>& deals)
-    {
-        ProtoReader r(data, len);
-        std::string dealsBody;
-
-        while (!r.eof())
+        // Fetches in flight finish first (bounded by the REST timeouts).
+        void stop()
         {
-            std::uint64_t key = 0;
-            if (!r.readVarint(key)) break;
-            const auto field = key >> 3;
-
-            if ((key & 0x7) != 2)
-            {
-                if (!r.skipField(key)) break;
-                continue;
-            }
-
-            std::string value;
-            if (!r.readLengthDelimited(value)) break;
-
-            if (field == 1)
+            std::vector<std::thread> threads;
             {
-                channelOut = value;
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+                queue_.clear();
+                threads.swap(threads_);
             }
-            else if (field == 314)
+            cv_.notify_all();
+            for (std::thread &thread : threads)
             {
-                dealsBody = std::move(value);
+                thread.join();
             }
         }
 
-        if (dealsBody.empty())
+    private:
+        // Caps concurrent REST fetches, whatever the GUI sends.
+        static constexpr std::size_t kThreads = 4;
+
+        void run()
         {
-            return false;
+            for (;;)
+            {
+                Request req;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+                    if (stopping_)
+                    {
+                        return;
+                    }
+                    req = std::move(queue_.front());
+                    queue_.pop_front();
+                }
+                resubscribeFeed(req.feedId, std::move(req.symbol), req.seq, req.change, std::move(req.shmName));
+            }
         }
 
-        deals.clear();
-        parseAggreDeals(dealsBody, deals);
-        return !deals.empty();
-    }
-
-    void emitLadder(const Config& config,
-                    const dom::OrderBook& book,
-                    double bestBid,
-                    double bestAsk,
-                    std::int64_t ts);
-
-    std::mutex g_bookMutex;
-    std::atomic<bool> g_bookReady{false};
-    dom::OrderBook* g_bookPtr = nullptr;
-    Config g_activeConfig;
-    std::vector<dom::Level> g_lastLadderLevels;
-    dom::OrderBook::Tick g_lastWindowMinTick = 0;
-    dom::OrderBook::Tick g_lastWindowMaxTick = 0;
-    bool g_haveLastLadder = false;
-    bool g_forceFullLadder = false;
-
-    void emitCurrentLadderLocked()
-    {
-        const double bestBid = g_bookPtr->bestBid();
-        const double bestAsk = g_bookPtr->bestAsk();
-        const auto nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-                               std::chrono::system_clock::now().time_since_epoch())
-                               .count();
-        emitLadder(g_activeConfig, *g_bookPtr, bestBid, bestAsk, nowMs);
-    }
-
-    void emitCurrentLadder()
-    {
-        if (!g_bookReady.load()) return;
-        std::lock_guard<std::mutex> lock(g_bookMutex);
-        if (!g_bookPtr) return;
-        emitCurrentLadderLocked();
-    }
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        std::deque<Request> queue_;
+        std::vector<std::thread> threads_;
+        bool stopping_ = false;
+    };
 
-    void applyShiftAndEmit(dom::OrderBook::Tick delta)
-    {
-        if (!g_bookReady.load()) return;
-        std::lock_guard<std::mutex> lock(g_bookMutex);
-        if (!g_bookPtr) return;
-        g_bookPtr->shiftManualCenterTicks(delta);
-        emitCurrentLadderLocked();
-    }
+    // Never destroyed: the detached control reader may still post at exit.
+    FetchWorkers &g_fetchWorkers = *new FetchWorkers;
 
-    void clearManualCenterAndEmit()
+    // main(): joins the fetch workers before the Qt app and the globals they
+    // use are destroyed, on every return path.
+    class FetchWorkersScope
     {
-        if (!g_bookReady.load()) return;
-        std::lock_guard<std::mutex> lock(g_bookMutex);
-        if (!g_bookPtr) return;
-        g_lastLadderLevels.clear();
-        g_haveLastLadder = false;
-        g_forceFullLadder = true;
-        g_bookPtr->clearManualCenter();
-        emitCurrentLadderLocked();
-    }
+    public:
+        FetchWorkersScope() = default;
+        ~FetchWorkersScope() { g_fetchWorkers.stop(); }
+        FetchWorkersScope(const FetchWorkersScope &) = delete;
+        FetchWorkersScope &operator=(const FetchWorkersScope &) = delete;
+    };
 
     void controlReaderThread()
     {
@@ -2268,18 +2634,73 @@ namespace
             {
                 const auto j = json::parse(line);
                 const std::string cmd = j.value("cmd", std::string());
+                const auto feedId = static_cast<std::uint16_t>(j.value("book", 0));
                 if (cmd == "shift")
                 {
                     const double ticks = j.value("ticks", 0.0);
                     const auto delta = static_cast<dom::OrderBook::Tick>(std::llround(ticks));
                     if (delta != 0)
                     {
-                        applyShiftAndEmit(delta);
+                        applyShiftAndEmit(feedId, delta);
                     }
                 }
                 else if (cmd == "center_auto")
                 {
-                    clearManualCenterAndEmit();
+                    clearManualCenterAndEmit(feedId);
+                }
+                else if (cmd == "set_levels")
+                {
+                    const long long levels = j.value("levels", 0LL);
+                    if (levels > 0)
+                    {
+                        setLadderLevels(feedId, static_cast<std::size_t>(levels));
+                    }
+                }
+                else if (cmd == "set_viewport")
+                {
+                    const auto minTick = j.value("min_tick", dom::OrderBook::Tick{0});
+                    const auto maxTick = j.value("max_tick", dom::OrderBook::Tick{-1});
+                    const auto compression = std::max(dom::OrderBook::Tick{1}, j.value("compression", dom::OrderBook::Tick{1}));
+                    if (minTick <= maxTick)
+                    {
+                        setViewport(feedId, minTick, maxTick, compression);
+                    }
+                }
+                else if (cmd == "set_throttle")
+                {
+                    std::optional<std::chrono::milliseconds> maxStaleness;
+                    if (j.contains("max_staleness_ms"))
+                    {
+                        maxStaleness = std::chrono::milliseconds(std::max(0, j.value("max_staleness_ms", 0)));
+                    }
+                    setLadderThrottle(feedId, std::chrono::milliseconds(std::max(0, j.value("ms", 0))), maxStaleness);
+                }
+                else if (cmd == "resubscribe" || cmd == "add_book")
+                {
+                    const bool add = cmd == "add_book";
+                    if (add)
+                    {
+                        reserveFeedSlot(feedId);
+                    }
+                    std::uint64_t seq = 0;
+                    {
+                        std::lock_guard<std::mutex> lock(g_resubscribeMutex);
+                        seq = ++g_resubscribeSeq[feedId];
+                    }
+                    // The REST fetches can take seconds through a proxy; every
+                    // other command, for every book, goes on meanwhile.
+                    FetchWorkers::Request req;
+                    req.feedId = feedId;
+                    req.symbol = j.value("symbol", std::string());
+                    req.seq = seq;
+                    req.change = add ? PendingResubscribe::Change::Add : PendingResubscribe::Change::Switch;
+                    req.shmName = j.value("shm", std::string());
+                    g_fetchWorkers.post(std::move(req));
+                }
+                else if (cmd == "remove_book")
+                {
+                    g_fetchWorkers.drop(feedId);
+                    queueRemoveBook(feedId);
                 }
             }
             catch (const std::exception& ex)
@@ -2289,20 +2710,202 @@ namespace
         }
     }
 
-    void emitLadder(const Config& config,
-                    const dom::OrderBook& book,
-                    double bestBid,
-                    double bestAsk,
-                    std::int64_t ts)
+    // Caller holds g_bookMutex. Half the tightest throttle or staleness bound
+    // of any feed; `set_throttle` can change both at run time.
+    std::chrono::milliseconds flushPeriodLocked()
+    {
+        auto tightest = std::chrono::milliseconds::max();
+        for (const BookFeed &feed : g_feeds)
+        {
+            tightest = std::min({tightest, feed.config.throttle, stalenessBound(feed.config)});
+        }
+        return std::max<std::chrono::milliseconds>(5ms, tightest / 2);
+    }
+
+    // Sends the coalesced state of feeds that went quiet before their throttle
+    // elapsed, so the last update never waits for the next message. Also logs
+    // the coalescing and stdout writer stats once a minute.
+    void ladderFlushThread()
+    {
+        using clock = std::chrono::steady_clock;
+        std::chrono::milliseconds period;
+        {
+            std::lock_guard<std::mutex> lock(g_bookMutex);
+            if (g_feeds.empty())
+            {
+                return;
+            }
+            period = flushPeriodLocked();
+        }
+        auto lastStats = clock::now();
+        for (;;)
+        {
+            std::this_thread::sleep_for(period);
+            const auto now = clock::now();
+            std::lock_guard<std::mutex> lock(g_bookMutex);
+            for (BookFeed &feed : g_feeds)
+            {
+                if (!feed.ready.load() || !feed.pendingLadder)
+                {
+                    continue;
+                }
+                if (feed.pendingCold ? now - feed.lastColdFlush >= kColdFlushInterval
+                                     : (now - feed.lastEmit >= feed.config.throttle
+                                        || now - feed.pendingSince >= stalenessBound(feed.config)))
+                {
+                    flushLadderLocked(feed, now, true);
+                }
+            }
+            period = flushPeriodLocked();
+            if (now - lastStats < 60s)
+            {
+                continue;
+            }
+            lastStats = now;
+            for (BookFeed &feed : g_feeds)
+            {
+                auto &stats = feed.stats;
+                if (stats.emits == 0)
+                {
+                    continue;
+                }
+                std::cerr << "[backend] ladder stats book=" << feed.id << " symbol=" << feed.config.symbol
+                          << " emits=" << stats.emits << " timerFlushes=" << stats.timerFlushes
+                          << " updatesPerEmit=" << static_cast<double>(stats.coalescedUpdates) / static_cast<double>(stats.emits)
+                          << " maxStalenessMs="
+                          << std::chrono::duration_cast<std::chrono::milliseconds>(stats.maxStaleness).count()
+                          << " boundMs=" << stalenessBound(feed.config).count() << " overBound=" << stats.overBound
+                          << std::endl;
+                stats = BookFeed::LadderStats{};
+            }
+            g_stdout.logStats();
+        }
+    }
+
+    // End of --replay: sends whatever is still coalesced, then reports throughput.
+    void finishReplay()
+    {
+        std::uint64_t emits = 0;
+        {
+            std::lock_guard<std::mutex> lock(g_bookMutex);
+            const auto now = std::chrono::steady_clock::now();
+            for (BookFeed &feed : g_feeds)
+            {
+                if (feed.ready.load() && feed.pendingLadder)
+                {
+                    flushLadderLocked(feed, now, true);
+                }
+                emits += feed.emitCount;
+            }
+        }
+        g_stdout.drain();
+        const net::Replayer::Stats stats = g_replayer->stats();
+        const double seconds = std::chrono::duration<double>(stats.elapsed).count();
+        const auto perSec = [seconds](std::uint64_t n) {
+            return seconds > 0.0 ? static_cast<double>(n) / seconds : 0.0;
+        };
+        std::cerr << "[backend] replay done: messages=" << stats.messages << " bytes=" << stats.bytes
+                  << " seconds=" << seconds << " messagesPerSec=" << perSec(stats.messages)
+                  << " emits=" << emits << " emitsPerSec=" << perSec(emits) << std::endl;
+    }
+
+    // Caller holds g_bookMutex. Splits the top-down `ticks` of a delta: rows
+    // within one viewport height of the GUI's viewport stay, the rest move to
+    // feed.coldTicks. Cold rows that are near the viewport again, and all of
+    // them once kColdFlushInterval has passed, are put back. The GUI keeps the
+    // older value of a held row, so only rows it does not show go stale.
+    void holdColdTicks(BookFeed &feed,
+                       dom::OrderBook::Tick winMin,
+                       dom::OrderBook::Tick winMax,
+                       std::vector<dom::OrderBook::Tick> &ticks)
+    {
+        using Tick = dom::OrderBook::Tick;
+        const Tick margin = feed.viewportMaxTick - feed.viewportMinTick + 1;
+        const Tick hotMin = feed.viewportMinTick - margin;
+        const Tick hotMax = feed.viewportMaxTick + margin;
+        const auto isHot = [&](Tick tick) { return tick >= hotMin && tick <= hotMax; };
+
+        const auto cold = std::stable_partition(ticks.begin(), ticks.end(), isHot);
+        feed.coldTicks.insert(feed.coldTicks.end(), cold, ticks.end());
+        ticks.erase(cold, ticks.end());
+
+        const auto now = std::chrono::steady_clock::now();
+        const bool flushAll = now - feed.lastColdFlush >= kColdFlushInterval || feed.coldTicks.size() > kMaxColdTicks;
+        const std::size_t hotCount = ticks.size();
+        auto keep = feed.coldTicks.begin();
+        for (const Tick tick : feed.coldTicks)
+        {
+            if (tick < winMin || tick > winMax)
+            {
+                continue; // left the window; the GUI has dropped that row
+            }
+            if (flushAll || isHot(tick))
+            {
+                ticks.push_back(tick);
+            }
+            else
+            {
+                *keep++ = tick;
+            }
+        }
+        feed.coldTicks.erase(keep, feed.coldTicks.end());
+        if (flushAll)
+        {
+            feed.lastColdFlush = now;
+        }
+        if (ticks.size() != hotCount)
+        {
+            std::sort(ticks.begin(), ticks.end(), std::greater<Tick>());
+            ticks.erase(std::unique(ticks.begin(), ticks.end()), ticks.end());
+        }
+    }
+
+    void emitLadder(BookFeed &feed, double bestBid, double bestAsk, std::int64_t ts)
     {
+        ++feed.emitCount;
+        const Config &config = feed.config;
+        dom::OrderBook &book = feed.book;
         dom::OrderBook::Tick winMin = 0;
         dom::OrderBook::Tick winMax = 0;
         dom::OrderBook::Tick centerTick = 0;
-        auto levels = book.ladder(config.ladderLevelsPerSide, &winMin, &winMax, &centerTick);
+        // --deep-book widens the window to everything the book caches, so the
+        // GUI scrolls through it without `shift` round-trips. A shared segment
+        // is sized for the ladder window, so shm feeds keep that.
+        const bool deep = config.deepBook && !feed.shmActive;
+        const std::size_t levelsPerSide = (deep && config.ladderLevelsPerSide > 0)
+                                              ? std::max(config.ladderLevelsPerSide, config.cacheLevelsPerSide)
+                                              : config.ladderLevelsPerSide;
+        const bool hasWindow = book.ladderWindow(levelsPerSide, winMin, winMax, centerTick);
         const double tickSize = book.tickSize();
 
+        // Rows that changed since the previous emit, already clipped to the window.
+        thread_local std::vector<dom::OrderBook::Tick> updTicks;
+        const bool changesKnown = book.takeChangedTicks(winMin, winMax, updTicks);
+
+        thread_local std::vector<dom::Level> levels;
+        const dom::wire::LadderHeader header{ts, bestBid, bestAsk, tickSize, winMin, winMax, centerTick};
+        const dom::OrderBook::Tick prevMin = feed.lastWindowMinTick;
+        const dom::OrderBook::Tick prevMax = feed.lastWindowMaxTick;
+        feed.lastWindowMinTick = winMin;
+        feed.lastWindowMaxTick = winMax;
+        if (feed.shmActive)
+        {
+            dom::OrderBook::Tick topRow = winMax;
+            if (hasWindow)
+            {
+                book.compressedLadderRows(feed.compression, winMin, winMax, levels, topRow);
+            }
+            else
+            {
+                levels.clear();
+            }
+            publishSharedLadder(feed, header, levels, topRow, feed.compression);
+            return;
+        }
+
         auto enrich = [&](json &out) {
             out["symbol"] = config.symbol;
+            out["book"] = feed.id;
             out["timestamp"] = ts;
             out["bestBid"] = bestBid;
             out["bestAsk"] = bestAsk;
@@ -2312,384 +2915,436 @@ namespace
             out["centerTick"] = centerTick;
         };
 
-        const bool needFull = !g_haveLastLadder || g_forceFullLadder;
-         if (needFull)
-         {
-             json out;
-             out["type"] = "ladder";
-             json rows = json::array();
-             dom::OrderBook::Tick rowTick = winMax;
-             for (const auto &lvl : levels)
-             {
-                 // `tick` + `tickSize` is enough to reconstruct the price in the GUI.
-                 rows.push_back({{"tick", rowTick},
-                                 {"bid", lvl.bidQuantity},
-                                 {"ask", lvl.askQuantity}});
-                 if (rowTick == std::numeric_limits<dom::OrderBook::Tick>::min()) {
-                     break;
-                 }
-                 --rowTick;
-             }
-             out["rows"] = std::move(rows);
-             enrich(out);
-             std::cout << out.dump() << '\n' << std::flush;
-             g_haveLastLadder = true;
-             g_forceFullLadder = false;
-         }
-        else
+        // A delta is built from the change set plus the rows the window slid
+        // over, so its cost follows the changes, not the window size. Anything
+        // else (first emit, forced, unknown changes, a jump to a disjoint
+        // window) sends the whole window.
+        const bool windowMoved = winMin != prevMin || winMax != prevMax;
+        const bool overlaps = hasWindow && winMin <= prevMax && prevMin <= winMax;
+        const bool needFull = !feed.haveLastLadder || feed.forceFullLadder || !changesKnown
+                              || (windowMoved && !overlaps) || g_stdout.backlogged(feed.id);
+        if (needFull)
         {
-            json updates = json::array();
-            const dom::OrderBook::Tick prevMin = g_lastWindowMinTick;
-            const dom::OrderBook::Tick prevMax = g_lastWindowMaxTick;
-            const auto prevCount = static_cast<std::ptrdiff_t>(g_lastLadderLevels.size());
-            const auto currCount = static_cast<std::ptrdiff_t>(levels.size());
-            auto prevAt = [&](dom::OrderBook::Tick tick) -> const dom::Level * {
-                if (prevCount <= 0) return nullptr;
-                if (tick < prevMin || tick > prevMax) return nullptr;
-                const auto idx = static_cast<std::ptrdiff_t>(prevMax - tick);
-                if (idx < 0 || idx >= prevCount) return nullptr;
-                return &g_lastLadderLevels[static_cast<std::size_t>(idx)];
-            };
-
-            for (std::ptrdiff_t i = 0; i < currCount; ++i)
+            if (hasWindow)
             {
-                const dom::OrderBook::Tick tick = static_cast<dom::OrderBook::Tick>(winMax - i);
-                const auto &lvl = levels[static_cast<std::size_t>(i)];
-                const dom::Level *prev = prevAt(tick);
-                if (!prev
-                    || std::abs(prev->bidQuantity - lvl.bidQuantity) > 1e-9
-                    || std::abs(prev->askQuantity - lvl.askQuantity) > 1e-9)
-                {
-                    updates.push_back({{"tick", tick},
-                                       {"bid", lvl.bidQuantity},
-                                       {"ask", lvl.askQuantity}});
-                }
+                book.ladderRows(winMin, winMax, levels);
             }
-            json removals = json::array();
-            if (prevCount > 0 && (winMin != prevMin || winMax != prevMax))
+            else
             {
-                for (std::ptrdiff_t i = 0; i < prevCount; ++i)
+                levels.clear();
+            }
+            // A deep window is mostly empty ticks: list only the non-empty
+            // rows, the GUI treats every other tick of the window as empty.
+            const bool sparse = deep && hasWindow;
+            const auto emptyRow = [](const dom::Level &lvl) {
+                return lvl.bidQuantity == 0.0 && lvl.askQuantity == 0.0;
+            };
+            if (config.binaryProtocol)
+            {
+                // Dense rows are implicit (windowMax downwards), so only the quantities go on the wire.
+                thread_local std::vector<dom::OrderBook::Tick> tickCol;
+                thread_local std::vector<double> bidCol;
+                thread_local std::vector<double> askCol;
+                tickCol.clear();
+                bidCol.clear();
+                askCol.clear();
+                for (std::size_t i = 0; i < levels.size(); ++i)
                 {
-                    const dom::OrderBook::Tick tick = static_cast<dom::OrderBook::Tick>(prevMax - i);
-                    if (tick < winMin || tick > winMax)
+                    const auto &lvl = levels[i];
+                    if (sparse)
                     {
-                        removals.push_back(tick);
+                        if (emptyRow(lvl))
+                        {
+                            continue;
+                        }
+                        tickCol.push_back(winMax - static_cast<dom::OrderBook::Tick>(i));
                     }
+                    bidCol.push_back(lvl.bidQuantity);
+                    askCol.push_back(lvl.askQuantity);
                 }
+                thread_local dom::wire::FrameWriter writer;
+                writer.begin(sparse ? dom::wire::FrameType::LadderSparse : dom::wire::FrameType::Ladder, feed.id);
+                writer.putHeader(header);
+                writer.put<std::uint32_t>(static_cast<std::uint32_t>(bidCol.size()));
+                writer.putArray(tickCol.data(), tickCol.size());
+                writer.putArray(bidCol.data(), bidCol.size());
+                writer.putArray(askCol.data(), askCol.size());
+                writeStdoutFrame(writer.finish(), StdoutKind::Ladder, feed.id);
             }
-            if (!updates.empty() || !removals.empty()
-                || winMin != g_lastWindowMinTick || winMax != g_lastWindowMaxTick)
+            else
             {
                 json out;
-                out["type"] = "ladder_delta";
-                out["updates"] = std::move(updates);
-                out["removals"] = std::move(removals);
+                out["type"] = "ladder";
+                json rows = json::array();
+                for (std::size_t i = 0; i < levels.size(); ++i)
+                {
+                    const auto &lvl = levels[i];
+                    if (sparse && emptyRow(lvl))
+                    {
+                        continue;
+                    }
+                    // `tick` + `tickSize` is enough to reconstruct the price in the GUI.
+                    rows.push_back({{"tick", winMax - static_cast<dom::OrderBook::Tick>(i)},
+                                    {"bid", lvl.bidQuantity},
+                                    {"ask", lvl.askQuantity}});
+                }
+                out["rows"] = std::move(rows);
+                if (sparse)
+                {
+                    out["sparse"] = true;
+                }
                 enrich(out);
-                std::cout << out.dump() << '\n' << std::flush;
+                writeStdoutLine(out, StdoutKind::Ladder, feed.id);
             }
+            feed.haveLastLadder = true;
+            feed.forceFullLadder = false;
+            feed.sentBestBid = bestBid;
+            feed.sentBestAsk = bestAsk;
+            feed.coldTicks.clear();
+            return;
         }
 
-        g_lastLadderLevels = std::move(levels);
-        g_lastWindowMinTick = winMin;
-        g_lastWindowMaxTick = winMax;
-    }
-
-    bool runWebSocket(const Config& config, dom::OrderBook& book)
-    {
-        WinHttpHandle session = openSession(config);
-        if (!session.valid())
+        if (feed.hasViewport)
         {
-            std::cerr << "[backend] " << winhttpError("WinHttpOpen") << std::endl;
-            return false;
+            holdColdTicks(feed, winMin, winMax, updTicks);
+            // Keep the feed pending so ladderFlushThread sends the held rows
+            // even if the book goes quiet.
+            if (!feed.coldTicks.empty() && !feed.pendingLadder)
+            {
+                feed.pendingLadder = true;
+                feed.pendingCold = true;
+                feed.pendingSince = std::chrono::steady_clock::now();
+            }
         }
 
-        const std::wstring host = L"wbs-api.mexc.com";
-        const std::wstring path = L"/ws";
-
-        WinHttpHandle connection(
-            WinHttpConnect(session.get(), host.c_str(), INTERNET_DEFAULT_HTTPS_PORT, 0));
-        if (!connection.valid())
+        thread_local std::vector<double> updBids;
+        thread_local std::vector<double> updAsks;
+        thread_local std::vector<dom::OrderBook::Tick> removals;
+        updBids.clear();
+        updAsks.clear();
+        removals.clear();
+        if (windowMoved)
         {
-            std::cerr << "[backend] " << winhttpError("WinHttpConnect") << std::endl;
-            return false;
+            // Rows that scrolled into view were never sent; rows that left are
+            // removed. The windows overlap here, so each side is one edge strip.
+            // A deep window stays sparse: the GUI clears the rows a window move
+            // uncovers or drops, so only non-empty entering rows are sent.
+            const auto entering = [&](dom::OrderBook::Tick tick) {
+                if (!deep || book.bidQuantityAt(tick) != 0.0 || book.askQuantityAt(tick) != 0.0)
+                {
+                    updTicks.push_back(tick);
+                }
+            };
+            for (auto tick = winMin; tick < prevMin; ++tick) entering(tick);
+            for (auto tick = prevMax + 1; tick <= winMax; ++tick) entering(tick);
+            if (!deep)
+            {
+                for (auto tick = prevMin; tick < winMin; ++tick) removals.push_back(tick);
+                for (auto tick = winMax + 1; tick <= prevMax; ++tick) removals.push_back(tick);
+            }
+            std::sort(updTicks.begin(), updTicks.end(), std::greater<dom::OrderBook::Tick>());
+            updTicks.erase(std::unique(updTicks.begin(), updTicks.end()), updTicks.end());
         }
-
-        WinHttpHandle request(WinHttpOpenRequest(connection.get(),
-                                                 L"GET",
-                                                 path.c_str(),
-                                                 nullptr,
-                                                 WINHTTP_NO_REFERER,
-                                                 WINHTTP_DEFAULT_ACCEPT_TYPES,
-                                                 WINHTTP_FLAG_SECURE));
-        if (!request.valid())
+        // With every changed row held back, a header-only delta still carries
+        // new best prices (spread display, SL/TP checks in the GUI).
+        if (updTicks.empty() && removals.empty() && !windowMoved && bestBid == feed.sentBestBid
+            && bestAsk == feed.sentBestAsk)
         {
-            std::cerr << "[backend] " << winhttpError("WinHttpOpenRequest") << std::endl;
-            return false;
+            return;
         }
-
-        applyProxyCredentials(config, request.get());
-        if (!WinHttpSetOption(request.get(), WINHTTP_OPTION_UPGRADE_TO_WEB_SOCKET, nullptr, 0))
+        feed.sentBestBid = bestBid;
+        feed.sentBestAsk = bestAsk;
+        for (const auto tick : updTicks)
         {
-            std::cerr << "[backend] " << winhttpError("WinHttpSetOption") << std::endl;
-            return false;
+            updBids.push_back(book.bidQuantityAt(tick));
+            updAsks.push_back(book.askQuantityAt(tick));
         }
 
-        if (!WinHttpSendRequest(request.get(),
-                                WINHTTP_NO_ADDITIONAL_HEADERS,
-                                0,
-                                WINHTTP_NO_REQUEST_DATA,
-                                0,
-                                0,
-                                0))
+        if (config.binaryProtocol)
         {
-            std::cerr << "[backend] " << winhttpError("WinHttpSendRequest") << std::endl;
-            return false;
+            thread_local dom::wire::FrameWriter writer;
+            writer.begin(dom::wire::FrameType::LadderDelta, feed.id);
+            writer.putHeader(header);
+            writer.put<std::uint32_t>(static_cast<std::uint32_t>(updTicks.size()));
+            writer.putArray(updTicks.data(), updTicks.size());
+            writer.putArray(updBids.data(), updBids.size());
+            writer.putArray(updAsks.data(), updAsks.size());
+            writer.put<std::uint32_t>(static_cast<std::uint32_t>(removals.size()));
+            writer.putArray(removals.data(), removals.size());
+            writeStdoutFrame(writer.finish(), StdoutKind::LadderDelta, feed.id);
         }
-
-        if (!WinHttpReceiveResponse(request.get(), nullptr))
+        else
         {
-            std::cerr << "[backend] " << winhttpError("WinHttpReceiveResponse") << std::endl;
-            return false;
+            json updates = json::array();
+            for (std::size_t i = 0; i < updTicks.size(); ++i)
+            {
+                updates.push_back({{"tick", updTicks[i]},
+                                   {"bid", updBids[i]},
+                                   {"ask", updAsks[i]}});
+            }
+            json out;
+            out["type"] = "ladder_delta";
+            out["updates"] = std::move(updates);
+            out["removals"] = removals;
+            enrich(out);
+            writeStdoutLine(out, StdoutKind::LadderDelta, feed.id);
         }
+    }
+
+    // aggre.depth and aggre.deals channels of one MEXC spot symbol.
+    void appendMexcChannels(json &params, const std::string &symbol)
+    {
+        params.push_back("spot@public.aggre.depth.v3.api.pb@100ms@" + symbol);
+        // Aggre deals channel also requires an interval suffix (10ms/100ms); without it
+        // the server replies with "Blocked" and sends no trades.
+        params.push_back("spot@public.aggre.deals.v3.api.pb@100ms@" + symbol);
+    }
 
-        HINTERNET rawSocket = WinHttpWebSocketCompleteUpgrade(request.get(), 0);
-        if (!rawSocket)
+    // MEXC spot: one socket for every feed (a single feed in a normal run).
+    bool runWebSocket(const Config& config, const std::vector<BookFeed*>& feeds)
+    {
+        const auto ws = openWebSocket(config, "wss://wbs-api.mexc.com/ws");
+        if (!ws)
         {
-            std::cerr << "[backend] " << winhttpError("WinHttpWebSocketCompleteUpgrade") << std::endl;
             return false;
         }
-        WinHttpCloseHandle(request.get());
+        const StreamSocketScope socketScope(ws.get(), R"({"method":"PING"})");
 
         std::cerr << "[backend] connected to Mexc ws" << std::endl;
 
+        // Every served feed per symbol: two ladders on one symbol are two feeds
+        // and both get every push. Transparent lookup so PushWrapper::symbol (a
+        // view) needs no temporary string.
+        std::unordered_map<std::string, std::vector<BookFeed *>, TransparentStringHash, std::equal_to<>> feedsBySymbol;
+        // Channels go out once per symbol: all of them in the first SUBSCRIPTION,
+        // then one symbol at a time as feeds switch, arrive or leave.
+        bool subscribed = false;
+        const auto sendChannels = [&](const char *method, const std::string &symbol) {
+            json params = json::array();
+            appendMexcChannels(params, symbol);
+            ws->sendText(json{{"method", method}, {"params", std::move(params)}}.dump());
+        };
+        const auto route = [&](const std::string &symbol, BookFeed *feed) {
+            std::vector<BookFeed *> &routed = feedsBySymbol[symbol];
+            if (std::find(routed.begin(), routed.end(), feed) != routed.end())
+            {
+                return;
+            }
+            routed.push_back(feed);
+            if (routed.size() == 1 && subscribed)
+            {
+                sendChannels("SUBSCRIPTION", symbol);
+            }
+        };
+        const auto unroute = [&](const std::string &symbol, BookFeed *feed) {
+            const auto it = feedsBySymbol.find(symbol);
+            if (it == feedsBySymbol.end())
+            {
+                return;
+            }
+            std::vector<BookFeed *> &routed = it->second;
+            routed.erase(std::remove(routed.begin(), routed.end(), feed), routed.end());
+            if (routed.empty())
+            {
+                feedsBySymbol.erase(it);
+                if (subscribed)
+                {
+                    sendChannels("UNSUBSCRIPTION", symbol);
+                }
+            }
+        };
+
+        // `add_book` / `remove_book` change the served set.
+        std::vector<BookFeed *> served(feeds);
+        for (BookFeed *feed : served)
+        {
+            route(feed->config.symbol, feed);
+        }
+        // A single feed takes every push until it switches symbols; after that
+        // the old symbol's pushes still in flight must be told apart.
+        bool routeBySymbol = served.size() > 1;
+        std::vector<PendingResubscribe> switches;
+        auto applySwitches = [&]() {
+            if (!takeResubscribes(switches))
+            {
+                return;
+            }
+            routeBySymbol = true;
+            for (PendingResubscribe &req : switches)
+            {
+                const auto servedIt = std::find(served.begin(), served.end(), req.feed);
+                const bool wasServed = servedIt != served.end();
+                if (req.change == PendingResubscribe::Change::Remove)
+                {
+                    const std::string previous = removeFeed(*req.feed);
+                    if (wasServed)
+                    {
+                        served.erase(servedIt);
+                        unroute(previous, req.feed);
+                    }
+                    continue;
+                }
+                if (!wasServed)
+                {
+                    if (req.change != PendingResubscribe::Change::Add)
+                    {
+                        continue;
+                    }
+                    served.push_back(req.feed);
+                }
+                const std::string previous = switchFeedSymbol(req);
+                // A feed that was not served has no channels to drop.
+                if (wasServed && previous != req.symbol)
+                {
+                    unroute(previous, req.feed);
+                }
+                route(req.symbol, req.feed);
+            }
+        };
+        // Switches queued while there was no socket go out with the rest.
+        applySwitches();
+
         // Подписка на aggre.depth и aggre.deals
-        std::ostringstream depthChannel;
-        depthChannel << "spot@public.aggre.depth.v3.api.pb@100ms@" << config.symbol;
-        // Aggre deals channel also requires an interval suffix (10ms/100ms); without it
-        // the server replies with "Blocked" and sends no trades.
-        std::ostringstream dealsChannel;
-        dealsChannel << "spot@public.aggre.deals.v3.api.pb@100ms@" << config.symbol;
-        json sub = {{"method", "SUBSCRIPTION"},
-                    {"params", json::array({depthChannel.str(), dealsChannel.str()})}};
+        json params = json::array();
+        for (const auto &entry : feedsBySymbol)
+        {
+            appendMexcChannels(params, entry.first);
+        }
+        json sub = {{"method", "SUBSCRIPTION"}, {"params", std::move(params)}};
         const std::string subStr = sub.dump();
 
-        if (WinHttpWebSocketSend(rawSocket,
-                                 WINHTTP_WEB_SOCKET_UTF8_MESSAGE_BUFFER_TYPE,
-                                 (void*) subStr.data(),
-                                 static_cast<DWORD>(subStr.size())) != S_OK)
+        if (!ws->sendText(subStr))
         {
             std::cerr << "[backend] failed to send SUBSCRIPTION" << std::endl;
-            WinHttpCloseHandle(rawSocket);
             return false;
         }
+        subscribed = true;
 
         std::cerr << "[backend] sent " << subStr << std::endl;
 
-        std::vector<unsigned char> buffer(64 * 1024);
-        auto lastEmit = std::chrono::steady_clock::now();
+        std::string message;
+        net::MessageType type = net::MessageType::Text;
+        PushWrapper push;
+        std::vector<std::pair<dom::OrderBook::Tick, double>> asks;
+        std::vector<std::pair<dom::OrderBook::Tick, double>> bids;
+        std::vector<PublicAggreDeal> deals;
 
-        for (;;)
-        {
-            DWORD received = 0;
-            WINHTTP_WEB_SOCKET_BUFFER_TYPE type;
-            HRESULT hr =
-                WinHttpWebSocketReceive(rawSocket, buffer.data(), static_cast<DWORD>(buffer.size()), &received, &type);
-            if (FAILED(hr))
+        const auto applyPush = [&](BookFeed &feed) {
+            dom::OrderBook& book = feed.book;
+            const double tickSize = book.tickSize();
+            if (tickSize <= 0.0)
             {
-                std::cerr << "[backend] WebSocket receive failed: " << std::hex << hr << std::dec << std::endl;
-                break;
+                return;
             }
 
-            if (type == WINHTTP_WEB_SOCKET_CLOSE_BUFFER_TYPE)
+            if (!push.dealsBody.empty())
             {
-                std::cerr << "[backend] ws closed by server" << std::endl;
-                break;
+                deals.clear();
+                parseAggreDeals(push.dealsBody, deals);
+                for (const auto& d : deals)
+                {
+                    emitTrade(feed, tickSize, d.price, d.quantity, d.buy, d.time);
+                }
+                return;
             }
 
-            if (received == 0)
+            // Depth updates
+            asks.clear();
+            bids.clear();
+            parseAggreDepth(push.depthBody, tickSize, asks, bids);
+            std::lock_guard<std::mutex> lock(g_bookMutex);
+            book.applyDelta(bids, asks, feed.config.cacheLevelsPerSide);
+            bookChangedLocked(feed, std::chrono::steady_clock::now());
+        };
+
+        for (;;)
+        {
+            if (!ws->receive(message, type))
             {
-                continue;
+                std::cerr << "[backend] Mexc ws: " << ws->error() << std::endl;
+                break;
             }
+            applySwitches();
 
-            if (type == WINHTTP_WEB_SOCKET_UTF8_MESSAGE_BUFFER_TYPE ||
-                type == WINHTTP_WEB_SOCKET_UTF8_FRAGMENT_BUFFER_TYPE)
+            if (type == net::MessageType::Text)
             {
-                std::string text(reinterpret_cast<char*>(buffer.data()), received);
                 // PING / служебные сообщения
                 try
                 {
-                    auto j = json::parse(text);
+                    auto j = json::parse(message);
                     const auto methodIt = j.find("method");
                     if (methodIt != j.end() && methodIt->is_string() && *methodIt == "PING")
                     {
-                        const std::string pong = R"({"method":"PONG"})";
-                        WinHttpWebSocketSend(rawSocket,
-                                             WINHTTP_WEB_SOCKET_UTF8_MESSAGE_BUFFER_TYPE,
-                                             (void*) pong.data(),
-                                             static_cast<DWORD>(pong.size()));
+                        ws->sendText(R"({"method":"PONG"})");
                     }
                     else
                     {
-                        std::cerr << "[backend] control: " << text << std::endl;
+                        std::cerr << "[backend] control: " << message << std::endl;
                     }
                 }
                 catch (...)
                 {
-                    std::cerr << "[backend] text frame: " << text << std::endl;
+                    std::cerr << "[backend] text frame: " << message << std::endl;
                 }
                 continue;
             }
 
-            if (type == WINHTTP_WEB_SOCKET_BINARY_MESSAGE_BUFFER_TYPE ||
-                type == WINHTTP_WEB_SOCKET_BINARY_FRAGMENT_BUFFER_TYPE)
+            try
             {
-                try
+                if (!parsePushWrapper(message.data(), message.size(), push))
                 {
-                    const double tickSize = book.tickSize();
-                    if (tickSize <= 0.0)
-                    {
-                        continue;
-                    }
-
-                    std::string channelName;
-                    std::vector<std::pair<dom::OrderBook::Tick, double>> asks;
-                    std::vector<std::pair<dom::OrderBook::Tick, double>> bids;
-                    std::vector<PublicAggreDeal> deals;
-
-                    // Try trades first
-                    if (parseDealsFromWrapper(buffer.data(), received, channelName, deals))
-                    {
-                        for (const auto& d : deals)
-                        {
-                            json t;
-                            t["type"] = "trade";
-                            t["symbol"] = config.symbol;
-                            dom::OrderBook::Tick tick = 0;
-                            double snappedPrice = d.price;
-                            if (quantizeTickFromPrice(d.price, tickSize, tick, snappedPrice))
-                            {
-                                t["tick"] = tick;
-                                t["price"] = snappedPrice;
-                            }
-                            else
-                            {
-                                t["price"] = d.price;
-                            }
-                            t["qty"] = d.quantity;
-                            t["side"] = d.buy ? "buy" : "sell";
-                            t["timestamp"] = d.time;
-                            std::cout << t.dump() << '\n' << std::flush;
-                        }
-                        continue;
-                    }
-
-                    // Depth updates
-                    if (parsePushWrapper(buffer.data(), received, channelName, tickSize, asks, bids))
-                    {
-                        const auto now = std::chrono::steady_clock::now();
-                        std::lock_guard<std::mutex> lock(g_bookMutex);
-                        book.applyDelta(bids, asks, config.cacheLevelsPerSide);
-                        if (now - lastEmit >= config.throttle)
-                        {
-                            lastEmit = now;
-                            const auto nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-                                                   std::chrono::system_clock::now().time_since_epoch())
-                                                   .count();
-                            emitLadder(config, book, book.bestBid(), book.bestAsk(), nowMs);
-                        }
-                    }
+                    continue;
                 }
-                catch (const std::exception& ex)
+                if (!routeBySymbol)
                 {
-                    std::cerr << "[backend] decode/apply error: " << ex.what() << std::endl;
+                    applyPush(*served.front());
+                    continue;
+                }
+                const auto it = feedsBySymbol.find(push.symbol);
+                if (it == feedsBySymbol.end())
+                {
+                    continue;
                 }
+                for (BookFeed *feed : it->second)
+                {
+                    applyPush(*feed);
+                }
+            }
+            catch (const std::exception& ex)
+            {
+                std::cerr << "[backend] decode/apply error: " << ex.what() << std::endl;
             }
         }
 
-        WinHttpCloseHandle(rawSocket);
+        ws->close();
         return true;
     }
 
-    bool runMexcFuturesWebSocket(const Config &config, dom::OrderBook &book)
+    bool runMexcFuturesWebSocket(BookFeed &feed)
     {
-        WinHttpHandle session = openSession(config);
-        if (!session.valid())
-        {
-            std::cerr << "[backend] " << winhttpError("WinHttpOpen") << std::endl;
-            return false;
-        }
-
-        const std::wstring host = L"contract.mexc.com";
-        const std::wstring path = L"/edge";
-        std::vector<unsigned char> buffer(128 * 1024);
+        const Config &config = feed.config;
+        dom::OrderBook &book = feed.book;
+        std::string text;
+        net::MessageType type = net::MessageType::Text;
 
         for (;;)
         {
-            WinHttpHandle connection(
-                WinHttpConnect(session.get(), host.c_str(), INTERNET_DEFAULT_HTTPS_PORT, 0));
-            if (!connection.valid())
-            {
-                std::cerr << "[backend] " << winhttpError("WinHttpConnect") << std::endl;
-                std::this_thread::sleep_for(1000ms);
-                continue;
-            }
-
-            WinHttpHandle request(WinHttpOpenRequest(connection.get(),
-                                                     L"GET",
-                                                     path.c_str(),
-                                                     nullptr,
-                                                     WINHTTP_NO_REFERER,
-                                                     WINHTTP_DEFAULT_ACCEPT_TYPES,
-                                                     WINHTTP_FLAG_SECURE));
-            if (!request.valid())
-            {
-                std::cerr << "[backend] " << winhttpError("WinHttpOpenRequest") << std::endl;
-                std::this_thread::sleep_for(1000ms);
-                continue;
-            }
-            applyProxyCredentials(config, request.get());
-            if (!WinHttpSetOption(request.get(), WINHTTP_OPTION_UPGRADE_TO_WEB_SOCKET, nullptr, 0))
-            {
-                std::cerr << "[backend] " << winhttpError("WinHttpSetOption") << std::endl;
-                std::this_thread::sleep_for(1000ms);
-                continue;
-            }
-            if (!WinHttpSendRequest(request.get(),
-                                    WINHTTP_NO_ADDITIONAL_HEADERS,
-                                    0,
-                                    WINHTTP_NO_REQUEST_DATA,
-                                    0,
-                                    0,
-                                    0))
-            {
-                std::cerr << "[backend] " << winhttpError("WinHttpSendRequest") << std::endl;
-                std::this_thread::sleep_for(1000ms);
-                continue;
-            }
-            if (!WinHttpReceiveResponse(request.get(), nullptr))
-            {
-                std::cerr << "[backend] " << winhttpError("WinHttpReceiveResponse") << std::endl;
-                std::this_thread::sleep_for(1000ms);
-                continue;
-            }
-
-            HINTERNET rawSocket = WinHttpWebSocketCompleteUpgrade(request.get(), 0);
-            if (!rawSocket)
+            const auto ws = openWebSocket(config, "wss://contract.mexc.com/edge");
+            if (!ws)
             {
-                std::cerr << "[backend] " << winhttpError("WinHttpWebSocketCompleteUpgrade") << std::endl;
+                if (g_replayer)
+                {
+                    break; // recording exhausted
+                }
                 std::this_thread::sleep_for(1000ms);
                 continue;
             }
-            WinHttpCloseHandle(request.get());
 
             std::mutex sendMutex;
             auto sendJson = [&](const json &msg) -> bool {
                 const std::string payload = msg.dump();
                 std::lock_guard<std::mutex> lock(sendMutex);
-                return WinHttpWebSocketSend(rawSocket,
-                                            WINHTTP_WEB_SOCKET_UTF8_MESSAGE_BUFFER_TYPE,
-                                            (void*)payload.data(),
-                                            static_cast<DWORD>(payload.size())) == S_OK;
+                return ws->sendText(payload);
             };
 
             const int depthLimit = std::max(50, static_cast<int>(config.ladderLevelsPerSide));
@@ -2700,17 +3355,20 @@ namespace
             sendJson(depthSub);
             sendJson(dealSub);
 
-            std::atomic<bool> running{true};
+            // Waits on a condition variable so a reconnect (or the end of a
+            // replay) does not sit out the rest of the 45 s keepalive period.
+            std::mutex pingMutex;
+            std::condition_variable pingWake;
+            bool running = true;
             std::thread pingThread([&]() {
-                while (running.load())
+                std::unique_lock<std::mutex> lock(pingMutex);
+                while (!pingWake.wait_for(lock, 45s, [&]() { return !running; }))
                 {
-                    std::this_thread::sleep_for(45s);
-                    if (!running.load())
-                    {
-                        break;
-                    }
+                    lock.unlock();
                     json ping = {{"method","ping"}};
-                    if (!sendJson(ping))
+                    const bool sent = sendJson(ping);
+                    lock.lock();
+                    if (!sent)
                     {
                         // Socket likely closed; receiver loop will reconnect.
                         break;
@@ -2718,65 +3376,21 @@ namespace
                 }
             });
 
-            auto lastEmit = std::chrono::steady_clock::now();
             bool shouldReconnect = false;
-            std::string textBuffer;
-            textBuffer.reserve(64 * 1024);
 
             while (true)
             {
-                DWORD received = 0;
-                WINHTTP_WEB_SOCKET_BUFFER_TYPE type;
-                HRESULT hr = WinHttpWebSocketReceive(rawSocket,
-                                                     buffer.data(),
-                                                     static_cast<DWORD>(buffer.size()),
-                                                     &received,
-                                                     &type);
-                if (FAILED(hr))
+                if (!ws->receive(text, type))
                 {
-                    std::cerr << "[backend] futures WS receive failed: 0x" << std::hex << hr << std::dec << std::endl;
+                    std::cerr << "[backend] futures WS: " << ws->error() << std::endl;
                     shouldReconnect = true;
                     break;
                 }
-                if (type == WINHTTP_WEB_SOCKET_CLOSE_BUFFER_TYPE)
-                {
-                    std::cerr << "[backend] futures WS closed by server" << std::endl;
-                    shouldReconnect = true;
-                    break;
-                }
-                if (received == 0)
-                {
-                    continue;
-                }
-                if (type != WINHTTP_WEB_SOCKET_UTF8_MESSAGE_BUFFER_TYPE &&
-                    type != WINHTTP_WEB_SOCKET_UTF8_FRAGMENT_BUFFER_TYPE)
-                {
-                    continue;
-                }
-
-                // WinHTTP may deliver JSON frames split into fragments; assemble before parsing.
-                if (type == WINHTTP_WEB_SOCKET_UTF8_FRAGMENT_BUFFER_TYPE)
+                if (type != net::MessageType::Text)
                 {
-                    textBuffer.append(reinterpret_cast<const char*>(buffer.data()), received);
-                    if (textBuffer.size() > 1024 * 1024)
-                    {
-                        std::cerr << "[backend] futures WS fragment buffer too large, dropping\n";
-                        textBuffer.clear();
-                    }
                     continue;
                 }
 
-                std::string text;
-                if (!textBuffer.empty())
-                {
-                    textBuffer.append(reinterpret_cast<const char*>(buffer.data()), received);
-                    text.swap(textBuffer);
-                    textBuffer.clear();
-                }
-                else
-                {
-                    text.assign(reinterpret_cast<const char*>(buffer.data()), received);
-                }
                 json message;
                 try
                 {
@@ -2861,15 +3475,7 @@ namespace
                     {
                         std::lock_guard<std::mutex> lock(g_bookMutex);
                         book.applyDelta(bids, asks, config.cacheLevelsPerSide);
-                        const auto now = std::chrono::steady_clock::now();
-                        if (now - lastEmit >= config.throttle)
-                        {
-                            lastEmit = now;
-                            const auto nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-                                                   std::chrono::system_clock::now().time_since_epoch())
-                                                   .count();
-                            emitLadder(config, book, book.bestBid(), book.bestAsk(), nowMs);
-                        }
+                        bookChangedLocked(feed, std::chrono::steady_clock::now());
                     }
                     continue;
                 }
@@ -2891,36 +3497,23 @@ namespace
                             continue;
                         }
                         qty *= contractSize;
-                        json t;
-                        t["type"] = "trade";
-                        t["symbol"] = config.symbol;
-                        dom::OrderBook::Tick tick = 0;
-                        double snappedPrice = price;
-                        if (quantizeTickFromPrice(price, tickSize, tick, snappedPrice))
-                        {
-                            t["tick"] = tick;
-                            t["price"] = snappedPrice;
-                        }
-                        else
-                        {
-                            t["price"] = price;
-                        }
-                        t["qty"] = qty;
                         const int sideCode = d.value("T", 1);
-                        t["side"] = (sideCode == 2) ? "sell" : "buy";
-                        t["timestamp"] = d.value("t", 0);
-                        std::cout << t.dump() << '\n' << std::flush;
+                        emitTrade(feed, tickSize, price, qty, sideCode != 2, d.value("t", std::int64_t{0}));
                     }
                     continue;
                 }
             }
 
-            running.store(false);
+            {
+                std::lock_guard<std::mutex> lock(pingMutex);
+                running = false;
+            }
+            pingWake.notify_all();
             if (pingThread.joinable())
             {
                 pingThread.join();
             }
-            WinHttpCloseHandle(rawSocket);
+            ws->close();
 
             if (!shouldReconnect)
             {
@@ -3177,10 +3770,8 @@ bool fetchBinanceSnapshotSpot(const Config &cfg, double tickSize, BinanceDepthSn
         for (const auto &e : arr)
         {
             if (!e.is_array() || e.size() < 2) continue;
-            const double price = jsonToDouble(e[0]);
-            const double qty = jsonToDouble(e[1]);
-            const auto tick = tickFromPrice(price, tickSize);
-            out.emplace_back(tick, qty);
+            const auto tick = tickFromPriceJson(e[0], tickSize);
+            out.emplace_back(tick, jsonToDouble(e[1]));
         }
     };
 
@@ -3234,10 +3825,8 @@ bool fetchBinanceSnapshotFutures(const Config &cfg, double tickSize, BinanceDept
         for (const auto &e : arr)
         {
             if (!e.is_array() || e.size() < 2) continue;
-            const double price = jsonToDouble(e[0]);
-            const double qty = jsonToDouble(e[1]);
-            const auto tick = tickFromPrice(price, tickSize);
-            out.emplace_back(tick, qty);
+            const auto tick = tickFromPriceJson(e[0], tickSize);
+            out.emplace_back(tick, jsonToDouble(e[1]));
         }
     };
 
@@ -3250,200 +3839,444 @@ bool fetchBinanceSnapshotFutures(const Config &cfg, double tickSize, BinanceDept
     return out.lastUpdateId > 0;
 }
 
-bool runBinanceWebSocket(const Config &config, dom::OrderBook &book, bool futures, long long snapshotLastUpdateId)
+// Depth sync state for one Binance feed (diff stream vs REST snapshot ids).
+// Diff-depth and trade streams of one (normalized) Binance symbol.
+json binanceStreams(const std::string &symbolUpper)
+{
+    std::string symbolLower = symbolUpper;
+    std::transform(symbolLower.begin(), symbolLower.end(), symbolLower.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    return json::array({symbolLower + "@depth@100ms", symbolLower + "@aggTrade"});
+}
+
+namespace
 {
-    WinHttpHandle session = openSession(config);
-    if (!session.valid())
+    // FetchWorkers thread, for one `resubscribe` or `add_book`. A failed add
+    // is reported as `resubscribe_failed` too.
+    void resubscribeFeed(std::uint16_t feedId,
+                         std::string symbol,
+                         std::uint64_t seq,
+                         PendingResubscribe::Change change,
+                         std::string shmName)
     {
-        std::cerr << "[backend] " << winhttpError("WinHttpOpen") << std::endl;
-        return false;
-    }
+        const bool add = change == PendingResubscribe::Change::Add;
+        const char *what = add ? "add_book" : "resubscribe";
+        const auto fail = [&](const char *reason) {
+            std::cerr << "[backend] " << what << " book=" << feedId << " to " << symbol << " failed: " << reason
+                      << std::endl;
+            json msg;
+            msg["type"] = "resubscribe_failed";
+            msg["book"] = feedId;
+            msg["symbol"] = symbol;
+            msg["error"] = reason;
+            writeStdoutLine(msg);
+        };
+        // An added feed is idle, so it is not ready yet.
+        BookFeed *feed = add ? feedAt(feedId) : readyFeed(feedId);
+        if (!feed || symbol.empty())
+        {
+            if (add)
+            {
+                fail(feed ? "no symbol" : "no free book slot");
+            }
+            return;
+        }
+        Config cfg;
+        {
+            std::lock_guard<std::mutex> lock(g_bookMutex);
+            cfg = add ? g_addBookConfig : feed->config;
+        }
+        const bool mexcSpot = cfg.exchange == "mexc";
+        const bool futures = isBinanceFutures(cfg);
+        if (!mexcSpot && !futures && !isBinanceSpot(cfg))
+        {
+            fail("not supported for this exchange");
+            return;
+        }
+        if (g_replayer)
+        {
+            fail("not available during --replay");
+            return;
+        }
+        cfg.symbol = symbol;
 
-    const std::wstring host = futures ? L"fstream.binance.com" : L"stream.binance.com";
-    const INTERNET_PORT port = futures ? INTERNET_DEFAULT_HTTPS_PORT : 9443;
-    const std::wstring path = L"/ws";
+        PendingResubscribe req;
+        req.change = change;
+        req.feed = feed;
+        req.symbol = symbol;
+        req.shmName = std::move(shmName);
+        if (mexcSpot)
+        {
+            if (!fetchExchangeInfo(cfg, req.tickSize))
+            {
+                fail("failed to determine tick size");
+                return;
+            }
+            if (!fetchSnapshotRows(cfg, req.tickSize, req.bids, req.asks))
+            {
+                std::cerr << "[backend] " << symbol << ": snapshot failed, continuing with empty book" << std::endl;
+            }
+        }
+        else
+        {
+            const bool tickOk = futures ? fetchBinanceExchangeInfoFutures(cfg, req.tickSize)
+                                        : fetchBinanceExchangeInfoSpot(cfg, req.tickSize);
+            if (!tickOk)
+            {
+                fail("failed to determine tick size");
+                return;
+            }
+            BinanceDepthSnapshot snap;
+            const bool snapshotOk = futures ? fetchBinanceSnapshotFutures(cfg, req.tickSize, snap)
+                                            : fetchBinanceSnapshotSpot(cfg, req.tickSize, snap);
+            if (snapshotOk)
+            {
+                req.bids = std::move(snap.bids);
+                req.asks = std::move(snap.asks);
+                req.lastUpdateId = snap.lastUpdateId;
+            }
+            else
+            {
+                std::cerr << "[backend] " << symbol << ": snapshot failed, continuing with empty book" << std::endl;
+            }
+        }
 
-    const std::string symbolLower = [&]() {
-        std::string s = normalizeBinanceSymbol(config.symbol);
-        std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) {
-            return static_cast<char>(std::tolower(c));
-        });
-        return s;
-    }();
+        std::lock_guard<std::mutex> lock(g_resubscribeMutex);
+        if (g_resubscribeSeq[feedId] != seq)
+        {
+            // The GUI has asked for another symbol, or dropped the book, since;
+            // it ignores this one.
+            std::cerr << "[backend] " << what << " book=" << feedId << " to " << symbol << " superseded" << std::endl;
+            return;
+        }
+        g_resubscribes.push_back(std::move(req));
+        g_resubscribePending.store(true, std::memory_order_release);
+        // The stream thread subscribes the symbol, unless another of its
+        // feeds already has it, and drops the old one once it has switched.
+        wakeStreamLocked();
+    }
+} // namespace
 
-    auto lastUpdateId = snapshotLastUpdateId;
-    bool synced = false;
-    auto lastResyncAttempt = std::chrono::steady_clock::now() - std::chrono::seconds(10);
+struct BinanceFeedSync
+{
+    BookFeed *feed{nullptr};
+    long long lastUpdateId{0};
+    bool synced{false};
+    std::chrono::steady_clock::time_point lastResyncAttempt{};
+};
+
+// Binance spot/futures: one socket for every feed; events are routed by their "s" symbol.
+bool runBinanceWebSocket(const Config &config,
+                         const std::vector<BookFeed *> &feeds,
+                         bool futures,
+                         const std::vector<long long> &snapshotLastUpdateIds)
+{
+    const char *venueUrl = futures ? "wss://fstream.binance.com/ws" : "wss://stream.binance.com:9443/ws";
+
+    // A deque so syncsBySymbol survives `add_book` appending; `remove_book`
+    // clears a slot's feed and a later add reuses it.
+    std::deque<BinanceFeedSync> syncs(feeds.size());
+    // Every served feed per symbol: two ladders on one symbol are two feeds,
+    // each with its own diff sync, and both get every event.
+    std::unordered_map<std::string, std::vector<BinanceFeedSync *>> syncsBySymbol;
+    // Streams go out once per symbol: all of them in the SUBSCRIBE after each
+    // connect, then one symbol at a time as feeds switch, arrive or leave.
+    net::WebSocket *subscribedSocket = nullptr;
+    const auto route = [&](const std::string &symbol, BinanceFeedSync *sync) {
+        std::vector<BinanceFeedSync *> &routed = syncsBySymbol[symbol];
+        if (std::find(routed.begin(), routed.end(), sync) != routed.end())
+        {
+            return;
+        }
+        routed.push_back(sync);
+        if (routed.size() == 1 && subscribedSocket)
+        {
+            json sub = {{"method", "SUBSCRIBE"}, {"params", binanceStreams(symbol)}, {"id", 2}};
+            subscribedSocket->sendText(sub.dump());
+        }
+    };
+    const auto unroute = [&](const std::string &symbol, BinanceFeedSync *sync) {
+        const auto it = syncsBySymbol.find(symbol);
+        if (it == syncsBySymbol.end())
+        {
+            return;
+        }
+        std::vector<BinanceFeedSync *> &routed = it->second;
+        routed.erase(std::remove(routed.begin(), routed.end(), sync), routed.end());
+        if (routed.empty())
+        {
+            syncsBySymbol.erase(it);
+            if (subscribedSocket)
+            {
+                json unsub = {{"method", "UNSUBSCRIBE"}, {"params", binanceStreams(symbol)}, {"id", 3}};
+                subscribedSocket->sendText(unsub.dump());
+            }
+        }
+    };
+    for (std::size_t i = 0; i < feeds.size(); ++i)
+    {
+        BinanceFeedSync &sync = syncs[i];
+        sync.feed = feeds[i];
+        sync.lastUpdateId = i < snapshotLastUpdateIds.size() ? snapshotLastUpdateIds[i] : 0;
+        sync.lastResyncAttempt = std::chrono::steady_clock::now() - std::chrono::seconds(10);
+        route(normalizeBinanceSymbol(sync.feed->config.symbol), &sync);
+    }
+    // A single feed takes every event until it switches symbols; after that
+    // the old symbol's events still in flight must be told apart.
+    bool routeBySymbol = syncs.size() > 1;
+    std::vector<PendingResubscribe> switches;
+    auto applySwitches = [&]() {
+        if (!takeResubscribes(switches))
+        {
+            return;
+        }
+        routeBySymbol = true;
+        for (PendingResubscribe &req : switches)
+        {
+            auto syncIt = std::find_if(syncs.begin(), syncs.end(), [&](const BinanceFeedSync &s) {
+                return s.feed == req.feed;
+            });
+            const bool wasServed = syncIt != syncs.end();
+            if (req.change == PendingResubscribe::Change::Remove)
+            {
+                const std::string previous = normalizeBinanceSymbol(removeFeed(*req.feed));
+                if (wasServed)
+                {
+                    syncIt->feed = nullptr;
+                    unroute(previous, &*syncIt);
+                }
+                continue;
+            }
+            if (!wasServed)
+            {
+                if (req.change != PendingResubscribe::Change::Add)
+                {
+                    continue;
+                }
+                syncIt = std::find_if(syncs.begin(), syncs.end(), [](const BinanceFeedSync &s) {
+                    return s.feed == nullptr;
+                });
+                if (syncIt == syncs.end())
+                {
+                    syncIt = syncs.emplace(syncs.end());
+                }
+                syncIt->feed = req.feed;
+                syncIt->lastResyncAttempt = std::chrono::steady_clock::now() - std::chrono::seconds(10);
+            }
+            const std::string previous = normalizeBinanceSymbol(switchFeedSymbol(req));
+            syncIt->lastUpdateId = req.lastUpdateId;
+            syncIt->synced = false;
+            const std::string current = normalizeBinanceSymbol(req.symbol);
+            // A feed that was not served has no streams to drop.
+            if (wasServed && previous != current)
+            {
+                unroute(previous, &*syncIt);
+            }
+            route(current, &*syncIt);
+        }
+    };
 
-    auto resyncSnapshot = [&]() -> bool {
+    auto resyncSnapshot = [&](BinanceFeedSync &sync) -> bool {
         const auto now = std::chrono::steady_clock::now();
-        if (now - lastResyncAttempt < std::chrono::seconds(1))
+        if (now - sync.lastResyncAttempt < std::chrono::seconds(1))
+        {
+            return false;
+        }
+        sync.lastResyncAttempt = now;
+
+        BookFeed &feed = *sync.feed;
+        BinanceDepthSnapshot snap;
+        const double tickSize = feed.book.tickSize();
+        const bool ok =
+            futures ? fetchBinanceSnapshotFutures(feed.config, tickSize, snap)
+                    : fetchBinanceSnapshotSpot(feed.config, tickSize, snap);
+        if (!ok)
         {
+            std::cerr << "[backend] binance resync snapshot failed (" << feed.config.symbol << ")" << std::endl;
             return false;
         }
-        lastResyncAttempt = now;
 
-        BinanceDepthSnapshot snap;
-        const double tickSize = book.tickSize();
-        const bool ok =
-            futures ? fetchBinanceSnapshotFutures(config, tickSize, snap)
-                    : fetchBinanceSnapshotSpot(config, tickSize, snap);
-        if (!ok)
-        {
-            std::cerr << "[backend] binance resync snapshot failed" << std::endl;
-            return false;
+        {
+            std::lock_guard<std::mutex> lock(g_bookMutex);
+            feed.book.loadSnapshot(snap.bids, snap.asks);
+        }
+        sync.lastUpdateId = snap.lastUpdateId;
+        sync.synced = false;
+        std::cerr << "[backend] binance resynced " << feed.config.symbol
+                  << ": lastUpdateId=" << sync.lastUpdateId << std::endl;
+        return true;
+    };
+
+    // Depth diffs are checked against each sync's own lastUpdateId, so two
+    // feeds on one symbol stay consistent even if only one of them resyncs.
+    const auto applyEvent = [&](BinanceFeedSync &sync, const json &j, const std::string &event) {
+        BookFeed &feed = *sync.feed;
+        dom::OrderBook &book = feed.book;
+        long long &lastUpdateId = sync.lastUpdateId;
+        bool &synced = sync.synced;
+
+        if (event == "depthUpdate")
+        {
+            const double tickSize = book.tickSize();
+            if (tickSize <= 0.0)
+            {
+                return;
+            }
+
+            const long long U = j.value("U", 0LL);
+            const long long u = j.value("u", 0LL);
+            if (lastUpdateId > 0 && (U <= 0 || u <= 0))
+            {
+                return;
+            }
+
+            if (lastUpdateId > 0 && !synced)
+            {
+                // Drop events that are completely before our snapshot.
+                if (u <= lastUpdateId)
+                {
+                    return;
+                }
+                // First applied event must satisfy: U <= lastUpdateId+1 <= u
+                if (!(U <= lastUpdateId + 1 && u >= lastUpdateId + 1))
+                {
+                    resyncSnapshot(sync);
+                    return;
+                }
+                synced = true;
+            }
+            else if (lastUpdateId > 0 && synced)
+            {
+                if (futures)
+                {
+                    const long long pu = j.value("pu", 0LL);
+                    if (pu != lastUpdateId)
+                    {
+                        resyncSnapshot(sync);
+                        return;
+                    }
+                }
+                else
+                {
+                    if (U != lastUpdateId + 1)
+                    {
+                        // Missed updates; force snapshot resync.
+                        resyncSnapshot(sync);
+                        return;
+                    }
+                }
+            }
+
+            std::vector<std::pair<dom::OrderBook::Tick, double>> bids;
+            std::vector<std::pair<dom::OrderBook::Tick, double>> asks;
+            auto parseSide = [tickSize](const json &arr,
+                                        std::vector<std::pair<dom::OrderBook::Tick, double>> &out) {
+                out.clear();
+                if (!arr.is_array())
+                {
+                    return;
+                }
+                out.reserve(arr.size());
+                for (const auto &e : arr)
+                {
+                    if (!e.is_array() || e.size() < 2) continue;
+                    const auto tick = tickFromPriceJson(e[0], tickSize);
+                    out.emplace_back(tick, jsonToDouble(e[1]));
+                }
+            };
+            parseSide(j.value("b", json::array()), bids);
+            parseSide(j.value("a", json::array()), asks);
+
+            std::lock_guard<std::mutex> lock(g_bookMutex);
+            book.applyDelta(bids, asks, feed.config.cacheLevelsPerSide);
+            if (lastUpdateId > 0 && u > 0)
+            {
+                lastUpdateId = u;
+            }
+            bookChangedLocked(feed, std::chrono::steady_clock::now());
         }
-
+        else if (event == "aggTrade")
         {
-            std::lock_guard<std::mutex> lock(g_bookMutex);
-            book.loadSnapshot(snap.bids, snap.asks);
+            const double tickSize = book.tickSize();
+            if (tickSize <= 0.0)
+            {
+                return;
+            }
+            const double price = jsonToDouble(j.value("p", json(0.0)));
+            const double qty = jsonToDouble(j.value("q", json(0.0)));
+            const bool buyerIsMaker = j.value("m", false);
+            const bool buy = !buyerIsMaker;
+            const auto ts = j.value("T", j.value("E", 0LL));
+            emitTrade(feed, tickSize, price, qty, buy, ts);
         }
-        lastUpdateId = snap.lastUpdateId;
-        synced = false;
-        std::cerr << "[backend] binance resynced: lastUpdateId=" << lastUpdateId << std::endl;
-        return true;
     };
 
     for (;;)
     {
-        WinHttpHandle connection(
-            WinHttpConnect(session.get(), host.c_str(), port, 0));
-        if (!connection.valid())
-        {
-            std::cerr << "[backend] " << winhttpError("WinHttpConnect") << std::endl;
-            return false;
-        }
-
-        WinHttpHandle request(WinHttpOpenRequest(connection.get(),
-                                                 L"GET",
-                                                 path.c_str(),
-                                                 nullptr,
-                                                 WINHTTP_NO_REFERER,
-                                                 WINHTTP_DEFAULT_ACCEPT_TYPES,
-                                                 WINHTTP_FLAG_SECURE));
-        if (!request.valid())
-        {
-            std::cerr << "[backend] " << winhttpError("WinHttpOpenRequest") << std::endl;
-            return false;
-        }
-
-        applyProxyCredentials(config, request.get());
-        if (!WinHttpSetOption(request.get(), WINHTTP_OPTION_UPGRADE_TO_WEB_SOCKET, nullptr, 0))
+        const auto ws = openWebSocket(config, venueUrl);
+        if (!ws)
         {
-            std::cerr << "[backend] " << winhttpError("WinHttpSetOption") << std::endl;
             return false;
         }
 
-        if (!WinHttpSendRequest(request.get(),
-                                WINHTTP_NO_ADDITIONAL_HEADERS,
-                                0,
-                                WINHTTP_NO_REQUEST_DATA,
-                                0,
-                                0,
-                                0))
-        {
-            std::cerr << "[backend] " << winhttpError("WinHttpSendRequest") << std::endl;
-            return false;
-        }
+        // LIST_SUBSCRIPTIONS is answered even on a quiet socket, so a queued
+        // switch is picked up without waiting for the next event.
+        const StreamSocketScope socketScope(ws.get(), R"({"method":"LIST_SUBSCRIPTIONS","id":4})");
 
-        if (!WinHttpReceiveResponse(request.get(), nullptr))
-        {
-            std::cerr << "[backend] " << winhttpError("WinHttpReceiveResponse") << std::endl;
-            return false;
-        }
+        std::cerr << "[backend] connected to Binance ws" << (futures ? " (futures)" : " (spot)") << std::endl;
 
-        HINTERNET rawSocket = WinHttpWebSocketCompleteUpgrade(request.get(), 0);
-        if (!rawSocket)
+        // Switches queued while there was no socket are subscribed with the rest.
+        subscribedSocket = nullptr;
+        applySwitches();
+        for (auto &sync : syncs)
         {
-            std::cerr << "[backend] " << winhttpError("WinHttpWebSocketCompleteUpgrade") << std::endl;
-            return false;
+            if (sync.feed && sync.lastUpdateId <= 0)
+            {
+                resyncSnapshot(sync);
+            }
         }
-        WinHttpCloseHandle(request.get());
-
-        std::cerr << "[backend] connected to Binance ws" << (futures ? " (futures)" : " (spot)") << std::endl;
 
-        if (lastUpdateId <= 0)
+        json params = json::array();
+        for (const auto &[symbol, routed] : syncsBySymbol)
         {
-            resyncSnapshot();
+            for (auto &stream : binanceStreams(symbol))
+            {
+                params.push_back(std::move(stream));
+            }
         }
-
-        const std::string depthStream = symbolLower + "@depth@100ms";
-        const std::string tradesStream = symbolLower + "@aggTrade";
         json sub = {{"method", "SUBSCRIBE"},
-                    {"params", json::array({depthStream, tradesStream})},
+                    {"params", params},
                     {"id", 1}};
         const std::string subStr = sub.dump();
-        if (WinHttpWebSocketSend(rawSocket,
-                                 WINHTTP_WEB_SOCKET_UTF8_MESSAGE_BUFFER_TYPE,
-                                 (void *)subStr.data(),
-                                 static_cast<DWORD>(subStr.size())) != S_OK)
+        if (!ws->sendText(subStr))
         {
             std::cerr << "[backend] failed to send Binance SUBSCRIBE" << std::endl;
-            WinHttpCloseHandle(rawSocket);
             return false;
         }
         std::cerr << "[backend] sent " << subStr << std::endl;
+        subscribedSocket = ws.get();
 
-        std::vector<unsigned char> buffer(256 * 1024);
-        std::string fragmentBuffer;
-        auto lastEmit = std::chrono::steady_clock::now();
+        std::string text;
+        net::MessageType type = net::MessageType::Text;
 
         for (;;)
         {
-            DWORD received = 0;
-            WINHTTP_WEB_SOCKET_BUFFER_TYPE type;
-            HRESULT hr = WinHttpWebSocketReceive(rawSocket,
-                                                 buffer.data(),
-                                                 static_cast<DWORD>(buffer.size()),
-                                                 &received,
-                                                 &type);
-            if (FAILED(hr))
-            {
-                std::cerr << "[backend] Binance WS receive failed" << std::endl;
-                break;
-            }
-            if (type == WINHTTP_WEB_SOCKET_CLOSE_BUFFER_TYPE)
+            if (!ws->receive(text, type))
             {
-                std::cerr << "[backend] Binance WS closed" << std::endl;
+                std::cerr << "[backend] Binance WS: " << ws->error() << std::endl;
                 break;
             }
-            if (received == 0)
-            {
-                continue;
-            }
-            if (type != WINHTTP_WEB_SOCKET_UTF8_MESSAGE_BUFFER_TYPE &&
-                type != WINHTTP_WEB_SOCKET_UTF8_FRAGMENT_BUFFER_TYPE)
-            {
-                continue;
-            }
-
-            const std::string text(reinterpret_cast<char *>(buffer.data()), received);
-            if (type == WINHTTP_WEB_SOCKET_UTF8_FRAGMENT_BUFFER_TYPE)
+            applySwitches();
+            if (type != net::MessageType::Text)
             {
-                fragmentBuffer.append(text);
-                // Safety: avoid unbounded growth if we keep getting garbage fragments.
-                if (fragmentBuffer.size() > (1024 * 1024))
-                {
-                    fragmentBuffer.clear();
-                }
                 continue;
             }
 
-            std::string fullText;
-            if (!fragmentBuffer.empty())
-            {
-                fragmentBuffer.append(text);
-                fullText.swap(fragmentBuffer);
-                fragmentBuffer.clear();
-            }
-            else
-            {
-                fullText = text;
-            }
             json j;
             try
             {
-                j = json::parse(fullText);
+                j = json::parse(text);
             }
             catch (...)
             {
@@ -3454,200 +4287,37 @@ bool runBinanceWebSocket(const Config &config, dom::OrderBook &book, bool future
                 continue;
             }
             const std::string event = j.value("e", std::string());
-            if (event == "depthUpdate")
+            if (!routeBySymbol)
             {
-                const double tickSize = book.tickSize();
-                if (tickSize <= 0.0)
-                {
-                    continue;
-                }
-
-                const long long U = j.value("U", 0LL);
-                const long long u = j.value("u", 0LL);
-                if (lastUpdateId > 0 && (U <= 0 || u <= 0))
-                {
-                    continue;
-                }
-
-                if (lastUpdateId > 0 && !synced)
-                {
-                    // Drop events that are completely before our snapshot.
-                    if (u <= lastUpdateId)
-                    {
-                        continue;
-                    }
-                    // First applied event must satisfy: U <= lastUpdateId+1 <= u
-                    if (!(U <= lastUpdateId + 1 && u >= lastUpdateId + 1))
-                    {
-                        resyncSnapshot();
-                        continue;
-                    }
-                    synced = true;
-                }
-                else if (lastUpdateId > 0 && synced)
-                {
-                    if (futures)
-                    {
-                        const long long pu = j.value("pu", 0LL);
-                        if (pu != lastUpdateId)
-                        {
-                            resyncSnapshot();
-                            continue;
-                        }
-                    }
-                    else
-                    {
-                        if (U != lastUpdateId + 1)
-                        {
-                            // Missed updates; force snapshot resync.
-                            resyncSnapshot();
-                            continue;
-                        }
-                    }
-                }
-
-                std::vector<std::pair<dom::OrderBook::Tick, double>> bids;
-                std::vector<std::pair<dom::OrderBook::Tick, double>> asks;
-                auto parseSide = [tickSize](const json &arr,
-                                            std::vector<std::pair<dom::OrderBook::Tick, double>> &out) {
-                    out.clear();
-                    if (!arr.is_array())
-                    {
-                        return;
-                    }
-                    out.reserve(arr.size());
-                    for (const auto &e : arr)
-                    {
-                        if (!e.is_array() || e.size() < 2) continue;
-                        const double price = jsonToDouble(e[0]);
-                        const double qty = jsonToDouble(e[1]);
-                        const auto tick = tickFromPrice(price, tickSize);
-                        out.emplace_back(tick, qty);
-                    }
-                };
-                parseSide(j.value("b", json::array()), bids);
-                parseSide(j.value("a", json::array()), asks);
-
-                const auto now = std::chrono::steady_clock::now();
-                std::lock_guard<std::mutex> lock(g_bookMutex);
-                book.applyDelta(bids, asks, config.cacheLevelsPerSide);
-                if (lastUpdateId > 0 && u > 0)
-                {
-                    lastUpdateId = u;
-                }
-                if (now - lastEmit >= config.throttle)
-                {
-                    lastEmit = now;
-                    const auto nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-                                           std::chrono::system_clock::now().time_since_epoch())
-                                           .count();
-                    emitLadder(config, book, book.bestBid(), book.bestAsk(), nowMs);
-                }
+                applyEvent(syncs.front(), j, event);
+                continue;
             }
-            else if (event == "aggTrade")
+            const auto it = syncsBySymbol.find(j.value("s", std::string()));
+            if (it == syncsBySymbol.end())
             {
-                const double tickSize = book.tickSize();
-                if (tickSize <= 0.0)
-                {
-                    continue;
-                }
-                const double price = jsonToDouble(j.value("p", json(0.0)));
-                const double qty = jsonToDouble(j.value("q", json(0.0)));
-                const bool buyerIsMaker = j.value("m", false);
-                const bool buy = !buyerIsMaker;
-                const auto ts = j.value("T", j.value("E", 0LL));
-                json t;
-                t["type"] = "trade";
-                t["symbol"] = config.symbol;
-                dom::OrderBook::Tick tick = 0;
-                double snappedPrice = price;
-                if (quantizeTickFromPrice(price, tickSize, tick, snappedPrice))
-                {
-                    t["tick"] = tick;
-                    t["price"] = snappedPrice;
-                }
-                else
-                {
-                    t["price"] = price;
-                }
-                t["qty"] = qty;
-                t["side"] = buy ? "buy" : "sell";
-                t["timestamp"] = ts;
-                std::cout << t.dump() << '\n' << std::flush;
+                continue;
+            }
+            for (BinanceFeedSync *sync : it->second)
+            {
+                applyEvent(*sync, j, event);
             }
         }
 
-        WinHttpWebSocketClose(rawSocket, WINHTTP_WEB_SOCKET_SUCCESS_CLOSE_STATUS, nullptr, 0);
-        WinHttpCloseHandle(rawSocket);
+        subscribedSocket = nullptr;
+        ws->close();
         std::this_thread::sleep_for(std::chrono::milliseconds(250));
     }
 }
 
-bool runUzxWebSocket(const Config& config, dom::OrderBook& book, double tickSize, bool isSwap)
+bool runUzxWebSocket(BookFeed &feed, double tickSize, bool isSwap)
 {
-    const std::wstring host = L"stream.uzx.com";
-    const std::wstring path = L"/notification/ws";
-
-    WinHttpHandle session = openSession(config);
-    if (!session.valid())
-    {
-        std::cerr << "[backend] " << winhttpError("WinHttpOpen") << std::endl;
-        return false;
-    }
-
-    WinHttpHandle connection(
-        WinHttpConnect(session.get(), host.c_str(), INTERNET_DEFAULT_HTTPS_PORT, 0));
-    if (!connection.valid())
-    {
-        std::cerr << "[backend] " << winhttpError("WinHttpConnect") << std::endl;
-        return false;
-    }
-
-    WinHttpHandle request(WinHttpOpenRequest(connection.get(),
-                                             L"GET",
-                                             path.c_str(),
-                                             nullptr,
-                                             WINHTTP_NO_REFERER,
-                                             WINHTTP_DEFAULT_ACCEPT_TYPES,
-                                             WINHTTP_FLAG_SECURE));
-    if (!request.valid())
-    {
-        std::cerr << "[backend] " << winhttpError("WinHttpOpenRequest") << std::endl;
-        return false;
-    }
-
-    applyProxyCredentials(config, request.get());
-    if (!WinHttpSetOption(request.get(), WINHTTP_OPTION_UPGRADE_TO_WEB_SOCKET, nullptr, 0))
-    {
-        std::cerr << "[backend] " << winhttpError("WinHttpSetOption") << std::endl;
-        return false;
-    }
-
-    if (!WinHttpSendRequest(request.get(),
-                            WINHTTP_NO_ADDITIONAL_HEADERS,
-                            0,
-                            WINHTTP_NO_REQUEST_DATA,
-                            0,
-                            0,
-                            0))
-    {
-        std::cerr << "[backend] " << winhttpError("WinHttpSendRequest") << std::endl;
-        return false;
-    }
-
-    if (!WinHttpReceiveResponse(request.get(), nullptr))
-    {
-        std::cerr << "[backend] " << winhttpError("WinHttpReceiveResponse") << std::endl;
-        return false;
-    }
-
-    HINTERNET rawSocket = WinHttpWebSocketCompleteUpgrade(request.get(), 0);
-    if (!rawSocket)
+    const Config &config = feed.config;
+    dom::OrderBook &book = feed.book;
+    const auto ws = openWebSocket(config, "wss://stream.uzx.com/notification/ws");
+    if (!ws)
     {
-        std::cerr << "[backend] " << winhttpError("WinHttpWebSocketCompleteUpgrade") << std::endl;
         return false;
     }
-    WinHttpCloseHandle(request.get());
 
     const std::string channel = isSwap ? "swap.orderBook" : "spot.orderBook";
     const std::string biz = isSwap ? "swap" : "spot";
@@ -3656,13 +4326,7 @@ bool runUzxWebSocket(const Config& config, dom::OrderBook& book, double tickSize
                  {{"biz", biz}, {"type", channel}, {"symbol", config.symbol}, {"interval", "0"}}},
                 {"zip", false}};
     const std::string subStr = sub.dump();
-    WinHttpWebSocketSend(rawSocket,
-                         WINHTTP_WEB_SOCKET_UTF8_MESSAGE_BUFFER_TYPE,
-                         (void*) subStr.data(),
-                         static_cast<DWORD>(subStr.size()));
-
-    std::vector<unsigned char> buffer(256 * 1024);
-    auto lastEmit = std::chrono::steady_clock::now();
+    ws->sendText(subStr);
 
     auto detectTick = [](std::string_view priceStr) -> double {
         auto pos = priceStr.find('.');
@@ -3702,58 +4366,17 @@ bool runUzxWebSocket(const Config& config, dom::OrderBook& book, double tickSize
         return out;
     };
 
-    std::string fragmentBuffer;
+    std::string message;
+    net::MessageType type = net::MessageType::Text;
 
     for (;;)
     {
-        DWORD received = 0;
-        WINHTTP_WEB_SOCKET_BUFFER_TYPE type;
-        HRESULT hr =
-            WinHttpWebSocketReceive(rawSocket, buffer.data(), static_cast<DWORD>(buffer.size()), &received, &type);
-        if (FAILED(hr))
+        if (!ws->receive(message, type))
         {
-            std::cerr << "[backend] UZX ws receive failed: " << std::hex << hr << std::dec << std::endl;
+            std::cerr << "[backend] UZX ws: " << ws->error() << std::endl;
             break;
         }
-        if (type == WINHTTP_WEB_SOCKET_CLOSE_BUFFER_TYPE)
-        {
-            std::cerr << "[backend] UZX ws closed by server\n";
-            break;
-        }
-        if (received == 0) continue;
-        if (type != WINHTTP_WEB_SOCKET_UTF8_MESSAGE_BUFFER_TYPE &&
-            type != WINHTTP_WEB_SOCKET_UTF8_FRAGMENT_BUFFER_TYPE)
-        {
-            continue;
-        }
-
-        // Accumulate only when the server actually fragments the frame. WinHTTP already
-        // preserves message boundaries, so we only stitch together continuation fragments.
-        const std::string_view chunk(reinterpret_cast<char*>(buffer.data()), received);
-        const bool isFragment = (type == WINHTTP_WEB_SOCKET_UTF8_FRAGMENT_BUFFER_TYPE);
-        if (isFragment)
-        {
-            fragmentBuffer.append(chunk.data(), chunk.size());
-            if (fragmentBuffer.size() > 4 * 1024 * 1024)
-            {
-                std::cerr << "[backend] UZX ws fragment buffer too large, dropping\n";
-                fragmentBuffer.clear();
-            }
-            continue;
-        }
-
-        std::string message;
-        if (!fragmentBuffer.empty())
-        {
-            fragmentBuffer.append(chunk.data(), chunk.size());
-            message.swap(fragmentBuffer);
-        }
-        else
-        {
-            message.assign(chunk);
-        }
-
-        if (message.empty())
+        if (type != net::MessageType::Text)
         {
             continue;
         }
@@ -3763,11 +4386,7 @@ bool runUzxWebSocket(const Config& config, dom::OrderBook& book, double tickSize
             if (j.contains("ping"))
             {
                 json pong = {{"pong", j["ping"]}};
-                const std::string pongStr = pong.dump();
-                WinHttpWebSocketSend(rawSocket,
-                                     WINHTTP_WEB_SOCKET_UTF8_MESSAGE_BUFFER_TYPE,
-                                     (void*) pongStr.data(),
-                                     static_cast<DWORD>(pongStr.size()));
+                ws->sendText(pong.dump());
                 return;
             }
             const auto dataIt = j.find("data");
@@ -3785,15 +4404,7 @@ bool runUzxWebSocket(const Config& config, dom::OrderBook& book, double tickSize
             {
                 std::lock_guard<std::mutex> lock(g_bookMutex);
                 book.loadSnapshot(bids, asks);
-                const auto now = std::chrono::steady_clock::now();
-                if (now - lastEmit >= config.throttle)
-                {
-                    lastEmit = now;
-                    const auto nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-                                           std::chrono::system_clock::now().time_since_epoch())
-                                           .count();
-                    emitLadder(config, book, book.bestBid(), book.bestAsk(), nowMs);
-                }
+                bookChangedLocked(feed, std::chrono::steady_clock::now());
             }
         };
 
@@ -3807,27 +4418,206 @@ bool runUzxWebSocket(const Config& config, dom::OrderBook& book, double tickSize
         }
     }
 
-    WinHttpCloseHandle(rawSocket);
+    ws->close();
     return true;
 }
 
+// --symbols: every feed shares one WebSocket (and one process). Only venues
+// whose public streams can carry several symbols per connection qualify.
+int runMultiBook(const Config &cfg)
+{
+    const bool mexcSpot = cfg.exchange == "mexc";
+    const bool binance = isBinanceSpot(cfg) || isBinanceFutures(cfg);
+    if (!mexcSpot && !binance)
+    {
+        std::cerr << "[backend] --symbols is supported for mexc, binance and binance_futures only" << std::endl;
+        return 1;
+    }
+    const std::size_t maxFeeds = maxFeedsFor(cfg);
+    if (cfg.symbols.size() > maxFeeds)
+    {
+        std::cerr << "[backend] --symbols: at most " << maxFeeds << " symbols per connection for "
+                  << cfg.exchange << std::endl;
+        return 1;
+    }
+
+    const std::vector<std::string> shmNames = splitList(cfg.shmName);
+    const bool futures = isBinanceFutures(cfg);
+    std::vector<BookFeed *> feeds;
+    std::vector<BookFeed *> liveFeeds;
+    std::vector<long long> snapshotIds; // parallel to liveFeeds
+    for (std::size_t i = 0; i < cfg.symbols.size(); ++i)
+    {
+        Config feedCfg = cfg;
+        feedCfg.symbol = cfg.symbols[i];
+        feedCfg.symbols.clear();
+        // "-" keeps the positions aligned for feeds that have no segment.
+        feedCfg.shmName = (i < shmNames.size() && shmNames[i] != "-") ? shmNames[i] : std::string();
+        BookFeed &feed = addFeed(feedCfg);
+        feeds.push_back(&feed);
+        if (!feedCfg.shmName.empty() && !openSharedSegment(feed, feedCfg.shmName))
+        {
+            std::cerr << "[backend] " << feedCfg.symbol << ": shared memory unavailable, using stdout" << std::endl;
+        }
+    }
+    std::cerr << "[backend] protocol=2 tickQuant=scaled book="
+              << (cfg.bookStorage == dom::OrderBook::Storage::Flat ? "flat" : "map")
+              << " wire=" << (cfg.binaryProtocol ? "binary" : "json")
+              << " feeds=" << feeds.size() << std::endl;
+
+    // Metadata and snapshots are still per symbol; a symbol that fails keeps its
+    // id (so the GUI mapping stays valid) but never becomes ready.
+    for (BookFeed *feed : feeds)
+    {
+        const Config &feedCfg = feed->config;
+        dom::OrderBook &book = feed->book;
+        double tickSize = 0.0;
+        long long lastUpdateId = 0;
+        bool tickOk = false;
+        if (mexcSpot)
+        {
+            tickOk = fetchExchangeInfo(feedCfg, tickSize);
+        }
+        else
+        {
+            tickOk = futures ? fetchBinanceExchangeInfoFutures(feedCfg, tickSize)
+                             : fetchBinanceExchangeInfoSpot(feedCfg, tickSize);
+        }
+        if (!tickOk)
+        {
+            std::cerr << "[backend] " << feedCfg.symbol << ": failed to determine tick size, skipping" << std::endl;
+            continue;
+        }
+        book.setTickSize(tickSize);
+
+        if (mexcSpot)
+        {
+            if (!fetchSnapshot(feedCfg, book))
+            {
+                std::cerr << "[backend] " << feedCfg.symbol << ": snapshot failed, continuing with empty book"
+                          << std::endl;
+            }
+        }
+        else
+        {
+            BinanceDepthSnapshot snap;
+            const bool snapshotOk = futures ? fetchBinanceSnapshotFutures(feedCfg, tickSize, snap)
+                                            : fetchBinanceSnapshotSpot(feedCfg, tickSize, snap);
+            if (snapshotOk)
+            {
+                book.loadSnapshot(snap.bids, snap.asks);
+                lastUpdateId = snap.lastUpdateId;
+            }
+            else
+            {
+                std::cerr << "[backend] " << feedCfg.symbol << ": snapshot failed, continuing with empty book"
+                          << std::endl;
+            }
+        }
+        if (book.bestBid() > 0.0 && book.bestAsk() > 0.0)
+        {
+            const auto nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                   std::chrono::system_clock::now().time_since_epoch())
+                                   .count();
+            emitLadder(*feed, book.bestBid(), book.bestAsk(), nowMs);
+        }
+        feed->ready.store(true);
+        liveFeeds.push_back(feed);
+        snapshotIds.push_back(lastUpdateId);
+    }
+    if (liveFeeds.empty())
+    {
+        std::cerr << "[backend] no symbol could be initialised, exiting" << std::endl;
+        return 1;
+    }
+
+    g_addBookConfig = cfg;
+    g_addBookConfig.symbol.clear();
+    g_addBookConfig.symbols.clear();
+    g_addBookConfig.shmName.clear();
+    std::thread(controlReaderThread).detach();
+    std::thread(ladderFlushThread).detach();
+    if (mexcSpot)
+    {
+        runWebSocket(cfg, liveFeeds);
+    }
+    else
+    {
+        runBinanceWebSocket(cfg, liveFeeds, futures, snapshotIds);
+    }
+    if (g_replayer)
+    {
+        finishReplay();
+    }
+    g_stdout.drain();
+    return 0;
+}
+
 int main(int argc, char** argv)
 {
 #if defined(ORDERBOOK_BACKEND_QT)
     QCoreApplication qtApp(argc, argv);
 #endif
+    const FetchWorkersScope fetchWorkersScope;
     try
     {
-        auto cfg = parseArgs(argc, argv);
-        std::cerr << "[backend] protocol=2 tickQuant=scaled" << std::endl;
-        if (!cfg.winProxy.empty())
+        const Config parsed = parseArgs(argc, argv);
+#ifdef _WIN32
+        if (parsed.binaryProtocol)
         {
-            std::cerr << "[backend] proxy enabled: type=" << cfg.proxyType
-                      << " auth=" << (cfg.proxyUser.empty() ? "0" : "1") << std::endl;
+            // Text-mode stdout would expand every 0x0A inside a frame to CRLF.
+            _setmode(_fileno(stdout), _O_BINARY);
         }
-        dom::OrderBook book;
-        book.setCacheLevelsPerSide(cfg.cacheLevelsPerSide);
+#endif
+        if (parsed.proxySettings.enabled())
+        {
+            std::cerr << "[backend] proxy enabled: type=" << parsed.proxyType
+                      << " auth=" << (parsed.proxySettings.user.empty() ? "0" : "1") << std::endl;
+        }
+        if (!parsed.endpoint.empty())
+        {
+            std::cerr << "[backend] stream endpoint override: " << parsed.endpoint << std::endl;
+        }
+        std::string recordingError;
+        if (!parsed.recordPath.empty())
+        {
+            g_recorder = std::make_unique<net::Recorder>();
+            if (!g_recorder->open(parsed.recordPath, recordingError))
+            {
+                throw std::runtime_error("--record: " + recordingError);
+            }
+            std::cerr << "[backend] recording to " << parsed.recordPath << std::endl;
+        }
+        if (!parsed.replayPath.empty())
+        {
+            g_replayer = std::make_unique<net::Replayer>();
+            if (!g_replayer->open(parsed.replayPath, parsed.replaySpeed, recordingError))
+            {
+                throw std::runtime_error("--replay: " + recordingError);
+            }
+            // Replay output is diffed between runs: keep every message and block instead.
+            g_stdout.setLossless(true);
+            std::cerr << "[backend] replaying " << parsed.replayPath << " speed="
+                      << (parsed.replaySpeed > 0.0 ? std::to_string(parsed.replaySpeed) : std::string("max")) << std::endl;
+        }
+        if (!parsed.symbols.empty())
+        {
+            return runMultiBook(parsed);
+        }
+
+        BookFeed &feed = addFeed(parsed);
+        Config &cfg = feed.config;
+        dom::OrderBook &book = feed.book;
+        if (!cfg.shmName.empty() && !openSharedSegment(feed, cfg.shmName))
+        {
+            std::cerr << "[backend] shared memory unavailable, sending ladders over stdout" << std::endl;
+        }
+        std::cerr << "[backend] protocol=2 tickQuant=scaled book="
+                  << (cfg.bookStorage == dom::OrderBook::Storage::Flat ? "flat" : "map")
+                  << " wire=" << (cfg.binaryProtocol ? "binary" : "json")
+                  << " transport=" << (feed.shmActive ? "shm" : "pipe") << std::endl;
         std::thread(controlReaderThread).detach();
+        std::thread(ladderFlushThread).detach();
 
         if (cfg.exchange == "mexc")
         {
@@ -3849,15 +4639,10 @@ int main(int argc, char** argv)
                 const auto nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
                                        std::chrono::system_clock::now().time_since_epoch())
                                        .count();
-                emitLadder(cfg, book, book.bestBid(), book.bestAsk(), nowMs);
-            }
-            {
-                std::lock_guard<std::mutex> lock(g_bookMutex);
-                g_bookPtr = &book;
-                g_activeConfig = cfg;
+                emitLadder(feed, book.bestBid(), book.bestAsk(), nowMs);
             }
-            g_bookReady.store(true);
-            runWebSocket(cfg, book);
+            feed.ready.store(true);
+            runWebSocket(cfg, {&feed});
         }
         else if (cfg.exchange == "mexc_futures")
         {
@@ -3880,15 +4665,10 @@ int main(int argc, char** argv)
                 const auto nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
                                        std::chrono::system_clock::now().time_since_epoch())
                                        .count();
-                emitLadder(cfg, book, book.bestBid(), book.bestAsk(), nowMs);
-            }
-            {
-                std::lock_guard<std::mutex> lock(g_bookMutex);
-                g_bookPtr = &book;
-                g_activeConfig = cfg;
+                emitLadder(feed, book.bestBid(), book.bestAsk(), nowMs);
             }
-            g_bookReady.store(true);
-            runMexcFuturesWebSocket(cfg, book);
+            feed.ready.store(true);
+            runMexcFuturesWebSocket(feed);
         }
         else if (cfg.exchange == "binance" || cfg.exchange == "binance_futures")
         {
@@ -3921,15 +4701,10 @@ int main(int argc, char** argv)
                 const auto nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
                                        std::chrono::system_clock::now().time_since_epoch())
                                        .count();
-                emitLadder(cfg, book, book.bestBid(), book.bestAsk(), nowMs);
-            }
-            {
-                std::lock_guard<std::mutex> lock(g_bookMutex);
-                g_bookPtr = &book;
-                g_activeConfig = cfg;
+                emitLadder(feed, book.bestBid(), book.bestAsk(), nowMs);
             }
-            g_bookReady.store(true);
-            runBinanceWebSocket(cfg, book, futures, snap.lastUpdateId);
+            feed.ready.store(true);
+            runBinanceWebSocket(cfg, {&feed}, futures, {snap.lastUpdateId});
         }
         else if (cfg.exchange == "lighter")
         {
@@ -3950,13 +4725,8 @@ int main(int argc, char** argv)
             {
                 book.setTickSize(tickSize);
             }
-            {
-                std::lock_guard<std::mutex> lock(g_bookMutex);
-                g_bookPtr = &book;
-                g_activeConfig = cfg;
-            }
-            g_bookReady.store(true);
-            runLighterWebSocket(cfg, book, marketId);
+            feed.ready.store(true);
+            runLighterWebSocket(feed, marketId);
         }
         else
         {
@@ -3978,16 +4748,16 @@ int main(int argc, char** argv)
                 const auto nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
                                        std::chrono::system_clock::now().time_since_epoch())
                                        .count();
-                emitLadder(cfg, book, book.bestBid(), book.bestAsk(), nowMs);
-            }
-            {
-                std::lock_guard<std::mutex> lock(g_bookMutex);
-                g_bookPtr = &book;
-                g_activeConfig = cfg;
+                emitLadder(feed, book.bestBid(), book.bestAsk(), nowMs);
             }
-            g_bookReady.store(true);
-            runUzxWebSocket(cfg, book, tickSize > 0.0 ? tickSize : book.tickSize(), isSwap);
+            feed.ready.store(true);
+            runUzxWebSocket(feed, tickSize > 0.0 ? tickSize : book.tickSize(), isSwap);
+        }
+        if (g_replayer)
+        {
+            finishReplay();
         }
+        g_stdout.drain();
         return 0;
     }
     catch (const std::exception& ex)
@@ -0,0 +1,434 @@
+#include "DomLadderItem.h"
+
+#include <QElapsedTimer>
+#include <QFontMetricsF>
+#include <QGuiApplication>
+#include <QPainter>
+#include <QQuickWindow>
+#include <QSGGeometryNode>
+#include <QSGTexture>
+#include <QSGTextureMaterial>
+#include <QSGVertexColorMaterial>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+namespace {
+constexpr int kAtlasColumns = 16;
+constexpr int kAtlasRows = 8;
+constexpr int kMaxGlyphs = kAtlasColumns * kAtlasRows;
+constexpr qreal kGlyphPad = 1.0; // logical px around each glyph in its cell
+
+// Rendered up front so the common price/volume strings never grow an atlas.
+const QString &prewarmChars()
+{
+    static const QString chars = QStringLiteral("0123456789.,()-+%$ KMB");
+    return chars;
+}
+
+class ColorNode : public QSGGeometryNode {
+public:
+    ColorNode()
+        : m_geometry(QSGGeometry::defaultAttributes_ColoredPoint2D(), 0)
+    {
+        m_geometry.setDrawingMode(QSGGeometry::DrawTriangles);
+        setGeometry(&m_geometry);
+        setMaterial(&m_material);
+    }
+
+    void setVertices(const QVector<QSGGeometry::ColoredPoint2D> &vertices)
+    {
+        m_geometry.allocate(vertices.size());
+        std::copy(vertices.cbegin(), vertices.cend(), m_geometry.vertexDataAsColoredPoint2D());
+        markDirty(QSGNode::DirtyGeometry);
+    }
+
+private:
+    QSGGeometry m_geometry;
+    QSGVertexColorMaterial m_material;
+};
+
+class TextNode : public QSGGeometryNode {
+public:
+    TextNode()
+        : m_geometry(QSGGeometry::defaultAttributes_TexturedPoint2D(), 0)
+    {
+        m_geometry.setDrawingMode(QSGGeometry::DrawTriangles);
+        setGeometry(&m_geometry);
+        setMaterial(&m_material);
+    }
+
+    // Render thread; the texture is owned by (and dies with) the node.
+    void setImage(QQuickWindow *window, const QImage &image, quint64 serial)
+    {
+        if (serial == m_serial || !window) {
+            return;
+        }
+        m_texture.reset(window->createTextureFromImage(image));
+        if (m_texture) {
+            m_texture->setFiltering(QSGTexture::Nearest);
+        }
+        m_material.setTexture(m_texture.get());
+        m_serial = serial;
+        markDirty(QSGNode::DirtyMaterial);
+    }
+
+    void setVertices(const QVector<QSGGeometry::TexturedPoint2D> &vertices)
+    {
+        const int count = m_texture ? static_cast<int>(vertices.size()) : 0;
+        m_geometry.allocate(count);
+        std::copy(vertices.cbegin(), vertices.cbegin() + count, m_geometry.vertexDataAsTexturedPoint2D());
+        markDirty(QSGNode::DirtyGeometry);
+    }
+
+private:
+    QSGGeometry m_geometry;
+    QSGTextureMaterial m_material;
+    std::unique_ptr<QSGTexture> m_texture;
+    quint64 m_serial = 0;
+};
+
+// Children in paint order: rects, one node per text layer, overlay.
+class LadderNode : public QSGNode {
+public:
+    LadderNode()
+    {
+        rects = new ColorNode;
+        overlay = new ColorNode;
+        appendChildNode(rects);
+        appendChildNode(overlay);
+    }
+
+    ColorNode *rects = nullptr;
+    ColorNode *overlay = nullptr;
+    QVector<TextNode *> texts;
+};
+} // namespace
+
+DomLadderItem::DomLadderItem(QQuickItem *parent)
+    : QQuickItem(parent)
+{
+    setFlag(ItemHasContents, true);
+    connect(this, &DomLadderItem::appearanceChanged, this, &QQuickItem::polish);
+    connect(this, &QQuickItem::widthChanged, this, &QQuickItem::polish);
+    connect(this, &QQuickItem::heightChanged, this, &QQuickItem::polish);
+    connect(this, &DomLadderItem::fontsChanged, this, [this]() {
+        m_facesDirty = true;
+        polish();
+    });
+    // The order-highlight pulse is animated from QML; only rows showing it need a rebuild.
+    connect(this, &DomLadderItem::highlightPhaseChanged, this, [this]() {
+        if (m_hasHighlight) {
+            polish();
+        }
+    });
+}
+
+void DomLadderItem::swapRows(QVector<DomLadderRow> &rows)
+{
+    m_rows.swap(rows);
+    polish();
+}
+
+void DomLadderItem::clearRows()
+{
+    if (m_rows.isEmpty()) {
+        return;
+    }
+    m_rows.clear();
+    polish();
+}
+
+void DomLadderItem::rebuildFaces()
+{
+    m_facesDirty = false;
+    m_volumeFontRowHeight = m_rowHeight;
+
+    QFont priceFont(m_priceFontFamily);
+    priceFont.setPixelSize(std::max(10, m_priceFontPixelSize));
+    QFont priceBold = priceFont;
+    priceBold.setBold(true);
+    QFont volumeFont = QGuiApplication::font();
+    volumeFont.setPixelSize(std::max(10, m_rowHeight - 4));
+    volumeFont.setBold(true);
+    const QFont fonts[FaceCount] = {priceFont, priceBold, volumeFont};
+
+    for (int i = 0; i < FaceCount; ++i) {
+        GlyphFace &face = m_faces[i];
+        face.font = fonts[i];
+        const QFontMetricsF fm(face.font);
+        face.ascent = fm.ascent();
+        face.height = fm.height();
+        face.cellWidth = static_cast<int>(std::ceil((fm.maxWidth() + 2.0 * kGlyphPad) * m_dpr));
+        face.cellHeight = static_cast<int>(std::ceil((fm.height() + 2.0 * kGlyphPad) * m_dpr));
+        face.chars.clear();
+        face.advances.clear();
+        face.index.clear();
+        ++face.version;
+        for (const QChar ch : prewarmChars()) {
+            glyphIndex(face, ch);
+        }
+    }
+}
+
+int DomLadderItem::glyphIndex(GlyphFace &face, QChar ch)
+{
+    const auto it = face.index.constFind(ch.unicode());
+    if (it != face.index.constEnd()) {
+        return it.value();
+    }
+    if (face.chars.size() >= kMaxGlyphs) {
+        return -1;
+    }
+    const int index = face.chars.size();
+    face.chars.append(ch);
+    face.advances.append(QFontMetricsF(face.font).horizontalAdvance(ch));
+    face.index.insert(ch.unicode(), index);
+    ++face.version;
+    return index;
+}
+
+DomLadderItem::TextLayer &DomLadderItem::layerFor(int face, QRgb color)
+{
+    for (TextLayer &layer : m_layers) {
+        if (layer.face == face && layer.color == color) {
+            return layer;
+        }
+    }
+    TextLayer layer;
+    layer.face = face;
+    layer.color = color;
+    m_layers.append(layer);
+    return m_layers.last();
+}
+
+void DomLadderItem::renderLayerImage(TextLayer &layer)
+{
+    const GlyphFace &face = m_faces[layer.face];
+    QImage image(face.cellWidth * kAtlasColumns, face.cellHeight * kAtlasRows, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    image.setDevicePixelRatio(m_dpr);
+    {
+        QPainter painter(&image);
+        painter.setFont(face.font);
+        painter.setPen(QColor::fromRgba(layer.color));
+        for (int i = 0; i < face.chars.size(); ++i) {
+            const qreal x = (i % kAtlasColumns) * face.cellWidth / m_dpr + kGlyphPad;
+            const qreal y = (i / kAtlasColumns) * face.cellHeight / m_dpr + kGlyphPad + face.ascent;
+            painter.drawText(QPointF(x, y), QString(face.chars.at(i)));
+        }
+    }
+    layer.image = image;
+    layer.imageFaceVersion = face.version;
+    layer.imageSerial = ++m_imageSerial;
+}
+
+qreal DomLadderItem::textWidth(GlyphFace &face, const QString &text)
+{
+    qreal width = 0.0;
+    for (const QChar ch : text) {
+        const int index = glyphIndex(face, ch);
+        width += index >= 0 ? face.advances[index] : face.height * 0.5;
+    }
+    return width;
+}
+
+void DomLadderItem::addText(int faceId, QRgb color, const QString &text, qreal x, qreal rowTop)
+{
+    if (text.isEmpty() || qAlpha(color) == 0) {
+        return;
+    }
+    GlyphFace &face = m_faces[faceId];
+    QVector<QSGGeometry::TexturedPoint2D> &out = layerFor(faceId, color).vertices;
+    const qreal cellW = face.cellWidth / m_dpr;
+    const qreal cellH = face.cellHeight / m_dpr;
+    const float du = 1.0f / kAtlasColumns;
+    const float dv = 1.0f / kAtlasRows;
+    // Vertically centred in the row, like `anchors.verticalCenter` on a Text.
+    const float y0 = static_cast<float>(snap(rowTop + (m_rowHeight - face.height) * 0.5) - kGlyphPad);
+    const float y1 = static_cast<float>(y0 + cellH);
+    qreal pen = x;
+    for (const QChar ch : text) {
+        const int index = glyphIndex(face, ch);
+        if (index < 0) {
+            pen += face.height * 0.5;
+            continue;
+        }
+        if (!ch.isSpace()) {
+            const float x0 = static_cast<float>(snap(pen) - kGlyphPad);
+            const float x1 = static_cast<float>(x0 + cellW);
+            const float u0 = (index % kAtlasColumns) * du;
+            const float v0 = (index / kAtlasColumns) * dv;
+            QSGGeometry::TexturedPoint2D quad[6];
+            quad[0].set(x0, y0, u0, v0);
+            quad[1].set(x1, y0, u0 + du, v0);
+            quad[2].set(x0, y1, u0, v0 + dv);
+            quad[3].set(x1, y0, u0 + du, v0);
+            quad[4].set(x1, y1, u0 + du, v0 + dv);
+            quad[5].set(x0, y1, u0, v0 + dv);
+            for (const auto &v : quad) {
+                out.append(v);
+            }
+        }
+        pen += face.advances[index];
+    }
+}
+
+void DomLadderItem::addRect(QVector<QSGGeometry::ColoredPoint2D> &out,
+                            qreal x,
+                            qreal y,
+                            qreal w,
+                            qreal h,
+                            QRgb color,
+                            qreal opacity) const
+{
+    const int alpha = static_cast<int>(std::lround(qAlpha(color) * std::clamp(opacity, 0.0, 1.0)));
+    if (w <= 0.0 || h <= 0.0 || alpha <= 0) {
+        return;
+    }
+    // QSGVertexColorMaterial expects premultiplied colors.
+    const auto r = static_cast<uchar>(qRed(color) * alpha / 255);
+    const auto g = static_cast<uchar>(qGreen(color) * alpha / 255);
+    const auto b = static_cast<uchar>(qBlue(color) * alpha / 255);
+    const auto a = static_cast<uchar>(alpha);
+    const float x0 = static_cast<float>(x);
+    const float y0 = static_cast<float>(y);
+    const float x1 = static_cast<float>(x + w);
+    const float y1 = static_cast<float>(y + h);
+    QSGGeometry::ColoredPoint2D quad[6];
+    quad[0].set(x0, y0, r, g, b, a);
+    quad[1].set(x1, y0, r, g, b, a);
+    quad[2].set(x0, y1, r, g, b, a);
+    quad[3].set(x1, y0, r, g, b, a);
+    quad[4].set(x1, y1, r, g, b, a);
+    quad[5].set(x0, y1, r, g, b, a);
+    for (const auto &v : quad) {
+        out.append(v);
+    }
+}
+
+qreal DomLadderItem::snap(qreal v) const
+{
+    return std::round(v * m_dpr) / m_dpr;
+}
+
+void DomLadderItem::updatePolish()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    const qreal dpr = window() ? window()->effectiveDevicePixelRatio() : 1.0;
+    if (!qFuzzyCompare(dpr, m_dpr)) {
+        m_dpr = dpr;
+        m_facesDirty = true;
+    }
+    if (m_volumeFontRowHeight != m_rowHeight) {
+        m_facesDirty = true;
+    }
+    if (m_facesDirty) {
+        rebuildFaces();
+    }
+
+    m_rectVertices.clear();
+    m_overlayVertices.clear();
+    for (TextLayer &layer : m_layers) {
+        layer.vertices.clear();
+    }
+
+    // Same geometry as the GpuDomView.qml delegate.
+    const qreal w = width();
+    const qreal rowHeight = std::max(1, m_rowHeight);
+    const int visibleRows = static_cast<int>(std::ceil(height() / rowHeight));
+    const int rows = std::min(static_cast<int>(m_rows.size()), std::max(0, visibleRows));
+    const qreal priceWidth = m_priceColumnWidth;
+    const qreal bookWidth = std::max<qreal>(0.0, w - priceWidth);
+    const qreal priceLeft = w - priceWidth;
+    const QRgb priceBorder = m_priceBorderColor.rgba();
+    const QRgb grid = m_gridColor.rgba();
+    const QRgb pnl = m_positionPnlColor.rgba();
+    const QRgb text = m_textColor.rgba();
+    const QRgb hover = qRgb(0x28, 0x60, 0xff);
+    const QRgb white = qRgb(0xff, 0xff, 0xff);
+
+    const double tol = std::max(1e-8, m_tickSize > 0.0 ? m_tickSize * 0.25 : 1e-8);
+    const bool position = m_positionActive && m_positionEntryPrice > 0.0 && m_positionMarkPrice > 0.0;
+    const double rangeMin = std::min(m_positionEntryPrice, m_positionMarkPrice);
+    const double rangeMax = std::max(m_positionEntryPrice, m_positionMarkPrice);
+    const double pulse = 0.5 - 0.5 * std::cos(m_highlightPhase * 6.283185307179586);
+
+    m_hasHighlight = false;
+    for (int i = 0; i < rows; ++i) {
+        const DomLadderRow &row = m_rows.at(i);
+        const qreal y = i * rowHeight;
+        const bool inRange = position && row.price + tol >= rangeMin && row.price - tol <= rangeMax;
+        const bool markRow = m_positionActive && m_positionMarkPrice > 0.0
+                             && std::abs(row.price - m_positionMarkPrice) <= tol;
+
+        addRect(m_rectVertices, 0.0, y, bookWidth, rowHeight, row.bookColor);
+        if (row.volumeFillRatio > 0.0) {
+            addRect(m_rectVertices, 0.0, y, bookWidth * row.volumeFillRatio, rowHeight, row.volumeFillColor);
+        }
+        addRect(m_rectVertices, bookWidth, y, 1.0, rowHeight, priceBorder, 0.7);
+        addRect(m_rectVertices, priceLeft, y, priceWidth, rowHeight, row.priceBgColor);
+        if (inRange) {
+            addRect(m_rectVertices, priceLeft, y, priceWidth, rowHeight, pnl, 0.12);
+        }
+        if (markRow) {
+            addRect(m_rectVertices, priceLeft, y, 2.0, rowHeight, pnl, 0.9);
+            addRect(m_rectVertices, priceLeft, y, priceWidth, 1.0, pnl);
+            addRect(m_rectVertices, priceLeft, y + rowHeight - 1.0, priceWidth, 1.0, pnl);
+            addRect(m_rectVertices, priceLeft, y, 1.0, rowHeight, pnl);
+            addRect(m_rectVertices, w - 1.0, y, 1.0, rowHeight, pnl);
+        }
+        addRect(m_rectVertices, w - 1.0, y, 1.0, rowHeight, priceBorder);
+
+        addText(VolumeFace, row.volumeTextColor, row.volumeText, 4.0, y);
+        if (!row.priceText.isEmpty()) {
+            const int face = markRow ? PriceBoldFace : PriceFace;
+            const qreal textW = textWidth(m_faces[face], row.priceText);
+            addText(face, inRange ? pnl : text, row.priceText, w - 6.0 - textW, y);
+        }
+
+        addRect(m_overlayVertices, 0.0, y + rowHeight - 1.0, w, 1.0, grid, 0.4);
+        if (i == m_hoverRow) {
+            addRect(m_overlayVertices, 0.0, y, w, rowHeight, hover, 0.25);
+        }
+        if (row.orderHighlight) {
+            m_hasHighlight = true;
+            addRect(m_overlayVertices, 0.0, y, w, rowHeight, white, 0.020 + pulse * 0.090);
+        }
+    }
+
+    // New glyphs met above re-render the atlases of their face.
+    for (TextLayer &layer : m_layers) {
+        if (layer.imageFaceVersion != m_faces[layer.face].version) {
+            renderLayerImage(layer);
+        }
+    }
+
+    m_polishNs += timer.nsecsElapsed();
+    update();
+}
+
+QSGNode *DomLadderItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
+{
+    auto *node = static_cast<LadderNode *>(oldNode);
+    if (!node) {
+        node = new LadderNode;
+    }
+    node->rects->setVertices(m_rectVertices);
+    while (node->texts.size() < m_layers.size()) {
+        auto *textNode = new TextNode;
+        node->insertChildNodeBefore(textNode, node->overlay);
+        node->texts.append(textNode);
+    }
+    for (int i = 0; i < m_layers.size(); ++i) {
+        const TextLayer &layer = m_layers.at(i);
+        TextNode *textNode = node->texts.at(i);
+        textNode->setImage(window(), layer.image, layer.imageSerial);
+        textNode->setVertices(layer.vertices);
+    }
+    node->overlay->setVertices(m_overlayVertices);
+    return node;
+}
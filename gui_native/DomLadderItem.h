@@ -0,0 +1,146 @@
+#pragma once
+
+#include <QColor>
+#include <QFont>
+#include <QHash>
+#include <QImage>
+#include <QQuickItem>
+#include <QSGGeometry>
+#include <QString>
+#include <QVector>
+
+#include <utility>
+
+// One ladder row as DomWidget resolved it. Colors are plain (non-premultiplied)
+// ARGB; a zero alpha means "not drawn".
+struct DomLadderRow {
+    double price = 0.0;
+    QString priceText;
+    QString volumeText;
+    QRgb bookColor = 0;
+    QRgb priceBgColor = 0;
+    QRgb volumeFillColor = 0;
+    QRgb volumeTextColor = 0;
+    double volumeFillRatio = 0.0;
+    bool orderHighlight = false;
+};
+
+// Scene-graph renderer for the DOM ladder, the native alternative to the
+// ListView in GpuDomView.qml. It draws the same row layout as that delegate:
+// every background, bar, border and overlay rect goes into two vertex-colored
+// geometry nodes, and text is drawn as quads from prerendered glyph atlases
+// (one texture per face and color). Rows come straight from DomWidget, with no
+// model, roles or per-row items.
+class DomLadderItem : public QQuickItem {
+    Q_OBJECT
+    Q_PROPERTY(int rowHeight MEMBER m_rowHeight NOTIFY appearanceChanged)
+    Q_PROPERTY(int priceColumnWidth MEMBER m_priceColumnWidth NOTIFY appearanceChanged)
+    Q_PROPERTY(int hoverRow MEMBER m_hoverRow NOTIFY appearanceChanged)
+    Q_PROPERTY(QColor gridColor MEMBER m_gridColor NOTIFY appearanceChanged)
+    Q_PROPERTY(QColor textColor MEMBER m_textColor NOTIFY appearanceChanged)
+    Q_PROPERTY(QColor priceBorderColor MEMBER m_priceBorderColor NOTIFY appearanceChanged)
+    Q_PROPERTY(double tickSize MEMBER m_tickSize NOTIFY appearanceChanged)
+    Q_PROPERTY(bool positionActive MEMBER m_positionActive NOTIFY appearanceChanged)
+    Q_PROPERTY(double positionEntryPrice MEMBER m_positionEntryPrice NOTIFY appearanceChanged)
+    Q_PROPERTY(double positionMarkPrice MEMBER m_positionMarkPrice NOTIFY appearanceChanged)
+    Q_PROPERTY(QColor positionPnlColor MEMBER m_positionPnlColor NOTIFY appearanceChanged)
+    Q_PROPERTY(QString priceFontFamily MEMBER m_priceFontFamily NOTIFY fontsChanged)
+    Q_PROPERTY(int priceFontPixelSize MEMBER m_priceFontPixelSize NOTIFY fontsChanged)
+    Q_PROPERTY(double highlightPhase MEMBER m_highlightPhase NOTIFY highlightPhaseChanged)
+
+public:
+    explicit DomLadderItem(QQuickItem *parent = nullptr);
+
+    // Takes `rows` and hands back the previous rows, so the caller can refill
+    // that storage for the next frame without allocating.
+    void swapRows(QVector<DomLadderRow> &rows);
+    void clearRows();
+
+    // GUI-thread time spent rebuilding geometry since the previous call.
+    qint64 takePolishNs() { return std::exchange(m_polishNs, 0); }
+
+signals:
+    void appearanceChanged();
+    void fontsChanged();
+    void highlightPhaseChanged();
+
+protected:
+    void updatePolish() override;
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+
+private:
+    enum Face {
+        PriceFace = 0,
+        PriceBoldFace,
+        VolumeFace,
+        FaceCount
+    };
+
+    // Glyph cells are appended and never move, so texture coordinates stay
+    // valid while new characters are added.
+    struct GlyphFace {
+        QFont font;
+        qreal ascent = 0.0;
+        qreal height = 0.0;
+        int cellWidth = 0;  // device pixels
+        int cellHeight = 0; // device pixels
+        QString chars;
+        QVector<qreal> advances;
+        QHash<ushort, int> index;
+        int version = 0;
+    };
+
+    struct TextLayer {
+        int face = PriceFace;
+        QRgb color = 0;
+        QImage image;
+        int imageFaceVersion = -1;
+        quint64 imageSerial = 0;
+        QVector<QSGGeometry::TexturedPoint2D> vertices;
+    };
+
+    void rebuildFaces();
+    int glyphIndex(GlyphFace &face, QChar ch);
+    TextLayer &layerFor(int face, QRgb color);
+    void renderLayerImage(TextLayer &layer);
+    qreal textWidth(GlyphFace &face, const QString &text);
+    void addText(int face, QRgb color, const QString &text, qreal x, qreal rowTop);
+    void addRect(QVector<QSGGeometry::ColoredPoint2D> &out,
+                 qreal x,
+                 qreal y,
+                 qreal w,
+                 qreal h,
+                 QRgb color,
+                 qreal opacity = 1.0) const;
+    qreal snap(qreal v) const;
+
+    QVector<DomLadderRow> m_rows;
+
+    int m_rowHeight = 14;
+    int m_priceColumnWidth = 80;
+    int m_hoverRow = -1;
+    QColor m_gridColor = QColor("#1f1f1f");
+    QColor m_textColor = QColor("#e4e4e4");
+    QColor m_priceBorderColor = QColor("#2b2b2b");
+    double m_tickSize = 0.0;
+    bool m_positionActive = false;
+    double m_positionEntryPrice = 0.0;
+    double m_positionMarkPrice = 0.0;
+    QColor m_positionPnlColor = QColor("#e4e4e4");
+    QString m_priceFontFamily = QStringLiteral("JetBrains Mono");
+    int m_priceFontPixelSize = 12;
+    double m_highlightPhase = 0.0;
+
+    GlyphFace m_faces[FaceCount];
+    bool m_facesDirty = true;
+    qreal m_dpr = 1.0;
+    int m_volumeFontRowHeight = -1;
+    QVector<TextLayer> m_layers;
+    quint64 m_imageSerial = 0;
+    bool m_hasHighlight = false;
+
+    // Rebuilt by updatePolish() (GUI thread), copied by updatePaintNode().
+    QVector<QSGGeometry::ColoredPoint2D> m_rectVertices;
+    QVector<QSGGeometry::ColoredPoint2D> m_overlayVertices;
+    qint64 m_polishNs = 0;
+};
@@ -1,5 +1,6 @@
 #include "DomLevelsModel.h"
 
+#include <algorithm>
 #include <utility>
 
 DomLevelsModel::DomLevelsModel(QObject *parent)
@@ -79,6 +80,77 @@ QHash<int, QByteArray> DomLevelsModel::roleNames() const
     return roles;
 }
 
+quint32 DomLevelsModel::changedRoles(const Row &a, const Row &b)
+{
+    auto bit = [](Role role) { return quint32(1) << (role - PriceRole); };
+    quint32 mask = 0;
+    if (a.price != b.price) mask |= bit(PriceRole);
+    if (a.bidQty != b.bidQty) mask |= bit(BidQtyRole);
+    if (a.askQty != b.askQty) mask |= bit(AskQtyRole);
+    if (a.priceText != b.priceText) mask |= bit(PriceTextRole);
+    if (a.bookColor != b.bookColor) mask |= bit(BookColorRole);
+    if (a.priceBgColor != b.priceBgColor) mask |= bit(PriceBgColorRole);
+    if (a.volumeText != b.volumeText) mask |= bit(VolumeTextRole);
+    if (a.volumeTextColor != b.volumeTextColor) mask |= bit(VolumeTextColorRole);
+    if (a.volumeFillColor != b.volumeFillColor) mask |= bit(VolumeFillColorRole);
+    if (!qFuzzyCompare(1.0 + a.volumeFillRatio, 1.0 + b.volumeFillRatio)) mask |= bit(VolumeFillRatioRole);
+    if (a.markerText != b.markerText) mask |= bit(MarkerTextRole);
+    if (a.markerFillColor != b.markerFillColor) mask |= bit(MarkerFillColorRole);
+    if (a.markerBorderColor != b.markerBorderColor) mask |= bit(MarkerBorderColorRole);
+    if (a.markerBuy != b.markerBuy) mask |= bit(MarkerBuyRole);
+    if (a.orderHighlight != b.orderHighlight) mask |= bit(OrderHighlightRole);
+    return mask;
+}
+
+int DomLevelsModel::rotationFor(const QVector<Row> &rows) const
+{
+    // k > 0: new row i is old row i + k (prices moved down the ladder);
+    // k < 0: new row i - k is old row i. Only shifts of up to half the rows
+    // are worth a move; past that most rows change anyway.
+    const int n = m_rows.size();
+    if (n < 2 || rows.size() != n || rows.first().price == m_rows.first().price) {
+        return 0;
+    }
+    for (int k = 1; k <= n / 2; ++k) {
+        if (m_rows[k].price == rows[0].price && m_rows[n - 1].price == rows[n - 1 - k].price) {
+            return k;
+        }
+        if (rows[k].price == m_rows[0].price && rows[n - 1].price == m_rows[n - 1 - k].price) {
+            return -k;
+        }
+    }
+    return 0;
+}
+
+void DomLevelsModel::rotate(int k)
+{
+    const int n = m_rows.size();
+    if (k > 0) {
+        // The k rows scrolled off the top are recycled at the bottom.
+        beginMoveRows(QModelIndex(), 0, k - 1, QModelIndex(), n);
+        std::rotate(m_rows.begin(), m_rows.begin() + k, m_rows.end());
+    } else {
+        beginMoveRows(QModelIndex(), n + k, n - 1, QModelIndex(), 0);
+        std::rotate(m_rows.begin(), m_rows.end() + k, m_rows.end());
+    }
+    endMoveRows();
+}
+
+const QVector<int> &DomLevelsModel::rolesFor(quint32 mask)
+{
+    auto it = m_roleSets.find(mask);
+    if (it == m_roleSets.end()) {
+        QVector<int> roles;
+        for (int role = PriceRole; role <= OrderHighlightRole; ++role) {
+            if (mask & (quint32(1) << (role - PriceRole))) {
+                roles.append(role);
+            }
+        }
+        it = m_roleSets.insert(mask, roles);
+    }
+    return it.value();
+}
+
 void DomLevelsModel::setRows(QVector<Row> rows)
 {
     if (rows.size() != m_rows.size()) {
@@ -87,47 +159,28 @@ void DomLevelsModel::setRows(QVector<Row> rows)
         endResetModel();
         return;
     }
-    QVector<int> changed;
-    changed.reserve(rows.size());
-    for (int i = 0; i < rows.size(); ++i) {
-        if (rows[i] != m_rows[i]) {
-            m_rows[i] = rows[i];
-            changed.append(i);
-        }
+    if (const int k = rotationFor(rows)) {
+        rotate(k);
     }
-    int rangeStart = -1;
-    int last = -1;
-    const QVector<int> roles = {
-        PriceRole,
-        BidQtyRole,
-        AskQtyRole,
-        PriceTextRole,
-        BookColorRole,
-        PriceBgColorRole,
-        VolumeTextRole,
-        VolumeTextColorRole,
-        VolumeFillColorRole,
-        VolumeFillRatioRole,
-        MarkerTextRole,
-        MarkerFillColorRole,
-        MarkerBorderColorRole,
-        MarkerBuyRole,
-        OrderHighlightRole};
-    for (int idx : changed) {
-        if (rangeStart < 0) {
-            rangeStart = last = idx;
-        } else if (idx == last + 1) {
-            last = idx;
-        } else {
-            const QModelIndex top = createIndex(rangeStart, 0);
-            const QModelIndex bottom = createIndex(last, 0);
-            emit dataChanged(top, bottom, roles);
-            rangeStart = last = idx;
-        }
+
+    const int n = rows.size();
+    m_changed.resize(n);
+    for (int i = 0; i < n; ++i) {
+        m_changed[i] = changedRoles(m_rows[i], rows[i]);
     }
-    if (rangeStart >= 0) {
-        const QModelIndex top = createIndex(rangeStart, 0);
-        const QModelIndex bottom = createIndex(last, 0);
-        emit dataChanged(top, bottom, roles);
+    m_rows = std::move(rows);
+
+    // Runs of adjacent rows with the same changed roles share one signal.
+    int i = 0;
+    while (i < n) {
+        const quint32 mask = m_changed[i];
+        int last = i;
+        while (last + 1 < n && m_changed[last + 1] == mask) {
+            ++last;
+        }
+        if (mask != 0) {
+            emit dataChanged(createIndex(i, 0), createIndex(last, 0), rolesFor(mask));
+        }
+        i = last + 1;
     }
 }
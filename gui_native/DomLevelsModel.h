@@ -2,6 +2,7 @@
 
 #include <QAbstractListModel>
 #include <QColor>
+#include <QHash>
 #include <QVector>
 #include <QtMath>
 
@@ -27,26 +28,6 @@ public:
     };
 
     struct Row {
-        bool operator==(const Row &other) const
-        {
-            return price == other.price &&
-                   bidQty == other.bidQty &&
-                   askQty == other.askQty &&
-                   priceText == other.priceText &&
-                   bookColor == other.bookColor &&
-                   priceBgColor == other.priceBgColor &&
-                   volumeText == other.volumeText &&
-                   volumeTextColor == other.volumeTextColor &&
-                   volumeFillColor == other.volumeFillColor &&
-                   qFuzzyCompare(1.0 + volumeFillRatio, 1.0 + other.volumeFillRatio) &&
-                   markerText == other.markerText &&
-                   markerFillColor == other.markerFillColor &&
-                   markerBorderColor == other.markerBorderColor &&
-                   markerBuy == other.markerBuy &&
-                   orderHighlight == other.orderHighlight;
-        }
-        bool operator!=(const Row &other) const { return !(*this == other); }
-
         double price = 0.0;
         double bidQty = 0.0;
         double askQty = 0.0;
@@ -70,8 +51,19 @@ public:
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
     QHash<int, QByteArray> roleNames() const override;
 
+    // Same row count: rows the window scrolled past are signalled as a move,
+    // then each changed row gets dataChanged for the roles that differ only,
+    // so QML re-evaluates just those bindings (a pure quantity update leaves
+    // the price text and colors alone).
     void setRows(QVector<Row> rows);
 
 private:
+    static quint32 changedRoles(const Row &a, const Row &b);
+    int rotationFor(const QVector<Row> &rows) const;
+    void rotate(int k);
+    const QVector<int> &rolesFor(quint32 mask);
+
     QVector<Row> m_rows;
+    QVector<quint32> m_changed;              // per-row role mask, reused
+    QHash<quint32, QVector<int>> m_roleSets; // role lists per mask, built once
 };
@@ -8,5 +8,12 @@ struct VolumeHighlightRule {
     QColor color = QColor();
 };
 
+// How DomWidget draws its rows: QML ListView delegates over DomLevelsModel, or
+// the batched DomLadderItem scene-graph renderer.
+enum class DomRenderMode {
+    Qml = 0,
+    SceneGraph = 1
+};
+
 Q_DECLARE_METATYPE(VolumeHighlightRule)
 Q_DECLARE_METATYPE(QVector<VolumeHighlightRule>)
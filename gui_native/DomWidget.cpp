@@ -11,6 +11,7 @@
 #include <QPolygon>
 #include <QQuickWidget>
 #include <QQuickItem>
+#include <QQuickWindow>
 #include <QQmlContext>
 #include <QScrollBar>
 #include <QResizeEvent>
@@ -201,6 +202,11 @@ double priceTolerance(double tick)
     return 1e-8;
 }
 
+void smoothCost(double &average, double sample)
+{
+    average = average > 0.0 ? 0.8 * average + 0.2 * sample : sample;
+}
+
 struct BestBucketTicks {
     bool hasBid = false;
     bool hasAsk = false;
@@ -298,7 +304,19 @@ DomWidget::DomWidget(QWidget *parent)
 
 void DomWidget::updateSnapshot(const DomSnapshot &snapshot)
 {
-    m_pendingSnapshot = snapshot;
+    // Copy into the pending buffer's own storage rather than sharing the
+    // caller's levels: the caller refills them next frame, and a shared
+    // QVector would detach (allocate) on that write.
+    if (&snapshot != &m_pendingSnapshot) {
+        m_pendingSnapshot.levels.resize(snapshot.levels.size());
+        std::copy(snapshot.levels.cbegin(), snapshot.levels.cend(), m_pendingSnapshot.levels.begin());
+        m_pendingSnapshot.bestBid = snapshot.bestBid;
+        m_pendingSnapshot.bestAsk = snapshot.bestAsk;
+        m_pendingSnapshot.tickSize = snapshot.tickSize;
+        m_pendingSnapshot.minTick = snapshot.minTick;
+        m_pendingSnapshot.maxTick = snapshot.maxTick;
+        m_pendingSnapshot.compression = snapshot.compression;
+    }
     m_hasPendingSnapshot = true;
 
     if (m_snapshotUpdateScheduled) {
@@ -315,7 +333,9 @@ void DomWidget::applyPendingSnapshot()
         return;
     }
     m_hasPendingSnapshot = false;
-    m_snapshot = m_pendingSnapshot;
+    // The old levels become the next pending buffer.
+    std::swap(m_snapshot, m_pendingSnapshot);
+    rebuildDepthIndex();
 
     const int rows = m_snapshot.levels.size();
     const int rowHeight = m_rowHeight;
@@ -428,21 +448,11 @@ void DomWidget::centerToSpread()
         return;
     }
 
-    const int rows = m_snapshot.levels.size();
-    if (rows <= 0) {
+    const int bestRow = rowForPrice(centerPrice);
+    if (bestRow < 0) {
         return;
     }
 
-    int bestRow = 0;
-    double bestDist = std::numeric_limits<double>::max();
-    for (int i = 0; i < rows; ++i) {
-        double d = std::abs(m_snapshot.levels[i].price - centerPrice);
-        if (d < bestDist) {
-            bestDist = d;
-            bestRow = i;
-        }
-    }
-
     const int centerPixel = bestRow * m_rowHeight + m_rowHeight / 2;
     const int viewportHeight = area->viewport()->height();
     int value = centerPixel - viewportHeight / 2;
@@ -495,17 +505,13 @@ void DomWidget::paintEvent(QPaintEvent *event)
     const int lastRow = std::min(rows - 1, static_cast<int>(clipRect.bottom() / rowHeight));
 
     // Подбираем ширину колонки по реально отображаемым ценам.
+    syncPriceLabels(fm);
     int maxPriceWidth = 0;
     for (int i = firstRow; i <= lastRow; ++i) {
-        const auto &lvl = m_snapshot.levels[i];
-        const QString text =
-            (lvl.tick != 0) ? formatPriceForDisplayFromTick(lvl.tick, m_snapshot.tickSize)
-                            : formatPriceForDisplay(lvl.price, m_snapshot.tickSize);
-        maxPriceWidth = std::max(maxPriceWidth, fm.horizontalAdvance(text));
+        maxPriceWidth = std::max(maxPriceWidth, priceLabel(m_snapshot.levels[i], fm).width);
     }
     // Резерв под сжатый формат малых цен "(3)12345".
-    const QString tinySample = QStringLiteral("(5)12345");
-    maxPriceWidth = std::max(maxPriceWidth, fm.horizontalAdvance(tinySample));
+    maxPriceWidth = std::max(maxPriceWidth, m_tinyPriceSampleWidth);
     const int priceColWidth = std::clamp(maxPriceWidth + 8, 52, std::max(60, w / 3));
     const int priceRight = w - 1;
     const int priceLeft = std::max(0, priceRight - priceColWidth);
@@ -665,9 +671,8 @@ void DomWidget::paintEvent(QPaintEvent *event)
         }
 
         // Price text with leading-zero compaction.
-        const QString text =
-            (lvl.tick != 0) ? formatPriceForDisplayFromTick(lvl.tick, m_snapshot.tickSize)
-                            : formatPriceForDisplay(lvl.price, m_snapshot.tickSize);
+        const PriceLabel &label = priceLabel(lvl, fm);
+        const QString text = label.text;
         if (isPositionPriceRow) {
             QFont bold = font();
             bold.setBold(true);
@@ -680,8 +685,7 @@ void DomWidget::paintEvent(QPaintEvent *event)
             p.setPen(m_style.text);
             p.setFont(font());
         }
-        int textWidth = fm.horizontalAdvance(text);
-        int textX = priceRight - textWidth - 2;
+        int textX = priceRight - label.width - 2;
         int textY = y + fm.ascent() + (static_cast<int>(rowHeight) - fm.height()) / 2;
         p.drawText(textX, textY, text);
         if (isPositionPriceRow) {
@@ -1008,48 +1012,61 @@ void DomWidget::updateHoverInfo(int row)
     }
 }
 
-double DomWidget::cumulativeNotionalForRow(int row) const
+void DomWidget::rebuildDepthIndex()
 {
-    if (row < 0 || row >= m_snapshot.levels.size()) {
-        return 0.0;
-    }
-    if (m_snapshot.bestBid <= 0.0 && m_snapshot.bestAsk <= 0.0) {
-        return 0.0;
-    }
+    // Levels run top to bottom in descending price, as buildSnapshot writes them.
+    const int rows = m_snapshot.levels.size();
+    m_bidNotionalPrefix.resize(rows + 1);
+    m_askNotionalPrefix.resize(rows + 1);
+    m_bidNotionalPrefix[0] = 0.0;
+    m_askNotionalPrefix[0] = 0.0;
+    m_bestBidRow = -1;
+    m_bestAskRow = -1;
+    m_rowTicks = rows >= 2 ? m_snapshot.levels[0].tick - m_snapshot.levels[1].tick : 0;
 
-    const DomLevel &target = m_snapshot.levels[row];
     const double tol = priceTolerance(m_snapshot.tickSize);
-    const double targetPrice = target.price;
-    double total = 0.0;
-
-    if (m_snapshot.bestBid > 0.0 && targetPrice <= m_snapshot.bestBid + tol) {
-        const double lower = std::min(targetPrice, m_snapshot.bestBid);
-        const double upper = std::max(targetPrice, m_snapshot.bestBid);
-        for (const DomLevel &lvl : m_snapshot.levels) {
-            if (lvl.bidQty <= 0.0) {
-                continue;
-            }
-            if (lvl.price >= lower - tol && lvl.price <= upper + tol) {
-                total += lvl.bidQty * std::abs(lvl.price);
-            }
+    const double bidLimit = m_snapshot.bestBid + tol;
+    const double askLimit = m_snapshot.bestAsk - tol;
+    double bid = 0.0;
+    double ask = 0.0;
+    for (int i = 0; i < rows; ++i) {
+        const DomLevel &lvl = m_snapshot.levels[i];
+        if (lvl.bidQty > 0.0) {
+            bid += lvl.bidQty * std::abs(lvl.price);
         }
-        return total;
-    }
-
-    if (m_snapshot.bestAsk > 0.0 && targetPrice >= m_snapshot.bestAsk - tol) {
-        const double lower = std::min(targetPrice, m_snapshot.bestAsk);
-        const double upper = std::max(targetPrice, m_snapshot.bestAsk);
-        for (const DomLevel &lvl : m_snapshot.levels) {
-            if (lvl.askQty <= 0.0) {
-                continue;
-            }
-            if (lvl.price >= lower - tol && lvl.price <= upper + tol) {
-                total += lvl.askQty * std::abs(lvl.price);
-            }
+        if (lvl.askQty > 0.0) {
+            ask += lvl.askQty * std::abs(lvl.price);
+        }
+        m_bidNotionalPrefix[i + 1] = bid;
+        m_askNotionalPrefix[i + 1] = ask;
+        if (m_snapshot.bestBid > 0.0 && m_bestBidRow < 0 && lvl.price <= bidLimit) {
+            m_bestBidRow = i;
         }
-        return total;
+        if (m_snapshot.bestAsk > 0.0 && lvl.price >= askLimit) {
+            m_bestAskRow = i;
+        }
+        if (i > 0 && m_snapshot.levels[i - 1].tick - lvl.tick != m_rowTicks) {
+            m_rowTicks = 0;
+        }
+    }
+    if (m_rowTicks < 0) {
+        m_rowTicks = 0;
     }
+}
 
+double DomWidget::cumulativeNotionalForRow(int row) const
+{
+    if (row < 0 || row >= m_snapshot.levels.size()) {
+        return 0.0;
+    }
+    // Bid rows sum from the best bid down to `row`, ask rows from `row` down
+    // to the best ask.
+    if (m_bestBidRow >= 0 && row >= m_bestBidRow) {
+        return m_bidNotionalPrefix[row + 1] - m_bidNotionalPrefix[m_bestBidRow];
+    }
+    if (m_bestAskRow >= 0 && row <= m_bestAskRow) {
+        return m_askNotionalPrefix[m_bestAskRow + 1] - m_askNotionalPrefix[row];
+    }
     return 0.0;
 }
 
@@ -1141,11 +1158,55 @@ void DomWidget::handleRowHover(int row)
     }
 }
 
+void DomWidget::syncPriceLabels(const QFontMetrics &fm)
+{
+    const QFont &f = font();
+    if (m_snapshot.tickSize != m_priceLabelTickSize || m_snapshot.compression != m_priceLabelCompression
+        || f != m_priceLabelFont) {
+        m_priceLabels.clear();
+        m_priceLabelTickSize = m_snapshot.tickSize;
+        m_priceLabelCompression = m_snapshot.compression;
+        m_priceLabelFont = f;
+        m_tinyPriceSampleWidth = fm.horizontalAdvance(QStringLiteral("(5)12345"));
+    }
+    // Hold at least two windows of rows so one frame never evicts its own labels.
+    const int wanted = std::max(kPriceLabelCacheSize, 2 * static_cast<int>(m_snapshot.levels.size()));
+    if (m_priceLabels.maxCost() < wanted) {
+        m_priceLabels.setMaxCost(wanted);
+    }
+}
+
+const DomWidget::PriceLabel &DomWidget::priceLabel(const DomLevel &lvl, const QFontMetrics &fm)
+{
+    if (lvl.tick == 0) {
+        m_untickedPriceLabel.text = formatPriceForDisplay(lvl.price, m_snapshot.tickSize);
+        m_untickedPriceLabel.width = fm.horizontalAdvance(m_untickedPriceLabel.text);
+        return m_untickedPriceLabel;
+    }
+    if (PriceLabel *cached = m_priceLabels.object(lvl.tick)) {
+        return *cached;
+    }
+    auto *label = new PriceLabel;
+    label->text = formatPriceForDisplayFromTick(lvl.tick, m_snapshot.tickSize);
+    label->width = fm.horizontalAdvance(label->text);
+    m_priceLabels.insert(lvl.tick, label);
+    return *label;
+}
+
 int DomWidget::rowForPrice(double price) const
 {
-    if (m_snapshot.levels.isEmpty()) {
+    const int rows = m_snapshot.levels.size();
+    if (rows == 0) {
         return -1;
     }
+    if (m_rowTicks > 0 && m_snapshot.tickSize > 0.0) {
+        // Nearest row; an exact midpoint goes to the upper row.
+        const double step = static_cast<double>(m_rowTicks) * m_snapshot.tickSize;
+        const double offset = (m_snapshot.levels[0].price - price) / step;
+        if (std::isfinite(offset)) {
+            return static_cast<int>(std::clamp(std::ceil(offset - 0.5), 0.0, static_cast<double>(rows - 1)));
+        }
+    }
     int closest = 0;
     double bestDist = std::numeric_limits<double>::max();
     for (int i = 0; i < m_snapshot.levels.size(); ++i) {
@@ -1174,11 +1235,31 @@ void DomWidget::ensureQuickInitialized()
             this,
             [this](QQuickWidget::Status status) {
                 m_quickReady = (status == QQuickWidget::Ready);
+                m_ladderItem = nullptr;
                 if (m_quickReady) {
                     syncQuickProperties();
                     updateQuickSnapshot();
                 }
             });
+    // QQuickWidget polishes, syncs and renders on the GUI thread, so this span
+    // is GUI time the ladder costs per frame in either render mode.
+    if (QQuickWindow *window = m_quickWidget->quickWindow()) {
+        connect(window, &QQuickWindow::beforeSynchronizing, this, [this]() {
+            m_sceneFrameTimer.start();
+        }, Qt::DirectConnection);
+        connect(window, &QQuickWindow::afterRendering, this, [this]() {
+            if (!m_sceneFrameTimer.isValid()) {
+                return;
+            }
+            double us = static_cast<double>(m_sceneFrameTimer.nsecsElapsed()) / 1000.0;
+            m_sceneFrameTimer.invalidate();
+            if (m_ladderItem) {
+                us += static_cast<double>(m_ladderItem->takePolishNs()) / 1000.0;
+            }
+            smoothCost(m_sceneCostUs, us);
+            m_frameCostUs = m_snapshotCostUs + m_sceneCostUs;
+        }, Qt::DirectConnection);
+    }
     m_quickWidget->setSource(QUrl(QStringLiteral("qrc:/qml/GpuDomView.qml")));
     m_quickWidget->setGeometry(rect());
 }
@@ -1292,10 +1373,34 @@ void DomWidget::syncQuickProperties()
                                                                        : font().pointSize() + 2);
         root->setProperty("domBridge", QVariant::fromValue(static_cast<QObject *>(this)));
         root->setProperty("levelsModel", QVariant::fromValue(static_cast<QObject *>(&m_levelsModel)));
+        root->setProperty("nativeRenderer", m_renderMode == DomRenderMode::SceneGraph);
+        if (!m_ladderItem) {
+            m_ladderItem = root->findChild<DomLadderItem *>(QStringLiteral("domLadder"));
+        }
         updateQuickOverlayProperties();
     }
 }
 
+void DomWidget::setRenderMode(DomRenderMode mode)
+{
+    if (mode == m_renderMode) {
+        return;
+    }
+    m_renderMode = mode;
+    m_snapshotCostUs = 0.0;
+    m_sceneCostUs = 0.0;
+    m_frameCostUs = 0.0;
+    // Drop the inactive path's rows so it holds no delegates or geometry.
+    if (mode == DomRenderMode::SceneGraph) {
+        m_levelsModel.setRows(QVector<DomLevelsModel::Row>());
+    } else if (m_ladderItem) {
+        m_ladderItem->clearRows();
+    }
+    syncQuickProperties();
+    m_snapshotThrottle.invalidate();
+    updateQuickSnapshot();
+}
+
 void DomWidget::updateQuickSnapshot()
 {
     if (!m_quickWidget || !m_quickReady) {
@@ -1303,7 +1408,18 @@ void DomWidget::updateQuickSnapshot()
     }
     if (auto *root = m_quickWidget->rootObject()) {
         if (m_snapshotThrottle.isValid()) {
-            if (m_snapshotThrottle.nsecsElapsed() < kMinSnapshotIntervalNs) {
+            const qint64 elapsedNs = m_snapshotThrottle.nsecsElapsed();
+            if (elapsedNs < kMinSnapshotIntervalNs) {
+                // Deferred, not dropped: MainWindow only pulls again on new
+                // data, so a throttled last update would otherwise stay unseen.
+                if (!m_snapshotRetryScheduled) {
+                    m_snapshotRetryScheduled = true;
+                    const int delayMs = static_cast<int>((kMinSnapshotIntervalNs - elapsedNs) / 1000000) + 1;
+                    QTimer::singleShot(delayMs, this, [this]() {
+                        m_snapshotRetryScheduled = false;
+                        updateQuickSnapshot();
+                    });
+                }
                 return;
             }
             m_snapshotThrottle.restart();
@@ -1312,30 +1428,30 @@ void DomWidget::updateQuickSnapshot()
         }
         const auto &levels = m_snapshot.levels;
         const int rowsCount = levels.size();
+        const bool native = m_renderMode == DomRenderMode::SceneGraph && m_ladderItem;
         if (rowsCount <= 0) {
-            m_levelsModel.setRows(QVector<DomLevelsModel::Row>());
+            if (native) {
+                m_ladderItem->clearRows();
+            } else {
+                m_levelsModel.setRows(QVector<DomLevelsModel::Row>());
+            }
             return;
         }
+        QElapsedTimer costTimer;
+        costTimer.start();
 
+        // Prices come from the label cache: a frame over ticks it has seen
+        // formats and measures nothing.
         QFontMetrics fm(font());
+        syncPriceLabels(fm);
         int maxPriceWidth = 0;
-        for (const auto &lvl : levels) {
-            const QString text =
-                (lvl.tick != 0) ? formatPriceForDisplayFromTick(lvl.tick, m_snapshot.tickSize)
-                                : formatPriceForDisplay(lvl.price, m_snapshot.tickSize);
-            maxPriceWidth = std::max(maxPriceWidth, fm.horizontalAdvance(text));
-        }
-        const QString tinySample = QStringLiteral("(5)12345");
-        maxPriceWidth = std::max(maxPriceWidth, fm.horizontalAdvance(tinySample));
-        const int w = std::max(1, width());
-        const int priceColWidth = std::clamp(maxPriceWidth + 8, 52, std::max(60, w / 3));
-        if (priceColWidth != m_cachedPriceColumnWidth) {
-            root->setProperty("priceColumnWidth", priceColWidth);
-            m_cachedPriceColumnWidth = priceColWidth;
-        }
 
         QVector<DomLevelsModel::Row> rows;
-        rows.reserve(rowsCount);
+        if (native) {
+            m_ladderRows.resize(rowsCount);
+        } else {
+            rows.reserve(rowsCount);
+        }
         const double bestPriceTolerance = priceTolerance(m_snapshot.tickSize);
         const double tick = m_snapshot.tickSize > 0.0 ? m_snapshot.tickSize : 0.0;
         const BestBucketTicks bestTicks = bestBucketTicksForSnapshot(m_snapshot);
@@ -1384,8 +1500,25 @@ void DomWidget::updateQuickSnapshot()
             }
         }
 
-        for (const auto &lvl : levels) {
-            DomLevelsModel::Row row;
+        // Text markers are placed by row once instead of testing every marker on every row.
+        // The first marker in list order wins a row, as before.
+        QHash<int, int> textMarkerByRow;
+        for (int m = 0; m < m_priceTextMarkers.size(); ++m) {
+            const PriceTextMarker &marker = m_priceTextMarkers[m];
+            if (!(marker.price > 0.0) || marker.text.trimmed().isEmpty()) {
+                continue;
+            }
+            const int row = rowForPrice(marker.price);
+            if (row < 0 || std::abs(levels[row].price - marker.price) > bestPriceTolerance) {
+                continue;
+            }
+            if (!textMarkerByRow.contains(row)) {
+                textMarkerByRow.insert(row, m);
+            }
+        }
+
+        for (int i = 0; i < rowsCount; ++i) {
+            const DomLevel &lvl = levels[i];
             const double bidQty = lvl.bidQty;
             const double askQty = lvl.askQty;
             const bool hasBid = bidQty > 0.0;
@@ -1464,34 +1597,45 @@ void DomWidget::updateQuickSnapshot()
                 }
             }
 
-            if (!m_priceTextMarkers.isEmpty()) {
-                for (const auto &marker : m_priceTextMarkers) {
-                    if (!(marker.price > 0.0)) {
-                        continue;
-                    }
-                    if (std::abs(lvl.price - marker.price) > bestPriceTolerance) {
-                        continue;
-                    }
-                    const QString t = marker.text.trimmed();
-                    if (t.isEmpty()) {
-                        continue;
-                    }
-                    qtyText = t;
-                    volumeRatio = 1.0;
-                    QColor fill = marker.fillColor.isValid() ? marker.fillColor : QColor("#ffffff");
-                    if (fill.isValid() && fill.alpha() == 255) {
-                        fill.setAlpha(220);
-                    }
-                    volumeFillColor = fill;
-                    volumeTextColor = marker.textColor.isValid() ? marker.textColor : QColor("#ffffff");
-                    break;
+            const auto textMarker = textMarkerByRow.constFind(i);
+            if (textMarker != textMarkerByRow.constEnd()) {
+                const PriceTextMarker &marker = m_priceTextMarkers[textMarker.value()];
+                qtyText = marker.text.trimmed();
+                volumeRatio = 1.0;
+                QColor fill = marker.fillColor.isValid() ? marker.fillColor : QColor("#ffffff");
+                if (fill.isValid() && fill.alpha() == 255) {
+                    fill.setAlpha(220);
                 }
+                volumeFillColor = fill;
+                volumeTextColor = marker.textColor.isValid() ? marker.textColor : QColor("#ffffff");
+            }
+
+            const PriceLabel &priceLabelForRow = priceLabel(lvl, fm);
+            const QString priceText = priceLabelForRow.text;
+            maxPriceWidth = std::max(maxPriceWidth, priceLabelForRow.width);
+            const auto marker = markerByTick.constFind(lvl.tick);
+            const bool hasMarker = marker != markerByTick.constEnd() && marker->notional > 0.0;
+            const bool orderHighlight =
+                hasMarker || (!highlightTicks.isEmpty() && highlightTicks.contains(lvl.tick));
+
+            if (native) {
+                // Written in place: the storage is the item's previous frame.
+                DomLadderRow &out = m_ladderRows[i];
+                out.price = lvl.price;
+                out.priceText = priceText;
+                out.volumeText = qtyText;
+                out.bookColor = bookColor.rgba();
+                out.priceBgColor = priceColor.rgba();
+                out.volumeFillColor = volumeFillColor.rgba();
+                out.volumeTextColor = volumeTextColor.rgba();
+                out.volumeFillRatio = volumeRatio;
+                out.orderHighlight = orderHighlight;
+                continue;
             }
 
+            DomLevelsModel::Row row;
             row.price = lvl.price;
-            row.priceText =
-                (lvl.tick != 0) ? formatPriceForDisplayFromTick(lvl.tick, tick)
-                                : formatPriceForDisplay(lvl.price, tick);
+            row.priceText = priceText;
             row.bidQty = bidQty;
             row.askQty = askQty;
             row.bookColor = bookColor;
@@ -1501,24 +1645,35 @@ void DomWidget::updateQuickSnapshot()
             row.volumeFillRatio = volumeRatio;
             row.volumeFillColor = volumeFillColor;
 
-            if (!markerByTick.isEmpty()) {
-                const auto it = markerByTick.constFind(lvl.tick);
-                if (it != markerByTick.constEnd() && it->notional > 0.0) {
-                    row.markerText = formatQty(it->notional);
-                    row.markerBuy = it->buy;
-                    QColor fill = it->buy ? m_style.bid : m_style.ask;
-                    fill.setAlpha(240);
-                    QColor border = fill;
-                    border = it->buy ? border.darker(150) : border.darker(170);
-                    border.setAlpha(240);
-                    row.markerFillColor = fill;
-                    row.markerBorderColor = border;
-                }
+            if (hasMarker) {
+                row.markerText = formatQty(marker->notional);
+                row.markerBuy = marker->buy;
+                QColor fill = marker->buy ? m_style.bid : m_style.ask;
+                fill.setAlpha(240);
+                QColor border = fill;
+                border = marker->buy ? border.darker(150) : border.darker(170);
+                border.setAlpha(240);
+                row.markerFillColor = fill;
+                row.markerBorderColor = border;
             }
-            row.orderHighlight = (!row.markerText.isEmpty()) || (!highlightTicks.isEmpty() && highlightTicks.contains(lvl.tick));
+            row.orderHighlight = orderHighlight;
 
             rows.append(row);
         }
-        m_levelsModel.setRows(std::move(rows));
+
+        maxPriceWidth = std::max(maxPriceWidth, m_tinyPriceSampleWidth);
+        const int w = std::max(1, width());
+        const int priceColWidth = std::clamp(maxPriceWidth + 8, 52, std::max(60, w / 3));
+        if (priceColWidth != m_cachedPriceColumnWidth) {
+            root->setProperty("priceColumnWidth", priceColWidth);
+            m_cachedPriceColumnWidth = priceColWidth;
+        }
+        if (native) {
+            m_ladderItem->swapRows(m_ladderRows);
+        } else {
+            m_levelsModel.setRows(std::move(rows));
+        }
+        smoothCost(m_snapshotCostUs, static_cast<double>(costTimer.nsecsElapsed()) / 1000.0);
+        m_frameCostUs = m_snapshotCostUs + m_sceneCostUs;
     }
 }
@@ -2,6 +2,8 @@
 
 #include <QWidget>
 #include <QVector>
+#include <QCache>
+#include <QFont>
 #include <QString>
 #include <QVariant>
 #include <QElapsedTimer>
@@ -9,6 +11,7 @@
 #include "DomTypes.h"
 #include "TradeTypes.h"
 #include "DomLevelsModel.h"
+#include "DomLadderItem.h"
 
 class QMouseEvent;
 class QEvent;
@@ -16,6 +19,7 @@ class QQuickWidget;
 class QQuickItem;
 class QFrame;
 class QLabel;
+class QFontMetrics;
 
 struct DomLevel {
     qint64 tick = 0;
@@ -80,6 +84,11 @@ public:
     void setHighlightPrices(const QVector<double> &prices);
     void setPriceTextMarkers(const QVector<PriceTextMarker> &markers);
     void setActionOverlayText(const QString &text);
+    void setRenderMode(DomRenderMode mode);
+    DomRenderMode renderMode() const { return m_renderMode; }
+    // Smoothed GUI-thread cost of one ladder update: building the rows plus
+    // the Quick scene polish/sync/render that follows.
+    double frameCostUs() const { return m_frameCostUs; }
     Q_INVOKABLE void handleRowClick(int row, int button, double price, double bidQty, double askQty);
     Q_INVOKABLE void handleRowClickIndex(int row, int button);
     Q_INVOKABLE void handleRowHover(int row);
@@ -125,12 +134,45 @@ private:
     QLabel *m_actionOverlayLabel = nullptr;
     QWidget *m_actionOverlayParent = nullptr;
     QElapsedTimer m_snapshotThrottle;
+    bool m_snapshotRetryScheduled = false;
     static constexpr qint64 kMinSnapshotIntervalNs = 8000000; // ~120 Гц
     DomLevelsModel m_levelsModel;
+    DomRenderMode m_renderMode = DomRenderMode::Qml;
+    DomLadderItem *m_ladderItem = nullptr;
+    QVector<DomLadderRow> m_ladderRows;
+    QElapsedTimer m_sceneFrameTimer;
+    double m_snapshotCostUs = 0.0;
+    double m_sceneCostUs = 0.0;
+    double m_frameCostUs = 0.0;
     int m_cachedTotalHeight = -1;
     int m_cachedPriceColumnWidth = -1;
 
+    // Rebuilt once per applied snapshot, so hover totals and price→row
+    // lookups do not scan the levels. Prefix [i] covers rows [0, i).
+    QVector<double> m_bidNotionalPrefix;
+    QVector<double> m_askNotionalPrefix;
+    int m_bestBidRow = -1; // first row at or below bestBid
+    int m_bestAskRow = -1; // last row at or above bestAsk
+    qint64 m_rowTicks = 0; // tick step between rows; 0 if the rows are not evenly spaced
+
+    // Formatted and measured price per tick, for the current tick size,
+    // compression and font. Least recently used entries are evicted.
+    struct PriceLabel {
+        QString text;
+        int width = 0;
+    };
+    static constexpr int kPriceLabelCacheSize = 4096;
+    QCache<qint64, PriceLabel> m_priceLabels{kPriceLabelCacheSize};
+    double m_priceLabelTickSize = -1.0; // no tick size yet: the first sync resets
+    qint64 m_priceLabelCompression = 0;
+    QFont m_priceLabelFont;
+    PriceLabel m_untickedPriceLabel;
+    int m_tinyPriceSampleWidth = 0; // "(5)12345", the column's minimum content
+
     void updateHoverInfo(int row);
+    void rebuildDepthIndex();
+    void syncPriceLabels(const QFontMetrics &fm);
+    const PriceLabel &priceLabel(const DomLevel &lvl, const QFontMetrics &fm);
     double cumulativeNotionalForRow(int row) const;
     int rowForPrice(double price) const;
     void ensureQuickInitialized();
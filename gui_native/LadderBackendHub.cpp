@@ -0,0 +1,481 @@
+#include "LadderBackendHub.h"
+#include "LadderClient.h"
+#include "LadderWire.hpp"
+
+#include <QCoreApplication>
+#include <QDebug>
+
+#include <algorithm>
+#include <utility>
+
+using json = nlohmann::json;
+
+namespace {
+// MEXC allows 30 channels per connection and every book takes two (depth + deals).
+constexpr int kMexcMaxBooks = 15;
+constexpr int kBinanceMaxBooks = 100;
+// Coalesces the burst of attach() calls when a workspace opens many ladders.
+constexpr int kMembershipDebounceMs = 150;
+constexpr int kCrashRestartDelayMs = 700;
+
+int maxBooksFor(const QString &exchange)
+{
+    return exchange == QStringLiteral("mexc") ? kMexcMaxBooks : kBinanceMaxBooks;
+}
+
+QString exchangeFromArgs(const QStringList &args)
+{
+    const int idx = args.indexOf(QStringLiteral("--exchange"));
+    return (idx >= 0 && idx + 1 < args.size()) ? args.at(idx + 1) : QString();
+}
+
+int levelsFromArgs(const QStringList &args)
+{
+    const int idx = args.indexOf(QStringLiteral("--ladder-levels"));
+    return (idx >= 0 && idx + 1 < args.size()) ? args.at(idx + 1).toInt() : 0;
+}
+} // namespace
+
+LadderBackendHub *LadderBackendHub::instance()
+{
+    static LadderBackendHub *inst = new LadderBackendHub(qApp);
+    return inst;
+}
+
+LadderBackendHub::LadderBackendHub(QObject *parent)
+    : QObject(parent)
+{
+}
+
+bool LadderBackendHub::supportsExchange(const QString &exchange)
+{
+    return exchange == QStringLiteral("mexc")
+           || exchange == QStringLiteral("binance")
+           || exchange == QStringLiteral("binance_futures");
+}
+
+void LadderBackendHub::attach(LadderClient *client,
+                              const QString &backendPath,
+                              const QString &wireSymbol,
+                              const QStringList &commonArgs,
+                              const QString &shmKey)
+{
+    const QString key = backendPath + QLatin1Char('\n') + commonArgs.join(QLatin1Char('\n'));
+    int index = -1;
+    if (Group *current = groupFor(client, &index)) {
+        if (current->key == key) {
+            Member &m = current->members[index];
+            m.wireSymbol = wireSymbol;
+            m.shmKey = shmKey;
+            m.levels = 0;
+            if (isLive(current)) {
+                // The client made a new segment; the slot starts over with it.
+                json cmd;
+                cmd["cmd"] = "remove_book";
+                writeCommand(current, index, cmd);
+                addBook(current, index);
+                return;
+            }
+            stopProcess(current);
+            scheduleRestart(current, kMembershipDebounceMs);
+            return;
+        }
+        detach(client);
+    }
+
+    const QString exchange = exchangeFromArgs(commonArgs);
+    Group *group = groupWithRoom(key, exchange);
+    if (!group) {
+        m_groups.push_back(std::make_unique<Group>());
+        group = m_groups.back().get();
+        group->key = key;
+        group->exchange = exchange;
+        group->backendPath = backendPath;
+        group->commonArgs = commonArgs;
+        group->process.setProgram(backendPath);
+        group->process.setWorkingDirectory(QCoreApplication::applicationDirPath());
+        group->process.setProcessChannelMode(QProcess::SeparateChannels);
+        group->restartTimer.setSingleShot(true);
+        connect(&group->process, &QProcess::started, this, [this, group]() { sendMemberLevels(group); });
+        connect(&group->process, &QProcess::readyReadStandardOutput, this, [this, group]() {
+            handleStdout(group);
+        });
+        connect(&group->process, &QProcess::readyReadStandardError, this, [this, group]() {
+            handleStderr(group);
+        });
+        connect(&group->process,
+                QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+                this,
+                [this, group](int exitCode, QProcess::ExitStatus status) {
+                    handleFinished(group, exitCode, status);
+                });
+        connect(&group->process, &QProcess::errorOccurred, this, [group](QProcess::ProcessError error) {
+            if (error != QProcess::FailedToStart) {
+                return;
+            }
+            for (const Member &m : group->members) {
+                if (!m.client) {
+                    continue;
+                }
+                m.client->emitStatus(QStringLiteral("%1 Backend failed to start: %2")
+                                         .arg(m.client->formatBackendPrefix(), group->process.errorString()));
+            }
+        });
+        connect(&group->restartTimer, &QTimer::timeout, this, [this, group]() { startProcess(group); });
+    }
+
+    // A freed slot first, so book ids stay below the venue's cap.
+    const auto freeSlot = std::find_if(group->members.begin(), group->members.end(), [](const Member &m) {
+        return m.client == nullptr;
+    });
+    const int slot = freeSlot != group->members.end() ? static_cast<int>(freeSlot - group->members.begin())
+                                                      : static_cast<int>(group->members.size());
+    if (slot == group->members.size()) {
+        group->members.push_back(Member{});
+    }
+    Member &m = group->members[slot];
+    m = Member{};
+    m.client = client;
+    m.wireSymbol = wireSymbol;
+    m.shmKey = shmKey;
+    if (isLive(group)) {
+        addBook(group, slot);
+        return;
+    }
+    // Not running yet, or already being replaced: the (re)start takes it along.
+    stopProcess(group);
+    scheduleRestart(group, kMembershipDebounceMs);
+}
+
+void LadderBackendHub::detach(LadderClient *client)
+{
+    int index = -1;
+    Group *group = groupFor(client, &index);
+    if (!group) {
+        return;
+    }
+    // Output still in flight for the book id is dropped from here on.
+    group->members[index] = Member{};
+    if (occupiedCount(group) == 0) {
+        removeGroupIfEmpty(group);
+        return;
+    }
+    if (isLive(group)) {
+        json cmd;
+        cmd["cmd"] = "remove_book";
+        writeCommand(group, index, cmd);
+        return;
+    }
+    stopProcess(group);
+    scheduleRestart(group, kMembershipDebounceMs);
+}
+
+void LadderBackendHub::addBook(Group *group, int index)
+{
+    Member &m = group->members[index];
+    m.awaitingAdd = true;
+    json cmd;
+    cmd["cmd"] = "add_book";
+    cmd["symbol"] = m.wireSymbol.toStdString();
+    if (!m.shmKey.isEmpty()) {
+        cmd["shm"] = m.shmKey.toStdString();
+    }
+    writeCommand(group, index, cmd);
+    m.client->logBackendEvent(QStringLiteral("add_book %1 book=%2").arg(m.wireSymbol).arg(index));
+}
+
+bool LadderBackendHub::isRunning(const LadderClient *client) const
+{
+    const Group *group = groupFor(client);
+    return group && (group->process.state() != QProcess::NotRunning || group->restartTimer.isActive());
+}
+
+bool LadderBackendHub::sendCommand(const LadderClient *client, json cmd)
+{
+    int index = -1;
+    Group *group = groupFor(client, &index);
+    // An added book is not served until its marker; the client sends again.
+    if (!group || !isLive(group) || group->members.at(index).awaitingAdd) {
+        return false;
+    }
+    writeCommand(group, index, std::move(cmd));
+    return true;
+}
+
+void LadderBackendHub::writeCommand(Group *group, int index, json cmd)
+{
+    cmd["book"] = index;
+    const std::string payload = cmd.dump() + '\n';
+    group->process.write(payload.c_str(), static_cast<qint64>(payload.size()));
+}
+
+void LadderBackendHub::updateMember(const LadderClient *client, const QString &wireSymbol, int levels)
+{
+    int index = -1;
+    Group *group = groupFor(client, &index);
+    if (!group) {
+        return;
+    }
+    Member &m = group->members[index];
+    m.wireSymbol = wireSymbol;
+    m.levels = levels;
+}
+
+void LadderBackendHub::sendMemberLevels(Group *group)
+{
+    // The backend reads stdin only once every book is initialised, so these
+    // apply before the first live update.
+    const int groupLevels = levelsFromArgs(group->commonArgs);
+    for (int i = 0; i < group->members.size(); ++i) {
+        const int levels = group->members.at(i).levels;
+        if (levels <= 0 || levels == groupLevels) {
+            continue;
+        }
+        json cmd;
+        cmd["cmd"] = "set_levels";
+        cmd["levels"] = levels;
+        writeCommand(group, i, cmd);
+    }
+}
+
+LadderBackendHub::Group *LadderBackendHub::groupFor(const LadderClient *client, int *index) const
+{
+    for (const auto &group : m_groups) {
+        for (int i = 0; i < group->members.size(); ++i) {
+            if (group->members.at(i).client == client) {
+                if (index) {
+                    *index = i;
+                }
+                return group.get();
+            }
+        }
+    }
+    return nullptr;
+}
+
+LadderBackendHub::Group *LadderBackendHub::groupWithRoom(const QString &key, const QString &exchange)
+{
+    const int cap = maxBooksFor(exchange);
+    for (const auto &group : m_groups) {
+        if (group->key == key && occupiedCount(group.get()) < cap) {
+            return group.get();
+        }
+    }
+    return nullptr;
+}
+
+int LadderBackendHub::occupiedCount(const Group *group)
+{
+    return static_cast<int>(std::count_if(group->members.begin(), group->members.end(), [](const Member &m) {
+        return m.client != nullptr;
+    }));
+}
+
+bool LadderBackendHub::isLive(const Group *group)
+{
+    return !group->stopping && !group->restartTimer.isActive() && group->process.state() == QProcess::Running;
+}
+
+void LadderBackendHub::scheduleRestart(Group *group, int delayMs)
+{
+    group->restartTimer.start(delayMs);
+}
+
+void LadderBackendHub::stopProcess(Group *group)
+{
+    // Frames already buffered carry the old book ids; never route them.
+    group->buffer.clear();
+    group->startPending = false;
+    if (group->process.state() == QProcess::NotRunning) {
+        return;
+    }
+    // No waitForFinished(): handleFinished() clears `stopping` and runs a
+    // pending start, and handleStdout() drops the output in between.
+    group->stopping = true;
+    group->process.kill();
+}
+
+void LadderBackendHub::startProcess(Group *group)
+{
+    // A new process numbers its books afresh, so freed slots go.
+    group->members.erase(std::remove_if(group->members.begin(),
+                                        group->members.end(),
+                                        [](const Member &m) { return m.client == nullptr; }),
+                         group->members.end());
+    for (Member &m : group->members) {
+        m.awaitingAdd = false;
+    }
+    if (group->members.isEmpty()) {
+        return;
+    }
+    stopProcess(group);
+    if (group->stopping) {
+        group->startPending = true;
+        return;
+    }
+
+    QStringList symbols;
+    QStringList shmKeys;
+    bool anyShm = false;
+    for (const Member &m : group->members) {
+        symbols << m.wireSymbol;
+        shmKeys << (m.shmKey.isEmpty() ? QStringLiteral("-") : m.shmKey);
+        anyShm = anyShm || !m.shmKey.isEmpty();
+    }
+    QStringList args = group->commonArgs;
+    args << "--symbols" << symbols.join(QLatin1Char(','));
+    if (anyShm) {
+        args << "--shm" << shmKeys.join(QLatin1Char(','));
+    }
+    group->process.setArguments(args);
+
+    QStringList argsForLog = args;
+    for (int i = 0; i < argsForLog.size(); ++i) {
+        if (argsForLog.at(i) == QStringLiteral("--proxy") && i + 1 < argsForLog.size()) {
+            argsForLog[i + 1] = QStringLiteral("<redacted>");
+        }
+    }
+    qWarning() << "[LadderBackendHub] starting shared backend with args" << argsForLog;
+    for (const Member &m : group->members) {
+        m.client->logBackendEvent(QStringLiteral("start shared args=%1").arg(argsForLog.join(QLatin1Char(' '))));
+        m.client->armWatchdog();
+        m.client->forgetViewport();
+    }
+    group->process.start();
+}
+
+void LadderBackendHub::handleStdout(Group *group)
+{
+    const QByteArray chunk = group->process.readAllStandardOutput();
+    if (group->stopping) {
+        return;
+    }
+    group->buffer += chunk;
+
+    bool desync = false;
+    int failedAdd = -1;
+    const std::size_t consumed = dom::wire::consumeStream(
+        group->buffer.constData(),
+        static_cast<std::size_t>(group->buffer.size()),
+        [group](const dom::wire::FrameHeader &frame, const char *payload) {
+            // Only routing happens here; each client's ingest thread parses its frames.
+            if (frame.book < group->members.size()) {
+                const Member &m = group->members.at(frame.book);
+                if (m.client && !m.awaitingAdd) {
+                    m.client->feedIngest(payload - dom::wire::kFrameHeaderSize,
+                                         dom::wire::kFrameHeaderSize + frame.payloadSize);
+                }
+            }
+        },
+        [group, &failedAdd](const char *data, std::size_t length) {
+            const QByteArray line = QByteArray::fromRawData(data, static_cast<qsizetype>(length));
+            if (line.trimmed().isEmpty()) {
+                return;
+            }
+            // JSON lines are rare in binary mode; peek at "book" to route them.
+            const json j = json::parse(data, data + length, nullptr, false);
+            const int book = j.is_object() ? j.value("book", 0) : 0;
+            if (book < 0 || book >= group->members.size()) {
+                return;
+            }
+            Member &m = group->members[book];
+            if (!m.client) {
+                return;
+            }
+            if (m.awaitingAdd) {
+                // Only the add's own outcome counts; an older switch of the slot may precede it.
+                const std::string type = j.is_object() ? j.value("type", std::string()) : std::string();
+                const std::string symbol = j.is_object() ? j.value("symbol", std::string()) : std::string();
+                if (symbol != m.wireSymbol.toStdString()) {
+                    return;
+                }
+                if (type == "resubscribe_failed") {
+                    failedAdd = book;
+                    return;
+                }
+                if (type != "resubscribed") {
+                    return;
+                }
+                m.awaitingAdd = false;
+            }
+            // Include the '\n' consumeStream stopped at so the client sees a complete line.
+            m.client->feedIngest(data, length + 1);
+        },
+        desync);
+    if (failedAdd >= 0) {
+        // The books already streaming are fine, but a restart is the one path
+        // that is known to bring the new one up (or report why it cannot).
+        const Member &m = group->members.at(failedAdd);
+        m.client->emitStatus(QStringLiteral("%1 Could not add book, restarting shared backend")
+                                 .arg(m.client->formatBackendPrefix()));
+        stopProcess(group);
+        scheduleRestart(group, kMembershipDebounceMs);
+        return;
+    }
+    if (desync) {
+        qWarning() << "[LadderBackendHub] bad frame size - dropping buffered output";
+        group->buffer.clear();
+        return;
+    }
+    group->buffer.remove(0, static_cast<qsizetype>(consumed));
+}
+
+void LadderBackendHub::handleStderr(Group *group)
+{
+    const QByteArray raw = group->process.readAllStandardError();
+    const QList<QByteArray> lines = raw.split('\n');
+    for (const QByteArray &line : lines) {
+        const QByteArray trimmed = line.trimmed();
+        if (trimmed.isEmpty()) {
+            continue;
+        }
+        const QString text = QString::fromLocal8Bit(trimmed);
+        for (const Member &m : group->members) {
+            if (m.client) {
+                m.client->handleStderrText(text);
+            }
+        }
+    }
+}
+
+void LadderBackendHub::handleFinished(Group *group, int exitCode, QProcess::ExitStatus status)
+{
+    qWarning() << "[LadderBackendHub] shared backend finished" << exitCode << status;
+    if (group->stopping) {
+        group->stopping = false;
+        if (std::exchange(group->startPending, false)) {
+            startProcess(group);
+        }
+        return;
+    }
+    if (occupiedCount(group) == 0) {
+        return;
+    }
+    for (const Member &m : group->members) {
+        if (!m.client) {
+            continue;
+        }
+        m.client->logBackendEvent(QStringLiteral("shared backend finished exitCode=%1").arg(exitCode));
+        m.client->emitStatus(QStringLiteral("%1 Backend finished (%2). log: %3")
+                                 .arg(m.client->formatBackendPrefix())
+                                 .arg(exitCode)
+                                 .arg(m.client->backendLogPath()));
+    }
+    scheduleRestart(group, kCrashRestartDelayMs);
+}
+
+void LadderBackendHub::removeGroupIfEmpty(Group *group)
+{
+    if (occupiedCount(group) != 0) {
+        return;
+    }
+    group->restartTimer.stop();
+    stopProcess(group);
+    // Queued lambdas capture the raw pointer, so drop the connections first.
+    group->process.disconnect(this);
+    group->restartTimer.disconnect(this);
+    m_groups.erase(std::remove_if(m_groups.begin(),
+                                  m_groups.end(),
+                                  [group](const std::unique_ptr<Group> &g) { return g.get() == group; }),
+                   m_groups.end());
+}
@@ -0,0 +1,94 @@
+// Shares one orderbook_backend process (and one exchange WebSocket) between
+// all LadderClients that watch the same venue with the same settings.
+
+#pragma once
+
+#include <json.hpp>
+
+#include <QByteArray>
+#include <QObject>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+
+#include <memory>
+#include <vector>
+
+class LadderClient;
+
+class LadderBackendHub final : public QObject {
+    Q_OBJECT
+
+public:
+    static LadderBackendHub *instance();
+
+    // Venues whose backend runner accepts --symbols.
+    static bool supportsExchange(const QString &exchange);
+
+    // (Re)registers `client`. commonArgs are the backend arguments minus
+    // --symbol/--shm; clients with identical common args share a process.
+    // A running process takes the book over `add_book`, so the other books
+    // keep streaming.
+    void attach(LadderClient *client,
+                const QString &backendPath,
+                const QString &wireSymbol,
+                const QStringList &commonArgs,
+                const QString &shmKey);
+    // A running process drops the book over `remove_book`.
+    void detach(LadderClient *client);
+    bool isRunning(const LadderClient *client) const;
+    // False unless the group's process is running to take it.
+    bool sendCommand(const LadderClient *client, nlohmann::json cmd);
+    // Records a symbol/level change that `client` applied to the running
+    // process (LadderClient::reconfigure) so a later start of the group
+    // brings its book back the same way.
+    void updateMember(const LadderClient *client, const QString &wireSymbol, int levels);
+
+private:
+    explicit LadderBackendHub(QObject *parent = nullptr);
+
+    struct Member {
+        LadderClient *client = nullptr;
+        QString wireSymbol;
+        QString shmKey;
+        int levels = 0; // sent as set_levels after start when it differs from the group's
+        // `add_book` sent; the slot's output is held back until its
+        // "resubscribed" marker, since anything earlier is the old book.
+        bool awaitingAdd = false;
+    };
+
+    struct Group {
+        QString key;
+        QString exchange;
+        QString backendPath;
+        QStringList commonArgs;
+        // index == backend book id. A null client marks a slot freed since the
+        // last start; attach() reuses it and startProcess() drops the rest.
+        QVector<Member> members;
+        QProcess process;
+        QByteArray buffer;
+        QTimer restartTimer;
+        bool stopping = false;     // killed on purpose, finished() not seen yet
+        bool startPending = false; // start once the killed process is gone
+    };
+
+    Group *groupFor(const LadderClient *client, int *index = nullptr) const;
+    Group *groupWithRoom(const QString &key, const QString &exchange);
+    static int occupiedCount(const Group *group);
+    // Running, and not about to be replaced: book changes go over stdin.
+    static bool isLive(const Group *group);
+    static void writeCommand(Group *group, int index, nlohmann::json cmd);
+    void addBook(Group *group, int index);
+    void scheduleRestart(Group *group, int delayMs);
+    void stopProcess(Group *group);
+    void startProcess(Group *group);
+    void sendMemberLevels(Group *group);
+    void handleStdout(Group *group);
+    void handleStderr(Group *group);
+    void handleFinished(Group *group, int exitCode, QProcess::ExitStatus status);
+    void removeGroupIfEmpty(Group *group);
+
+    std::vector<std::unique_ptr<Group>> m_groups;
+};
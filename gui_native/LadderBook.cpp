@@ -0,0 +1,272 @@
+#include "LadderBook.h"
+
+#include <cstddef>
+
+namespace {
+constexpr qint64 kMinRingSize = 64;
+
+qint64 ringSizeFor(qint64 rows)
+{
+    qint64 size = kMinRingSize;
+    while (size < rows) {
+        size <<= 1;
+    }
+    return size;
+}
+
+qint64 floorDiv(qint64 a, qint64 b)
+{
+    const qint64 q = a / b;
+    return (a % b != 0 && a < 0) ? q - 1 : q;
+}
+
+qint64 ceilDiv(qint64 a, qint64 b)
+{
+    const qint64 q = a / b;
+    return (a % b != 0 && a > 0) ? q + 1 : q;
+}
+} // namespace
+
+void LadderBook::clear()
+{
+    if (m_hasWindow) {
+        clearRange(m_minTick, m_maxTick);
+    }
+    m_hasWindow = false;
+    m_minTick = 0;
+    m_maxTick = -1;
+    m_bucketsStale = true;
+}
+
+void LadderBook::setWindow(qint64 minTick, qint64 maxTick)
+{
+    if (minTick > maxTick) {
+        return;
+    }
+    if (maxTick - minTick + 1 > kMaxRows) {
+        const qint64 center = minTick + (maxTick - minTick) / 2;
+        minTick = center - kMaxRows / 2;
+        maxTick = minTick + kMaxRows - 1;
+    }
+    const qint64 rows = maxTick - minTick + 1;
+
+    if (rows > m_rows.size()) {
+        // Grow the ring and carry over the rows both windows cover.
+        const QVector<LadderBookEntry> old = m_rows;
+        const qint64 oldMask = m_mask;
+        const qint64 keepFrom = m_hasWindow ? std::max(minTick, m_minTick) : 1;
+        const qint64 keepTo = m_hasWindow ? std::min(maxTick, m_maxTick) : 0;
+        resize(rows);
+        for (qint64 tick = keepFrom; tick <= keepTo; ++tick) {
+            m_rows[static_cast<int>(tick & m_mask)] = old[static_cast<int>(tick & oldMask)];
+        }
+    } else if (m_hasWindow) {
+        // Two ticks of one window never share a slot, so a newly exposed
+        // tick's slot can only hold a tick the window slid off. Clearing
+        // those is enough.
+        if (maxTick < m_minTick || minTick > m_maxTick) {
+            clearRange(m_minTick, m_maxTick);
+        } else {
+            if (m_minTick < minTick) {
+                clearRange(m_minTick, minTick - 1);
+            }
+            if (m_maxTick > maxTick) {
+                clearRange(maxTick + 1, m_maxTick);
+            }
+        }
+    }
+    if (!m_hasWindow || minTick != m_minTick || maxTick != m_maxTick) {
+        m_bucketsStale = true;
+    }
+    m_minTick = minTick;
+    m_maxTick = maxTick;
+    m_hasWindow = true;
+}
+
+void LadderBook::set(qint64 tick, double bidQty, double askQty)
+{
+    if (!contains(tick)) {
+        return;
+    }
+    LadderBookEntry &entry = m_rows[static_cast<int>(tick & m_mask)];
+    entry.bidQty = bidQty;
+    entry.askQty = askQty;
+    markBuckets(tick);
+    journal(tick);
+}
+
+void LadderBook::remove(qint64 tick)
+{
+    set(tick, 0.0, 0.0);
+}
+
+void LadderBook::clearRange(qint64 from, qint64 to)
+{
+    if (to - from + 1 >= m_rows.size()) {
+        m_rows.fill(LadderBookEntry{});
+        dropJournal();
+        return;
+    }
+    LadderBookEntry *rows = m_rows.data();
+    for (qint64 tick = from; tick <= to; ++tick) {
+        rows[tick & m_mask] = LadderBookEntry{};
+        journal(tick);
+    }
+}
+
+void LadderBook::resize(qint64 rows)
+{
+    const qint64 size = ringSizeFor(rows);
+    m_rows = QVector<LadderBookEntry>(static_cast<int>(size), LadderBookEntry{});
+    m_mask = size - 1;
+    dropJournal();
+}
+
+void LadderBook::journal(qint64 tick)
+{
+    // A quarter of the ring: past that, a full copy per stale reader is cheap
+    // next to the writes, and the journal's memory stays bounded.
+    if (static_cast<qint64>(m_journal.size()) >= std::max<qint64>(kMinRingSize, m_rows.size() / 4)) {
+        dropJournal();
+        return;
+    }
+    m_journal.push_back(tick);
+}
+
+void LadderBook::dropJournal()
+{
+    m_journalStart += m_journal.size();
+    m_journal.clear();
+    ++m_layoutSerial;
+}
+
+void LadderBook::copyBucketsFor(const LadderBook &src, qint64 tick)
+{
+    for (const qint64 bucket : {floorDiv(tick, m_compression), ceilDiv(tick, m_compression)}) {
+        if (bucket >= m_firstBucket && bucket <= m_lastBucket) {
+            const int slot = static_cast<int>(bucket & m_bucketMask);
+            m_buckets.data()[slot] = src.m_buckets.constData()[slot];
+        }
+    }
+}
+
+void LadderBook::syncFrom(const LadderBook &src)
+{
+    const quint64 journalEnd = src.m_journalStart + src.m_journal.size();
+    const bool fullRows = m_syncedFrom != &src || m_syncedLayout != src.m_layoutSerial
+                          || m_syncedJournal < src.m_journalStart || m_rows.size() != src.m_rows.size();
+    const bool fullBuckets = fullRows || m_syncedBuckets != src.m_bucketSerial
+                             || m_buckets.size() != src.m_buckets.size();
+    const auto fresh = src.m_journal.cbegin() + static_cast<std::ptrdiff_t>(fullRows ? 0 : m_syncedJournal - src.m_journalStart);
+
+    if (fullRows) {
+        m_rows.resize(src.m_rows.size());
+        std::copy(src.m_rows.cbegin(), src.m_rows.cend(), m_rows.begin());
+    } else {
+        LadderBookEntry *rows = m_rows.data();
+        const LadderBookEntry *srcRows = src.m_rows.constData();
+        for (auto it = fresh; it != src.m_journal.cend(); ++it) {
+            rows[*it & src.m_mask] = srcRows[*it & src.m_mask];
+        }
+    }
+    m_mask = src.m_mask;
+    m_minTick = src.m_minTick;
+    m_maxTick = src.m_maxTick;
+    m_hasWindow = src.m_hasWindow;
+    m_compression = src.m_compression;
+    m_bucketMask = src.m_bucketMask;
+    m_firstBucket = src.m_firstBucket;
+    m_lastBucket = src.m_lastBucket;
+    m_bucketsStale = src.m_bucketsStale;
+    m_dirtyBuckets.clear();
+
+    if (m_compression > 1 && !m_bucketsStale) {
+        if (fullBuckets) {
+            m_buckets.resize(src.m_buckets.size());
+            std::copy(src.m_buckets.cbegin(), src.m_buckets.cend(), m_buckets.begin());
+        } else {
+            for (auto it = fresh; it != src.m_journal.cend(); ++it) {
+                copyBucketsFor(src, *it);
+            }
+        }
+    }
+
+    m_syncedFrom = &src;
+    m_syncedJournal = journalEnd;
+    m_syncedLayout = src.m_layoutSerial;
+    // Buckets skipped above (compression 1, stale source) are re-summed in
+    // full before src uses them again, which bumps the serial.
+    m_syncedBuckets = src.m_bucketSerial;
+}
+
+void LadderBook::setCompression(qint64 compression)
+{
+    compression = std::max<qint64>(1, compression);
+    if (compression != m_compression) {
+        m_compression = compression;
+        m_bucketsStale = true;
+    }
+}
+
+void LadderBook::markBuckets(qint64 tick)
+{
+    if (m_compression == 1 || m_bucketsStale) {
+        return;
+    }
+    m_dirtyBuckets.push_back(floorDiv(tick, m_compression));
+    m_dirtyBuckets.push_back(ceilDiv(tick, m_compression));
+    // Past this point re-summing everything is cheaper.
+    if (static_cast<qint64>(m_dirtyBuckets.size()) > (m_lastBucket - m_firstBucket + 1)) {
+        m_bucketsStale = true;
+        m_dirtyBuckets.clear();
+    }
+}
+
+void LadderBook::sumBucket(qint64 bucket)
+{
+    // Ascending tick order, matching what a full walk of the rows would add up.
+    const qint64 c = m_compression;
+    LadderBookEntry sum;
+    forEach(bucket * c, bucket * c + c - 1, [&sum](qint64, const LadderBookEntry &entry) {
+        if (entry.bidQty > 0.0) {
+            sum.bidQty += entry.bidQty;
+        }
+    });
+    forEach(bucket * c - c + 1, bucket * c, [&sum](qint64, const LadderBookEntry &entry) {
+        if (entry.askQty > 0.0) {
+            sum.askQty += entry.askQty;
+        }
+    });
+    m_buckets[static_cast<int>(bucket & m_bucketMask)] = sum;
+}
+
+void LadderBook::updateBuckets()
+{
+    if (m_compression == 1 || !m_hasWindow) {
+        m_dirtyBuckets.clear();
+        return;
+    }
+    if (!m_bucketsStale) {
+        std::sort(m_dirtyBuckets.begin(), m_dirtyBuckets.end());
+        m_dirtyBuckets.erase(std::unique(m_dirtyBuckets.begin(), m_dirtyBuckets.end()), m_dirtyBuckets.end());
+        for (const qint64 bucket : m_dirtyBuckets) {
+            sumBucket(bucket);
+        }
+        m_dirtyBuckets.clear();
+        return;
+    }
+
+    m_firstBucket = floorDiv(m_minTick, m_compression);
+    m_lastBucket = ceilDiv(m_maxTick, m_compression);
+    const qint64 size = ringSizeFor(m_lastBucket - m_firstBucket + 1);
+    if (m_buckets.size() != size) {
+        m_buckets = QVector<LadderBookEntry>(static_cast<int>(size), LadderBookEntry{});
+        m_bucketMask = size - 1;
+    }
+    for (qint64 bucket = m_firstBucket; bucket <= m_lastBucket; ++bucket) {
+        sumBucket(bucket);
+    }
+    m_dirtyBuckets.clear();
+    m_bucketsStale = false;
+    ++m_bucketSerial;
+}
@@ -0,0 +1,134 @@
+// Client-side copy of the backend's ladder window.
+
+#pragma once
+
+#include <QVector>
+
+#include <algorithm>
+#include <vector>
+
+struct LadderBookEntry {
+    double bidQty = 0.0;
+    double askQty = 0.0;
+};
+
+// Rows for [minTick, maxTick] in a power-of-two ring indexed by `tick & mask`,
+// the same layout as the backend's FlatBookSide. Set/remove/lookup are O(1);
+// moving the window clears only the ticks it slid over.
+//
+// LadderIngest hands books to the GUI thread through syncFrom(): every state
+// slot keeps its own ring and copies only the rows the worker's book wrote
+// since that slot was last synced (a bounded journal), so publishing neither
+// allocates nor copies the whole ring.
+//
+// With a compression above 1 the book also keeps per-bucket sums in the
+// snapshot's convention (bids floored, asks ceiled to a multiple of the
+// compression). Row writes only mark their buckets; updateBuckets() re-sums
+// those, and rebuilds everything after a clear, window move or compression change.
+class LadderBook {
+public:
+    // Windows wider than this (full-book mode on a sparse book) are clipped
+    // around their centre.
+    static constexpr qint64 kMaxRows = qint64(1) << 21;
+
+    void clear();
+
+    // Drops rows outside [minTick, maxTick]; rows inside keep their values.
+    void setWindow(qint64 minTick, qint64 maxTick);
+
+    // Both ignore ticks outside the window.
+    void set(qint64 tick, double bidQty, double askQty);
+    void remove(qint64 tick);
+
+    void setCompression(qint64 compression);
+    qint64 compression() const { return m_compression; }
+    void updateBuckets();
+
+    // Makes this book equal to `src` (call src.updateBuckets() first). Copies
+    // the rows and buckets src wrote since the last syncFrom(src) while src's
+    // journal reaches back that far, else the whole ring into this book's
+    // existing storage. Both books must stay unshared copies.
+    void syncFrom(const LadderBook &src);
+
+    // `bucketTick` is a multiple of compression(); valid after updateBuckets().
+    // Bids of [bucketTick, bucketTick + c - 1] / asks of [bucketTick - c + 1, bucketTick].
+    double bucketBid(qint64 bucketTick) const { return bucketAt(bucketTick / m_compression).bidQty; }
+    double bucketAsk(qint64 bucketTick) const { return bucketAt(bucketTick / m_compression).askQty; }
+
+    bool hasWindow() const { return m_hasWindow; }
+    qint64 minTick() const { return m_minTick; }
+    qint64 maxTick() const { return m_maxTick; }
+
+    LadderBookEntry at(qint64 tick) const
+    {
+        return contains(tick) ? m_rows[static_cast<int>(tick & m_mask)] : LadderBookEntry{};
+    }
+
+    // fn(qint64 tick, const LadderBookEntry &) for every tick of [from, to]
+    // inside the window, ascending, zero rows included. Walks the ring as
+    // contiguous runs.
+    template <typename Fn>
+    void forEach(qint64 from, qint64 to, Fn &&fn) const
+    {
+        if (!m_hasWindow) {
+            return;
+        }
+        from = std::max(from, m_minTick);
+        to = std::min(to, m_maxTick);
+        const LadderBookEntry *rows = m_rows.constData();
+        while (from <= to) {
+            const qint64 slot = from & m_mask;
+            const qint64 run = std::min(to - from + 1, m_mask + 1 - slot);
+            for (qint64 i = 0; i < run; ++i) {
+                fn(from + i, rows[slot + i]);
+            }
+            from += run;
+        }
+    }
+
+private:
+    bool contains(qint64 tick) const { return m_hasWindow && tick >= m_minTick && tick <= m_maxTick; }
+    void clearRange(qint64 from, qint64 to);
+    void resize(qint64 rows);
+    void markBuckets(qint64 tick);
+    void sumBucket(qint64 bucket);
+    void journal(qint64 tick);
+    void dropJournal();
+    void copyBucketsFor(const LadderBook &src, qint64 tick);
+    LadderBookEntry bucketAt(qint64 bucket) const
+    {
+        return (bucket >= m_firstBucket && bucket <= m_lastBucket)
+                   ? m_buckets[static_cast<int>(bucket & m_bucketMask)]
+                   : LadderBookEntry{};
+    }
+
+    QVector<LadderBookEntry> m_rows; // size is a power of two
+    qint64 m_mask = -1;
+    qint64 m_minTick = 0;
+    qint64 m_maxTick = -1;
+    bool m_hasWindow = false;
+
+    // Bucket k holds the bids of ticks [k*c, k*c + c - 1] and the asks of
+    // [k*c - c + 1, k*c], in a ring like m_rows.
+    qint64 m_compression = 1;
+    QVector<LadderBookEntry> m_buckets;
+    qint64 m_bucketMask = -1;
+    qint64 m_firstBucket = 0;
+    qint64 m_lastBucket = -1;
+    bool m_bucketsStale = true;
+    std::vector<qint64> m_dirtyBuckets; // empty whenever the book is published
+
+    // Ticks whose rows were written, oldest first; serial m_journalStart is
+    // m_journal[0]. Writes it does not cover (ring resize, whole-ring clear,
+    // overflow) bump m_layoutSerial instead, a full re-sum m_bucketSerial.
+    std::vector<qint64> m_journal;
+    quint64 m_journalStart = 0;
+    quint64 m_layoutSerial = 0;
+    quint64 m_bucketSerial = 0;
+
+    // As a syncFrom() target: how far into the source it has copied.
+    const LadderBook *m_syncedFrom = nullptr;
+    quint64 m_syncedJournal = 0;
+    quint64 m_syncedLayout = 0;
+    quint64 m_syncedBuckets = 0;
+};
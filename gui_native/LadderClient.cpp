@@ -1,4 +1,5 @@
 #include "LadderClient.h"
+#include "LadderBackendHub.h"
 #include "PrintsWidget.h"
 
 #include <QDateTime>
@@ -7,6 +8,7 @@
 #include <QFile>
 #include <QCoreApplication>
 #include <QFileInfo>
+#include <QMetaObject>
 #include <QRegularExpression>
 #include <QStandardPaths>
 #include <QTextStream>
@@ -15,10 +17,8 @@
 #include <QUrl>
 
 #include <json.hpp>
-#include <cmath>
 #include <cstdint>
-#include <limits>
-#include <map>
+#include <cstring>
 
 using json = nlohmann::json;
 
@@ -67,187 +67,6 @@ static bool resolveSystemProxyForUrl(const QUrl &url, QString &outType, QString
     return false;
 }
 
-static bool parseTickValue(const json &value, qint64 &outTick)
-{
-    try {
-        if (value.is_number_integer()) {
-            outTick = static_cast<qint64>(value.get<std::int64_t>());
-            return true;
-        }
-        if (value.is_number_float()) {
-            const double d = value.get<double>();
-            if (!std::isfinite(d)) {
-                return false;
-            }
-            outTick = static_cast<qint64>(std::llround(d));
-            return true;
-        }
-        if (value.is_string()) {
-            const std::string s = value.get<std::string>();
-            if (s.empty()) {
-                return false;
-            }
-            std::size_t idx = 0;
-            const long long v = std::stoll(s, &idx, 10);
-            if (idx == 0) {
-                return false;
-            }
-            outTick = static_cast<qint64>(v);
-            return true;
-        }
-    } catch (...) {
-        return false;
-    }
-    return false;
-}
-
-static qint64 pow10i(int exp)
-{
-    qint64 v = 1;
-    for (int i = 0; i < exp; ++i) {
-        v *= 10;
-    }
-    return v;
-}
-
-static bool chooseScaleForTickSize(double tickSize, qint64 &outScale, qint64 &outTickSizeScaled)
-{
-    if (!(tickSize > 0.0) || !std::isfinite(tickSize)) {
-        return false;
-    }
-    for (int decimals = 0; decimals <= 12; ++decimals) {
-        const qint64 scale = pow10i(decimals);
-        const double scaled = tickSize * static_cast<double>(scale);
-        if (!std::isfinite(scaled)) {
-            continue;
-        }
-        const qint64 rounded = static_cast<qint64>(std::llround(scaled));
-        if (rounded <= 0) {
-            continue;
-        }
-        if (std::abs(scaled - static_cast<double>(rounded)) <= 1e-9) {
-            outScale = scale;
-            outTickSizeScaled = rounded;
-            return true;
-        }
-    }
-    return false;
-}
-
-static bool parseDecimalToScaledInt(const json &value, int decimals, qint64 &out)
-{
-    if (decimals < 0 || decimals > 12) {
-        return false;
-    }
-
-    std::string s;
-    if (value.is_string()) {
-        s = value.get<std::string>();
-    } else if (value.is_number()) {
-        s = value.dump();
-    } else {
-        return false;
-    }
-
-    if (s.empty()) {
-        return false;
-    }
-
-    bool neg = false;
-    size_t pos = 0;
-    if (s[pos] == '-') {
-        neg = true;
-        ++pos;
-    } else if (s[pos] == '+') {
-        ++pos;
-    }
-
-    qint64 intPart = 0;
-    bool anyDigit = false;
-    while (pos < s.size() && std::isdigit(static_cast<unsigned char>(s[pos]))) {
-        anyDigit = true;
-        intPart = intPart * 10 + (s[pos] - '0');
-        ++pos;
-    }
-
-    qint64 fracPart = 0;
-    int fracDigits = 0;
-    int nextDigit = -1;
-    if (pos < s.size() && s[pos] == '.') {
-        ++pos;
-        while (pos < s.size() && std::isdigit(static_cast<unsigned char>(s[pos]))) {
-            anyDigit = true;
-            if (fracDigits < decimals) {
-                fracPart = fracPart * 10 + (s[pos] - '0');
-                ++fracDigits;
-            } else if (nextDigit < 0) {
-                nextDigit = (s[pos] - '0');
-            }
-            ++pos;
-        }
-    }
-
-    if (!anyDigit) {
-        return false;
-    }
-
-    while (fracDigits < decimals) {
-        fracPart *= 10;
-        ++fracDigits;
-    }
-
-    if (nextDigit >= 5) {
-        fracPart += 1;
-        const qint64 scale = pow10i(decimals);
-        if (fracPart >= scale) {
-            fracPart -= scale;
-            intPart += 1;
-        }
-    }
-
-    const qint64 scale = pow10i(decimals);
-    qint64 result = intPart * scale + fracPart;
-    if (neg) {
-        result = -result;
-    }
-    out = result;
-    return true;
-}
-
-static bool quantizePriceToTick(const json &priceValue,
-                                double tickSize,
-                                qint64 &outTick,
-                                double &outSnappedPrice)
-{
-    qint64 scale = 0;
-    qint64 tickSizeScaled = 0;
-    if (!chooseScaleForTickSize(tickSize, scale, tickSizeScaled)) {
-        return false;
-    }
-    int decimals = 0;
-    qint64 tmp = scale;
-    while (tmp > 1) {
-        tmp /= 10;
-        ++decimals;
-    }
-
-    qint64 priceScaled = 0;
-    if (!parseDecimalToScaledInt(priceValue, decimals, priceScaled)) {
-        return false;
-    }
-
-    qint64 tick = 0;
-    if (priceScaled >= 0) {
-        tick = (priceScaled + tickSizeScaled / 2) / tickSizeScaled;
-    } else {
-        tick = -((-priceScaled + tickSizeScaled / 2) / tickSizeScaled);
-    }
-
-    const qint64 snappedScaled = tick * tickSizeScaled;
-    outTick = tick;
-    outSnappedPrice = static_cast<double>(snappedScaled) / static_cast<double>(scale);
-    return std::isfinite(outSnappedPrice);
-}
 } // namespace
 
 LadderClient::LadderClient(const QString &backendPath,
@@ -296,12 +115,24 @@ LadderClient::LadderClient(const QString &backendPath,
     m_watchdogTimer.setSingleShot(true);
     connect(&m_watchdogTimer, &QTimer::timeout, this, &LadderClient::handleWatchdogTimeout);
 
+    m_ingest = new LadderIngest(m_prints != nullptr);
+    m_ingest->moveToThread(&m_ingestThread);
+    connect(&m_ingestThread, &QThread::finished, m_ingest, &QObject::deleteLater);
+    connect(m_ingest, &LadderIngest::published, this, &LadderClient::handleIngestPublished);
+    connect(m_ingest, &LadderIngest::statusMessage, this, [this](const QString &msg) { emitStatus(msg); });
+    connect(m_ingest, &LadderIngest::resubscribeFailed, this, &LadderClient::handleResubscribeFailed);
+    m_ingestThread.setObjectName(QStringLiteral("LadderIngest"));
+    m_ingestThread.start();
+
     restart(m_symbol, m_levels, m_exchange);
 }
 
 LadderClient::~LadderClient()
 {
     stop();
+    // The worker may still be draining the shared trade ring; join it before m_shm goes.
+    m_ingestThread.quit();
+    m_ingestThread.wait();
 }
 
 QString LadderClient::formatBackendPrefix() const
@@ -368,50 +199,10 @@ QString LadderClient::formatCrashSummary(int exitCode, QProcess::ExitStatus stat
     return msg;
 }
 
-void LadderClient::restart(const QString &symbol, int levels, const QString &exchange)
+QString LadderClient::wireSymbolFor(const QString &symbol) const
 {
-    m_restartInProgress = true;
-    // Treat any termination that happens during restart() as expected; otherwise
-    // we end up with "Process crashed" spam during startup (we restart once more
-    // after applying compression/account settings).
-    m_stopRequested = true;
-    m_symbol = symbol;
-    m_levels = levels;
-    if (!exchange.isEmpty()) {
-        m_exchange = exchange;
-    }
-    m_lastTickSize = 0.0;
-    m_bestBid = 0.0;
-    m_bestAsk = 0.0;
-    m_book.clear();
-    m_bufferMinTick = 0;
-    m_bufferMaxTick = 0;
-    m_centerTick = 0;
-    m_hasBook = false;
-    m_printBuffer.clear();
-    if (m_prints) {
-        QVector<PrintItem> emptyPrints;
-        m_prints->setPrints(emptyPrints);
-        QVector<double> emptyPrices;
-        QVector<qint64> emptyTicks;
-        m_prints->setLadderPrices(emptyPrices, emptyTicks, 20, 0.0, 0, 0, 1, 0.0);
-        QVector<LocalOrderMarker> emptyOrders;
-        m_prints->setLocalOrders(emptyOrders);
-    }
-
-    if (m_process.state() != QProcess::NotRunning) {
-        m_process.kill();
-        m_process.waitForFinished(2000);
-    }
-    m_recentStderr.clear();
-    m_lastExitCode = 0;
-    m_lastExitStatus = QProcess::NormalExit;
-    m_lastProcessError = QProcess::UnknownError;
-    m_lastProcessErrorString.clear();
-    m_stopRequested = false;
-
     // Map UI symbol to exchange-specific wire format.
-    QString wireSymbol = m_symbol;
+    QString wireSymbol = symbol;
     if (m_exchange == QStringLiteral("uzxspot"))
     {
         if (!wireSymbol.contains(QLatin1Char('-')))
@@ -447,11 +238,71 @@ void LadderClient::restart(const QString &symbol, int levels, const QString &exc
         wireSymbol = wireSymbol.replace(QStringLiteral("_"), QString());
         wireSymbol = wireSymbol.replace(QStringLiteral("-"), QString());
     }
+    return wireSymbol;
+}
+
+void LadderClient::clearPrints()
+{
+    if (!m_prints) {
+        return;
+    }
+    QVector<PrintItem> emptyPrints;
+    m_prints->setPrints(emptyPrints);
+    QVector<double> emptyPrices;
+    QVector<qint64> emptyTicks;
+    m_prints->setLadderPrices(emptyPrices, emptyTicks, 20, 0.0, 0, 0, 1, 0.0);
+    QVector<LocalOrderMarker> emptyOrders;
+    m_prints->setLocalOrders(emptyOrders);
+}
+
+void LadderClient::restart(const QString &symbol, int levels, const QString &exchange)
+{
+    m_symbol = symbol;
+    m_levels = levels;
+    if (!exchange.isEmpty()) {
+        m_exchange = exchange;
+    }
+    m_lastTickSize = 0.0;
+    m_bufferMinTick = 0;
+    m_bufferMaxTick = 0;
+    m_centerTick = 0;
+    m_hasBook = false;
+    forgetViewport();
+    clearPrints();
+
+    if (m_process.state() != QProcess::NotRunning) {
+        // No waitForFinished(): handleFinished() takes this exit as expected and
+        // starts the replacement then, so the GUI thread never blocks here.
+        m_replacingProcess = true;
+        m_process.kill();
+    }
+    m_startPending = false;
+    const bool useHub = LadderBackendHub::supportsExchange(m_exchange);
+    if (m_useHub && !useHub) {
+        LadderBackendHub::instance()->detach(this);
+    }
+    m_useHub = useHub;
+    std::shared_ptr<QSharedMemory> oldSegment = releaseSharedSegment();
+    m_recentStderr.clear();
+    m_lastExitCode = 0;
+    m_lastExitStatus = QProcess::NormalExit;
+    m_lastProcessError = QProcess::UnknownError;
+    m_lastProcessErrorString.clear();
+    m_stopRequested = false;
+    m_startedProxyType = m_proxyType;
+    m_startedProxy = m_proxy;
 
+    const QString wireSymbol = wireSymbolFor(m_symbol);
+
+    // --symbol and --shm are per ladder; everything else decides whether
+    // two ladders can share one backend process (see LadderBackendHub).
     QStringList args;
-    args << "--symbol" << wireSymbol
-         << "--ladder-levels" << QString::number(m_levels)
-         << "--cache-levels" << QString::number(m_levels);
+    args << "--ladder-levels" << QString::number(m_levels)
+         << "--cache-levels" << QString::number(m_levels)
+         << "--protocol" << "binary"
+         << "--deep-book";
+    const QString shmKey = createSharedSegment() ? m_shm->nativeKey() : QString();
+    resetIngest(std::move(oldSegment));
     if (!m_exchange.isEmpty()) {
         args << "--exchange" << m_exchange;
     }
@@ -516,6 +367,21 @@ void LadderClient::restart(const QString &symbol, int levels, const QString &exc
         const QString label = systemProxyResolved ? QStringLiteral("system") : summarize(type, proxyRaw);
         emitStatus(QStringLiteral("%1 Backend proxy: %2").arg(formatBackendPrefix(), label));
     }
+
+    if (m_useHub) {
+        emitStatus(QStringLiteral("Joining shared backend (%1, %2 levels, %3)...")
+                       .arg(m_symbol)
+                       .arg(m_levels)
+                       .arg(m_exchange));
+        LadderBackendHub::instance()->attach(this, m_backendPath, wireSymbol, args, shmKey);
+        armWatchdog();
+        return;
+    }
+
+    args << "--symbol" << wireSymbol;
+    if (!shmKey.isEmpty()) {
+        args << "--shm" << shmKey;
+    }
     m_process.setArguments(args);
 
     emitStatus(QStringLiteral("Starting backend (%1, %2 levels, %3)...")
@@ -530,9 +396,75 @@ void LadderClient::restart(const QString &symbol, int levels, const QString &exc
     }
     qWarning() << "[LadderClient] starting backend with args" << argsForLog;
     logBackendEvent(QStringLiteral("start args=%1").arg(argsForLog.join(QLatin1Char(' '))));
-    m_process.start();
+    if (m_replacingProcess) {
+        m_startPending = true;
+    } else {
+        m_process.start();
+    }
     armWatchdog();
-    m_restartInProgress = false;
+}
+
+void LadderClient::reconfigure(const QString &symbol, int levels, const QString &exchange)
+{
+    const bool symbolChanged = symbol != m_symbol;
+    const bool levelsChanged = levels != m_levels;
+    // The backend takes a new window size, and a new symbol on the venues whose
+    // runner multiplexes symbols on one socket (the ones the hub serves). A
+    // different venue or proxy, a backend without a book yet, full-book mode or
+    // a window the shared segment cannot hold still need a new process.
+    const bool live = isRunning() && m_hasBook && !m_replacingProcess;
+    const bool sameProcess = (exchange.isEmpty() || exchange == m_exchange) && m_proxyType == m_startedProxyType
+                             && m_proxy == m_startedProxy;
+    const bool levelsFit = levels > 0 && m_levels > 0
+                           && (!m_shmActive
+                               || static_cast<std::uint32_t>(levels) * 2u + 1u <= m_shmSegment.rowCapacity());
+    const bool canSwitch = !symbolChanged || LadderBackendHub::supportsExchange(m_exchange);
+    if (!live || !sameProcess || !levelsFit || !canSwitch) {
+        restart(symbol, levels, exchange);
+        return;
+    }
+    if (!symbolChanged && !levelsChanged) {
+        return;
+    }
+
+    if (levelsChanged) {
+        json cmd;
+        cmd["cmd"] = "set_levels";
+        cmd["levels"] = levels;
+        if (!sendCommand(cmd)) {
+            restart(symbol, levels, exchange);
+            return;
+        }
+        m_levels = levels;
+    }
+    const QString wireSymbol = wireSymbolFor(symbol);
+    if (symbolChanged) {
+        // The old book stays up until the backend's "resubscribed" marker; see
+        // handleIngestPublished().
+        json cmd;
+        cmd["cmd"] = "resubscribe";
+        cmd["symbol"] = wireSymbol.toStdString();
+        if (!sendCommand(cmd)) {
+            restart(symbol, levels, exchange);
+            return;
+        }
+        m_symbol = symbol;
+        emitStatus(QStringLiteral("Switching backend to %1...").arg(m_symbol));
+        logBackendEvent(QStringLiteral("resubscribe %1").arg(wireSymbol));
+    }
+    if (m_useHub) {
+        LadderBackendHub::instance()->updateMember(this, wireSymbol, m_levels);
+    }
+}
+
+void LadderClient::handleResubscribeFailed(const QString &wireSymbol, const QString &error)
+{
+    if (wireSymbol != wireSymbolFor(m_symbol)) {
+        // A later switch superseded it.
+        return;
+    }
+    emitStatus(QStringLiteral("%1 Switch failed (%2), restarting backend").arg(formatBackendPrefix(), error));
+    restart(m_symbol, m_levels, m_exchange);
 }
 
 void LadderClient::setProxy(const QString &proxyType, const QString &proxy)
@@ -544,6 +476,12 @@ void LadderClient::setProxy(const QString &proxyType, const QString &proxy)
 void LadderClient::stop()
 {
     m_stopRequested = true;
+    m_startPending = false;
+    if (m_useHub) {
+        LadderBackendHub::instance()->detach(this);
+        m_useHub = false;
+        emitStatus(QStringLiteral("Backend stopped"));
+    }
     if (m_process.state() != QProcess::NotRunning) {
         m_process.kill();
         m_process.waitForFinished(2000);
@@ -554,12 +492,21 @@ void LadderClient::stop()
 
 bool LadderClient::isRunning() const
 {
+    if (m_useHub) {
+        return LadderBackendHub::instance()->isRunning(this);
+    }
     return m_process.state() != QProcess::NotRunning;
 }
 
 void LadderClient::setCompression(int factor)
 {
     m_tickCompression = std::max(1, factor);
+    ++m_revision;
+    // The worker re-sums its bucket cache for the new factor; until that is
+    // published buildSnapshot() falls back to summing rows.
+    const qint64 compression = m_tickCompression;
+    QMetaObject::invokeMethod(m_ingest, [this, compression]() { m_ingest->setCompression(compression); },
+                              Qt::QueuedConnection);
 }
 
 void LadderClient::shiftWindowTicks(qint64 ticks)
@@ -567,48 +514,142 @@ void LadderClient::shiftWindowTicks(qint64 ticks)
     if (ticks == 0) {
         return;
     }
-    if (m_process.state() == QProcess::NotRunning) {
-        return;
-    }
     json cmd;
     cmd["cmd"] = "shift";
     cmd["ticks"] = ticks;
-    const std::string payload = cmd.dump();
-    m_process.write(payload.c_str(), static_cast<int>(payload.size()));
-    m_process.write("\n", 1);
+    sendCommand(cmd);
 }
 
 void LadderClient::resetManualCenter()
 {
-    if (m_process.state() == QProcess::NotRunning) {
+    json cmd;
+    cmd["cmd"] = "center_auto";
+    sendCommand(cmd);
+}
+
+void LadderClient::setViewport(qint64 bottomTick, qint64 topTick)
+{
+    const int compression = std::max(1, m_tickCompression);
+    if (bottomTick > topTick
+        || (bottomTick == m_sentViewportBottom && topTick == m_sentViewportTop
+            && compression == m_sentViewportCompression)) {
         return;
     }
     json cmd;
-    cmd["cmd"] = "center_auto";
+    cmd["cmd"] = "set_viewport";
+    cmd["min_tick"] = bottomTick;
+    cmd["max_tick"] = topTick;
+    cmd["compression"] = compression;
+    if (sendCommand(cmd)) {
+        m_sentViewportBottom = bottomTick;
+        m_sentViewportTop = topTick;
+        m_sentViewportCompression = compression;
+    }
+}
+
+bool LadderClient::sendCommand(const json &cmd)
+{
+    if (m_useHub) {
+        return LadderBackendHub::instance()->sendCommand(this, cmd);
+    }
+    if (m_process.state() == QProcess::NotRunning) {
+        return false;
+    }
     const std::string payload = cmd.dump();
     m_process.write(payload.c_str(), static_cast<int>(payload.size()));
     m_process.write("\n", 1);
+    return true;
 }
 
-DomSnapshot LadderClient::snapshotForRange(qint64 minTick, qint64 maxTick) const
+bool LadderClient::snapshotForRange(qint64 minTick, qint64 maxTick, DomSnapshot &out) const
 {
-    if (!m_hasBook || m_lastTickSize <= 0.0) {
-        return DomSnapshot{};
+    // Lock-free: the newest state the worker published, possibly ahead of the
+    // mirrored fields until handleIngestPublished() runs.
+    const LadderBookState &state = m_ingest->acquire();
+    if (state.resetEpoch != m_ingestEpoch || !state.hasBook || state.tickSize <= 0.0) {
+        resetSnapshot(out);
+        return false;
     }
-    return buildSnapshot(minTick, maxTick);
+    return buildSnapshot(state, minTick, maxTick, out);
 }
 
-void LadderClient::handleReadyRead()
+void LadderClient::feedIngest(const char *data, std::size_t size)
+{
+    armWatchdog();
+    m_ingest->feed(data, size);
+}
+
+void LadderClient::resetIngest(std::shared_ptr<QSharedMemory> oldSegment)
 {
-    m_buffer += m_process.readAllStandardOutput();
-    int idx = -1;
-    while ((idx = m_buffer.indexOf('\n')) != -1) {
-        QByteArray line = m_buffer.left(idx);
-        m_buffer.remove(0, idx + 1);
-        if (!line.trimmed().isEmpty()) {
-            processLine(line);
+    // Not blocking: states the worker publishes before it gets to the reset
+    // carry the previous epoch and are ignored. The old mapping goes with the
+    // request and is released on the worker once nothing reads it any more
+    // (QSharedMemory has no timers or events, so that thread may delete it).
+    m_ingest->reset(++m_ingestEpoch, m_shmSegment, std::move(oldSegment));
+}
+
+void LadderClient::handleIngestPublished()
+{
+    m_ingest->acknowledge();
+    const LadderBookState &state = m_ingest->acquire();
+    if (state.resetEpoch != m_ingestEpoch) {
+        // Built before the worker took the last reset(); a newer publish follows.
+        return;
+    }
+    if (m_shmActive && !state.shmActive) {
+        // The worker saw stdout ladders instead of shm frames and stopped using the segment.
+        releaseSharedSegment();
+    }
+    if (state.bookEpoch != m_seenBookEpoch) {
+        // The backend switched symbols (reconfigure()); every print shown so far
+        // is the old symbol's, and state.prints holds only new ones.
+        m_seenBookEpoch = state.bookEpoch;
+        clearPrints();
+        m_seenPrintSeq = 0;
+    }
+    if (m_prints && state.printSeq != m_seenPrintSeq) {
+        // Hand over only the prints it has not seen; the buffer is ascending by seq.
+        const QVector<PrintItem> &prints = state.prints;
+        int from = prints.size();
+        while (from > 0 && prints[from - 1].seq > m_seenPrintSeq) {
+            --from;
+        }
+        m_seenPrintSeq = state.printSeq;
+        m_prints->appendPrints(prints, from);
+    }
+    if (state.ladderSeq == m_seenLadderSeq) {
+        if (state.hasBook != m_hasBook) {
+            // reset() drops the book without a new ladder.
+            m_hasBook = state.hasBook;
+            ++m_revision;
         }
+        return;
+    }
+    m_seenLadderSeq = state.ladderSeq;
+    ++m_revision;
+    if (state.tickSize > 0.0) {
+        m_lastTickSize = state.tickSize;
+    }
+    m_hasBook = state.hasBook;
+    m_bufferMinTick = state.minTick;
+    m_bufferMaxTick = state.maxTick;
+    m_centerTick = state.centerTick;
+    if (m_hasBook) {
+        emit bookRangeUpdated(m_bufferMinTick, m_bufferMaxTick, m_centerTick, m_lastTickSize);
+    }
+    emitPing(state.timestampMs);
+}
+
+void LadderClient::handleReadyRead()
+{
+    // Only the pipe read happens here; framing and parsing run on the ingest thread.
+    const QByteArray chunk = m_process.readAllStandardOutput();
+    if (chunk.isEmpty() || m_replacingProcess) {
+        // Output of a process restart() already gave up on.
+        return;
     }
+    armWatchdog();
+    m_ingest->feed(chunk);
 }
 
 void LadderClient::handleReadyReadStderr()
@@ -623,20 +664,24 @@ void LadderClient::handleReadyReadStderr()
         if (trimmed.isEmpty()) {
             continue;
         }
-        const QString text = QString::fromLocal8Bit(trimmed);
-        qWarning() << "[LadderClient stderr]" << text;
-        if (text.contains(QStringLiteral("proxy enabled:"), Qt::CaseInsensitive)
-            || text.contains(QStringLiteral("lighter:"), Qt::CaseInsensitive)
-            || text.contains(QStringLiteral("lighter ws"), Qt::CaseInsensitive)
-            || text.contains(QStringLiteral("lighter orderBookDetails"), Qt::CaseInsensitive)
-            || text.contains(QStringLiteral("httpGetQt failed"), Qt::CaseInsensitive)) {
-            emitStatus(QStringLiteral("%1 %2").arg(formatBackendPrefix(), text));
-        }
-        appendRecent(m_recentStderr, text, 80);
-        logBackendLine(text);
+        handleStderrText(QString::fromLocal8Bit(trimmed));
     }
 }
 
+void LadderClient::handleStderrText(const QString &text)
+{
+    qWarning() << "[LadderClient stderr]" << text;
+    if (text.contains(QStringLiteral("proxy enabled:"), Qt::CaseInsensitive)
+        || text.contains(QStringLiteral("lighter:"), Qt::CaseInsensitive)
+        || text.contains(QStringLiteral("lighter ws"), Qt::CaseInsensitive)
+        || text.contains(QStringLiteral("lighter orderBookDetails"), Qt::CaseInsensitive)
+        || text.contains(QStringLiteral("httpGetQt failed"), Qt::CaseInsensitive)) {
+        emitStatus(QStringLiteral("%1 %2").arg(formatBackendPrefix(), text));
+    }
+    appendRecent(m_recentStderr, text, 80);
+    logBackendLine(text);
+}
+
 void LadderClient::handleErrorOccurred(QProcess::ProcessError error)
 {
     m_lastProcessError = error;
@@ -664,9 +709,13 @@ void LadderClient::handleFinished(int exitCode, QProcess::ExitStatus status)
     logBackendEvent(QStringLiteral("finished exitCode=%1 exitStatus=%2")
                         .arg(exitCode)
                         .arg(status == QProcess::CrashExit ? QStringLiteral("CrashExit") : QStringLiteral("NormalExit")));
-    if (m_restartInProgress) {
-        // Restart already started another process; don't notify and don't chain-restart.
-        m_watchdogTimer.stop();
+    if (m_replacingProcess) {
+        // restart() killed it; don't notify and don't chain-restart.
+        m_replacingProcess = false;
+        if (m_startPending) {
+            m_startPending = false;
+            m_process.start();
+        }
         return;
     }
     if (status == QProcess::CrashExit && !m_stopRequested) {
@@ -702,213 +751,48 @@ void LadderClient::handleFinished(int exitCode, QProcess::ExitStatus status)
     }
 }
 
-void LadderClient::processLine(const QByteArray &line)
+void LadderClient::emitPing(qint64 timestampMs)
 {
-    json j;
-    try {
-        j = json::parse(line.constData(), line.constData() + line.size());
-    } catch (const std::exception &ex) {
-        qWarning() << "[LadderClient] parse error:" << ex.what();
-        emitStatus("Parse error: " + QString::fromUtf8(ex.what()));
-        return;
-    }
-
-    const std::string type = j.value("type", std::string());
-    armWatchdog();
-    if (type == "trade") {
-        if (!m_prints) {
-            return;
-        }
-        double price = j.value("price", 0.0);
-        const double qtyBase = j.value("qty", 0.0);
-        const std::string side = j.value("side", std::string("buy"));
-        if (price <= 0.0 || qtyBase <= 0.0) {
-            return;
-        }
-        qint64 tick = 0;
-        if (j.contains("tick") && parseTickValue(j["tick"], tick)) {
-            if (m_lastTickSize > 0.0) {
-                price = static_cast<double>(tick) * m_lastTickSize;
-            }
-        }
-        if (tick == 0 && m_lastTickSize > 0.0) {
-            auto priceIt = j.find("price");
-            double snappedPrice = 0.0;
-            if (priceIt != j.end() && quantizePriceToTick(*priceIt, m_lastTickSize, tick, snappedPrice)) {
-                price = snappedPrice;
-            } else {
-                tick = static_cast<qint64>(std::llround(price / m_lastTickSize));
-                price = static_cast<double>(tick) * m_lastTickSize;
-            }
-        }
-
-        const double qtyQuote = price * qtyBase;
-        if (qtyQuote <= 0.0) {
-            return;
-        }
-
-        const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
-        PrintItem it;
-        it.price = price;
-        it.qty = qtyQuote;
-        it.buy = (side != "sell");
-        it.rowHint = -1;
-        it.tick = tick;
-        it.timeMs = nowMs;
-        it.seq = ++m_printSeq;
-        m_printBuffer.push_back(it);
-        // IMPORTANT: prints UI only renders a small tail (<= ~64 slots). Keeping thousands of prints
-        // and shifting the vector on every trade can freeze the whole UI on high-throughput symbols
-        // like BTC. Keep a small rolling buffer instead.
-        const int maxPrints = 128;
-        if (m_printBuffer.size() > maxPrints) {
-            m_printBuffer.erase(m_printBuffer.begin(),
-                                m_printBuffer.begin() + (m_printBuffer.size() - maxPrints));
-        }
-        m_prints->setPrints(m_printBuffer);
-        return;
-    }
-
-    bool handledLadder = false;
-    if (type == "ladder_delta") {
-        applyDeltaLadderMessage(j);
-        handledLadder = true;
-    } else if (type == "ladder") {
-        applyFullLadderMessage(j);
-        handledLadder = true;
-    } else {
-        return;
-    }
-
-    if (!handledLadder) {
-        return;
-    }
-
-    const auto tsIt = j.find("timestamp");
-    if (tsIt != j.end() && tsIt->is_number_integer()) {
-        const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
-        const qint64 tsMs = static_cast<qint64>(tsIt->get<std::int64_t>());
-        const int pingMs = static_cast<int>(std::max<qint64>(0, nowMs - tsMs));
-        emit pingUpdated(pingMs);
-    } else {
-        // no-op: avoid spamming status (it also makes column width jitter)
-    }
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    const int pingMs = static_cast<int>(std::max<qint64>(0, nowMs - timestampMs));
+    emit pingUpdated(pingMs);
 }
 
-void LadderClient::applyFullLadderMessage(const json &j)
-{
-    m_bestBid = j.value("bestBid", 0.0);
-    m_bestAsk = j.value("bestAsk", 0.0);
-    const double tickSize = j.value("tickSize", 0.0);
-    if (tickSize > 0.0) {
-        m_lastTickSize = tickSize;
-    }
-
-    auto rowsIt = j.find("rows");
-    if (rowsIt != j.end() && rowsIt->is_array()) {
-        m_book.clear();
-        if (m_lastTickSize > 0.0) {
-            for (const auto &row : *rowsIt) {
-                const double bidQty = row.value("bid", 0.0);
-                const double askQty = row.value("ask", 0.0);
-                qint64 tick = 0;
-                if (row.contains("tick") && parseTickValue(row["tick"], tick)) {
-                } else {
-                    const double price = row.value("price", 0.0);
-                    tick = static_cast<qint64>(std::llround(price / m_lastTickSize));
-                }
-                BookEntry &entry = m_book[tick];
-                entry.bidQty = bidQty;
-                entry.askQty = askQty;
-            }
-        }
-    }
-
-    m_hasBook = !m_book.isEmpty();
-    if (m_hasBook) {
-        m_bufferMinTick = j.value("windowMinTick", m_book.firstKey());
-        m_bufferMaxTick = j.value("windowMaxTick", m_book.lastKey());
-        m_centerTick = j.value("centerTick", (m_bufferMinTick + m_bufferMaxTick) / 2);
-        emit bookRangeUpdated(m_bufferMinTick, m_bufferMaxTick, m_centerTick, m_lastTickSize);
-    } else {
-        m_bufferMinTick = 0;
-        m_bufferMaxTick = 0;
-        m_centerTick = 0;
-    }
-}
-
-void LadderClient::applyDeltaLadderMessage(const json &j)
+bool LadderClient::createSharedSegment()
 {
-    if (!m_hasBook) {
-        applyFullLadderMessage(j);
-        return;
-    }
-
-    m_bestBid = j.value("bestBid", m_bestBid);
-    m_bestAsk = j.value("bestAsk", m_bestAsk);
-    const double tickSize = j.value("tickSize", 0.0);
-    if (tickSize > 0.0) {
-        m_lastTickSize = tickSize;
-    }
-
-    auto updatesIt = j.find("updates");
-    if (updatesIt != j.end() && updatesIt->is_array() && m_lastTickSize > 0.0) {
-        for (const auto &row : *updatesIt) {
-            qint64 tick = 0;
-            if (row.contains("tick") && parseTickValue(row["tick"], tick)) {
-            } else {
-                const double price = row.value("price", 0.0);
-                tick = static_cast<qint64>(std::llround(price / m_lastTickSize));
-            }
-            BookEntry &entry = m_book[tick];
-            entry.bidQty = row.value("bid", entry.bidQty);
-            entry.askQty = row.value("ask", entry.askQty);
-        }
-    }
-
-    auto removalsIt = j.find("removals");
-    if (removalsIt != j.end() && removalsIt->is_array()) {
-        for (const auto &tickValue : *removalsIt) {
-            if (tickValue.is_number_integer()) {
-                const qint64 tick = static_cast<qint64>(tickValue.get<std::int64_t>());
-                m_book.remove(tick);
-            }
-        }
+    if (m_levels <= 0) {
+        // Full-book mode has no fixed window to size the segment for.
+        return false;
     }
+    static quint64 serial = 0;
+    const QString key = QStringLiteral("PlasmaLadder_%1_%2")
+                            .arg(QCoreApplication::applicationPid())
+                            .arg(++serial);
+    const auto rows = static_cast<std::uint32_t>(m_levels) * 2u + 1u;
+    const std::size_t size = dom::shm::segmentSize(rows, dom::shm::kDefaultTradeCapacity);
 
-    const qint64 minTick = j.value("windowMinTick", m_bufferMinTick);
-    const qint64 maxTick = j.value("windowMaxTick", m_bufferMaxTick);
-    if (minTick <= maxTick) {
-        m_bufferMinTick = minTick;
-        m_bufferMaxTick = maxTick;
-    }
-    m_centerTick = j.value("centerTick", m_centerTick);
-    trimBookToWindow(m_bufferMinTick, m_bufferMaxTick);
-
-    m_hasBook = !m_book.isEmpty();
-    if (m_hasBook) {
-        emit bookRangeUpdated(m_bufferMinTick, m_bufferMaxTick, m_centerTick, m_lastTickSize);
-    } else {
-        m_bufferMinTick = 0;
-        m_bufferMaxTick = 0;
-        m_centerTick = 0;
+    auto shm = std::make_unique<QSharedMemory>();
+    shm->setNativeKey(key);
+    if (!shm->create(static_cast<qsizetype>(size))) {
+        qWarning() << "[LadderClient] shared segment unavailable:" << shm->errorString();
+        logBackendEvent(QStringLiteral("shm create failed: %1").arg(shm->errorString()));
+        return false;
     }
+    m_shmSegment = dom::shm::Segment::create(shm->data(), size, rows, dom::shm::kDefaultTradeCapacity);
+    m_shmBids.assign(rows, 0.0);
+    m_shmAsks.assign(rows, 0.0);
+    m_shm = std::move(shm);
+    m_shmActive = true;
+    return true;
 }
 
-void LadderClient::trimBookToWindow(qint64 minTick, qint64 maxTick)
+std::shared_ptr<QSharedMemory> LadderClient::releaseSharedSegment()
 {
-    if (minTick > maxTick) {
-        return;
-    }
-    auto it = m_book.begin();
-    while (it != m_book.end()) {
-        if (it.key() < minTick || it.key() > maxTick) {
-            it = m_book.erase(it);
-        } else {
-            ++it;
-        }
-    }
+    m_shmActive = false;
+    m_shmSegment = dom::shm::Segment{};
+    return std::move(m_shm);
 }
+
 void LadderClient::emitStatus(const QString &msg)
 {
     const QString symbol = m_symbol.toUpper();
@@ -939,20 +823,52 @@ void LadderClient::handleWatchdogTimeout()
                    .arg(m_watchdogIntervalMs / 1000));
     restart(m_symbol, m_levels, m_exchange);
 }
-DomSnapshot LadderClient::buildSnapshot(qint64 minTick, qint64 maxTick) const
+void LadderClient::resetSnapshot(DomSnapshot &snap)
 {
-    DomSnapshot snap;
+    snap.levels.resize(0); // keeps the capacity for the next frame
+    snap.bestBid = 0.0;
+    snap.bestAsk = 0.0;
+    snap.tickSize = 0.0;
+    snap.minTick = 0;
+    snap.maxTick = 0;
+    snap.compression = 1;
+}
+
+bool LadderClient::buildSnapshot(const LadderBookState &state, qint64 minTick, qint64 maxTick, DomSnapshot &snap) const
+{
+    resetSnapshot(snap);
     if (minTick > maxTick) {
         std::swap(minTick, maxTick);
     }
-    snap.tickSize = m_lastTickSize;
-    snap.bestBid = m_bestBid;
-    snap.bestAsk = m_bestAsk;
-    if (m_lastTickSize <= 0.0 || m_book.isEmpty()) {
-        return snap;
+    snap.tickSize = state.tickSize;
+    snap.bestBid = state.bestBid;
+    snap.bestAsk = state.bestAsk;
+    const bool shared = m_shmActive && state.shmActive;
+    if (state.tickSize <= 0.0 || (!shared && !state.book.hasWindow())) {
+        return false;
+    }
+
+    // Shared-memory mode: take a consistent copy of the published window now,
+    // at frame time, instead of keeping a second book in the GUI.
+    dom::wire::LadderHeader sharedLadder;
+    std::uint32_t sharedRows = 0;
+    std::uint32_t sharedCompression = 1;
+    if (shared) {
+        if (!m_shmSegment.readLadder(sharedLadder, m_shmBids.data(), m_shmAsks.data(), sharedRows,
+                                     sharedCompression)) {
+            return false;
+        }
+        snap.bestBid = sharedLadder.bestBid;
+        snap.bestAsk = sharedLadder.bestAsk;
     }
 
     const qint64 compression = std::max<qint64>(1, m_tickCompression);
+    // Rows the backend summed for another compression (it has not seen the
+    // new one yet) cannot be regrouped; keep the previous frame until it has.
+    const bool sharedBuckets = shared && sharedCompression > 1;
+    if (sharedBuckets && static_cast<qint64>(sharedCompression) != compression) {
+        return false;
+    }
     snap.compression = compression;
     auto floorBucket = [compression](qint64 tick) -> qint64 {
         if (compression == 1) {
@@ -984,42 +900,95 @@ DomSnapshot LadderClient::buildSnapshot(qint64 minTick, qint64 maxTick) const
     snap.minTick = bucketMinTick;
     snap.maxTick = bucketMaxTick;
     if (bucketMaxTick < bucketMinTick) {
-        return snap;
+        return true;
     }
     const qint64 bucketCount = (bucketMaxTick - bucketMinTick) / compression + 1;
     if (bucketCount <= 0 || bucketCount > 2000000) {
-        return snap;
+        return true;
     }
 
-    QVector<DomLevel> buckets;
-    buckets.resize(static_cast<int>(bucketCount));
+    // Levels are written in place, top row first; resize() reuses the
+    // caller's storage once it has grown to the visible row count.
+    snap.levels.resize(static_cast<int>(bucketCount));
+    DomLevel *levels = snap.levels.data();
     for (qint64 i = 0; i < bucketCount; ++i) {
-        const qint64 bucketTick = bucketMinTick + i * compression;
-        buckets[static_cast<int>(i)].tick = bucketTick;
-        buckets[static_cast<int>(i)].price = static_cast<double>(bucketTick) * snap.tickSize;
+        const qint64 bucketTick = bucketMaxTick - i * compression;
+        DomLevel &level = levels[i];
+        level.tick = bucketTick;
+        level.price = static_cast<double>(bucketTick) * snap.tickSize;
+        level.bidQty = 0.0;
+        level.askQty = 0.0;
     }
 
-    auto it = m_book.lowerBound(minTick);
-    for (; it != m_book.constEnd() && it.key() <= maxTick; ++it) {
-        if (it->bidQty > 0.0) {
-            const qint64 bucketTick = floorBucket(it.key());
-            const qint64 idx = (bucketTick - bucketMinTick) / compression;
+    auto addLevel = [&](qint64 tick, double bidQty, double askQty) {
+        if (bidQty > 0.0) {
+            const qint64 idx = (bucketMaxTick - floorBucket(tick)) / compression;
             if (idx >= 0 && idx < bucketCount) {
-                buckets[static_cast<int>(idx)].bidQty += it->bidQty;
+                levels[idx].bidQty += bidQty;
             }
         }
-        if (it->askQty > 0.0) {
-            const qint64 bucketTick = ceilBucket(it.key());
-            const qint64 idx = (bucketTick - bucketMinTick) / compression;
+        if (askQty > 0.0) {
+            const qint64 idx = (bucketMaxTick - ceilBucket(tick)) / compression;
             if (idx >= 0 && idx < bucketCount) {
-                buckets[static_cast<int>(idx)].askQty += it->askQty;
+                levels[idx].askQty += askQty;
             }
         }
-    }
+    };
 
-    snap.levels.reserve(buckets.size());
-    for (int i = buckets.size() - 1; i >= 0; --i) {
-        snap.levels.push_back(buckets[i]);
+    if (sharedBuckets) {
+        // Row i is the bucket at windowMaxTick - i * compression, already summed
+        // by the backend (OrderBook::compressedLadderRows).
+        const qint64 top = static_cast<qint64>(sharedLadder.windowMaxTick);
+        for (qint64 i = 0; i < bucketCount; ++i) {
+            const qint64 row = (top - levels[i].tick) / compression;
+            if (row >= 0 && row < static_cast<qint64>(sharedRows)) {
+                levels[i].bidQty = m_shmBids[static_cast<std::size_t>(row)];
+                levels[i].askQty = m_shmAsks[static_cast<std::size_t>(row)];
+            }
+        }
+    } else if (shared) {
+        // Row i is tick windowMaxTick - i; visit only rows inside [minTick, maxTick].
+        const qint64 top = static_cast<qint64>(sharedLadder.windowMaxTick);
+        const qint64 firstRow = std::max<qint64>(0, top - maxTick);
+        const qint64 lastRow = std::min<qint64>(static_cast<qint64>(sharedRows) - 1, top - minTick);
+        for (qint64 row = firstRow; row <= lastRow; ++row) {
+            addLevel(top - row,
+                     m_shmBids[static_cast<std::size_t>(row)],
+                     m_shmAsks[static_cast<std::size_t>(row)]);
+        }
+    } else if (compression > 1 && state.book.compression() == compression) {
+        // Buckets wholly inside [minTick, maxTick] come from the worker's
+        // cache; only the clipped edge buckets are summed here.
+        for (qint64 i = 0; i < bucketCount; ++i) {
+            DomLevel &level = levels[i];
+            const qint64 bucketTick = level.tick;
+            if (bucketTick >= minTick && bucketTick + compression - 1 <= maxTick) {
+                level.bidQty = state.book.bucketBid(bucketTick);
+            } else {
+                state.book.forEach(std::max(bucketTick, minTick),
+                                   std::min(bucketTick + compression - 1, maxTick),
+                                   [&level](qint64, const LadderBookEntry &entry) {
+                                       if (entry.bidQty > 0.0) {
+                                           level.bidQty += entry.bidQty;
+                                       }
+                                   });
+            }
+            if (bucketTick - compression + 1 >= minTick && bucketTick <= maxTick) {
+                level.askQty = state.book.bucketAsk(bucketTick);
+            } else {
+                state.book.forEach(std::max(bucketTick - compression + 1, minTick),
+                                   std::min(bucketTick, maxTick),
+                                   [&level](qint64, const LadderBookEntry &entry) {
+                                       if (entry.askQty > 0.0) {
+                                           level.askQty += entry.askQty;
+                                       }
+                                   });
+            }
+        }
+    } else {
+        state.book.forEach(minTick, maxTick, [&](qint64 tick, const LadderBookEntry &entry) {
+            addLevel(tick, entry.bidQty, entry.askQty);
+        });
     }
-    return snap;
+    return true;
 }
@@ -3,19 +3,26 @@
 #pragma once
 
 #include "DomWidget.h"
+#include "LadderIngest.h"
+#include "LadderShm.hpp"
 #include "PrintsWidget.h"
 #include <json.hpp>
 
 #include <QByteArray>
 #include <QObject>
 #include <QProcess>
+#include <QSharedMemory>
 #include <QString>
+#include <QThread>
 #include <QTimer>
 #include <QVector>
-#include <QMap>
+
+#include <memory>
+#include <vector>
 
 class LadderClient : public QObject {
     Q_OBJECT
+    friend class LadderBackendHub;
 
 public:
     explicit LadderClient(const QString &backendPath,
@@ -28,7 +35,12 @@ public:
                           const QString &proxy = QString());
     ~LadderClient() override;
 
+    // Does not wait for the old process: the new one starts once it has exited.
     void restart(const QString &symbol, int levels, const QString &exchange = QString());
+    // Applies a symbol or level change to the running backend through its
+    // control channel when it can, keeping the process and its connection;
+    // anything else goes through restart().
+    void reconfigure(const QString &symbol, int levels, const QString &exchange = QString());
     void stop();
     bool isRunning() const;
     void setProxy(const QString &proxyType, const QString &proxy);
@@ -36,12 +48,24 @@ public:
     int compression() const { return m_tickCompression; }
     void shiftWindowTicks(qint64 ticks);
     void resetManualCenter();
-    DomSnapshot snapshotForRange(qint64 minTick, qint64 maxTick) const;
+    // Tells the backend which ticks are on screen and the current compression;
+    // it holds back changes far from them and sums shared-segment rows to that
+    // compression. Cheap to call every frame: only a change is sent.
+    void setViewport(qint64 bottomTick, qint64 topTick);
+    // Fills `out` in place (its level storage is reused); false when there is no book yet.
+    bool snapshotForRange(qint64 minTick, qint64 maxTick, DomSnapshot &out) const;
     qint64 bufferMinTick() const { return m_bufferMinTick; }
     qint64 bufferMaxTick() const { return m_bufferMaxTick; }
+    // Over the pipe the backend streams everything it caches (--deep-book), so
+    // the buffer already holds all the depth there is and shiftWindowTicks()
+    // would only cost a round-trip. A shared segment carries the ladder window only.
+    bool streamsDeepBook() const { return !m_shmActive; }
     qint64 centerTick() const { return m_centerTick; }
     double tickSize() const { return m_lastTickSize; }
     bool hasBook() const { return m_hasBook; }
+    // Bumped whenever snapshotForRange() may build something different for the
+    // same range: a new ladder, a dropped book or a compression change.
+    quint64 revision() const { return m_revision; }
 
 private slots:
     void handleReadyRead();
@@ -49,6 +73,7 @@ private slots:
     void handleErrorOccurred(QProcess::ProcessError error);
     void handleFinished(int exitCode, QProcess::ExitStatus status);
     void handleWatchdogTimeout();
+    void handleIngestPublished();
 
 signals:
     void statusMessage(const QString &message);
@@ -57,23 +82,36 @@ signals:
 
 private:
     void emitStatus(const QString &msg);
-    void processLine(const QByteArray &line);
+    void handleStderrText(const QString &text);
+    void handleResubscribeFailed(const QString &wireSymbol, const QString &error);
+    QString wireSymbolFor(const QString &symbol) const;
+    void clearPrints();
+    // False when the command could not be written (no running backend).
+    bool sendCommand(const nlohmann::json &cmd);
+    // Hands backend stdout (whole frames or '\n'-terminated lines) to the ingest worker.
+    void feedIngest(const char *data, std::size_t size);
+    // Starts a new ingest epoch on the current segment; see LadderIngest::reset().
+    void resetIngest(std::shared_ptr<QSharedMemory> oldSegment);
     void armWatchdog();
+    // A new backend process knows no viewport yet.
+    void forgetViewport()
+    {
+        m_sentViewportBottom = 0;
+        m_sentViewportTop = -1;
+        m_sentViewportCompression = 0;
+    }
     void logBackendLine(const QString &line);
     void logBackendEvent(const QString &line);
     QString backendLogPath() const;
     QString formatBackendPrefix() const;
     QString formatCrashSummary(int exitCode, QProcess::ExitStatus status) const;
-    void applyFullLadderMessage(const nlohmann::json &j);
-    void applyDeltaLadderMessage(const nlohmann::json &j);
-    void trimBookToWindow(qint64 minTick, qint64 maxTick);
-
-    DomSnapshot buildSnapshot(qint64 minTick, qint64 maxTick) const;
+    bool createSharedSegment();
+    // Returns the mapping; the caller keeps it while the worker may read it.
+    std::shared_ptr<QSharedMemory> releaseSharedSegment();
+    void emitPing(qint64 timestampMs);
 
-    struct BookEntry {
-        double bidQty = 0.0;
-        double askQty = 0.0;
-    };
+    static void resetSnapshot(DomSnapshot &snap);
+    bool buildSnapshot(const LadderBookState &state, qint64 minTick, qint64 maxTick, DomSnapshot &snap) const;
 
     QString m_backendPath;
     QString m_symbol;
@@ -81,29 +119,52 @@ private:
     QString m_exchange;
     QString m_proxyType;
     QString m_proxy;
+    // Proxy settings the running backend was started with.
+    QString m_startedProxyType;
+    QString m_startedProxy;
     QProcess m_process;
-    QByteArray m_buffer;
     class PrintsWidget *m_prints;
-    QVector<PrintItem> m_printBuffer;
-    quint64 m_printSeq = 0;
+    // Parsing and book upkeep run on m_ingestThread.
+    QThread m_ingestThread;
+    LadderIngest *m_ingest = nullptr;
+    quint64 m_seenLadderSeq = 0;
+    quint64 m_seenPrintSeq = 0;
+    quint64 m_seenBookEpoch = 0;
+    quint64 m_ingestEpoch = 0; // last resetIngest(); older published states are ignored
+    qint64 m_sentViewportBottom = 0;
+    qint64 m_sentViewportTop = -1;
+    int m_sentViewportCompression = 0;
     QTimer m_watchdogTimer;
     qint64 m_lastUpdateMs = 0;
     const int m_watchdogIntervalMs = 15000;
     int m_tickCompression = 1;
-    QMap<qint64, BookEntry> m_book; // ascending ticks
+    // Last state taken from m_ingest in handleIngestPublished().
     qint64 m_bufferMinTick = 0;
     qint64 m_bufferMaxTick = 0;
     qint64 m_centerTick = 0;
     double m_lastTickSize = 0.0;
     bool m_hasBook = false;
-    double m_bestBid = 0.0;
-    double m_bestAsk = 0.0;
+    quint64 m_revision = 1;
     bool m_stopRequested = false;
+    // Backend is a shared LadderBackendHub process rather than m_process.
+    bool m_useHub = false;
+
+    // Shared-memory transport: the backend publishes the ladder window here and
+    // snapshots read it directly, so the ingest book stays empty while this is active.
+    // The worker drains the trade ring; the mapping outlives its use there.
+    std::shared_ptr<QSharedMemory> m_shm;
+    dom::shm::Segment m_shmSegment;
+    bool m_shmActive = false;
+    mutable std::vector<double> m_shmBids;
+    mutable std::vector<double> m_shmAsks;
 
     QStringList m_recentStderr;
     int m_lastExitCode = 0;
     QProcess::ExitStatus m_lastExitStatus = QProcess::NormalExit;
     QProcess::ProcessError m_lastProcessError = QProcess::UnknownError;
     QString m_lastProcessErrorString;
-    bool m_restartInProgress = false;
+    // restart() killed m_process and did not wait; its exit is expected and its
+    // remaining output is dropped. m_startPending starts the next one then.
+    bool m_replacingProcess = false;
+    bool m_startPending = false;
 };
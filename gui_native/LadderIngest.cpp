@@ -0,0 +1,735 @@
+#include "LadderIngest.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QMetaObject>
+#include <QMutexLocker>
+
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace {
+static bool parseTickValue(const json &value, qint64 &outTick)
+{
+    try {
+        if (value.is_number_integer()) {
+            outTick = static_cast<qint64>(value.get<std::int64_t>());
+            return true;
+        }
+        if (value.is_number_float()) {
+            const double d = value.get<double>();
+            if (!std::isfinite(d)) {
+                return false;
+            }
+            outTick = static_cast<qint64>(std::llround(d));
+            return true;
+        }
+        if (value.is_string()) {
+            const std::string s = value.get<std::string>();
+            if (s.empty()) {
+                return false;
+            }
+            std::size_t idx = 0;
+            const long long v = std::stoll(s, &idx, 10);
+            if (idx == 0) {
+                return false;
+            }
+            outTick = static_cast<qint64>(v);
+            return true;
+        }
+    } catch (...) {
+        return false;
+    }
+    return false;
+}
+
+static qint64 pow10i(int exp)
+{
+    qint64 v = 1;
+    for (int i = 0; i < exp; ++i) {
+        v *= 10;
+    }
+    return v;
+}
+
+static bool chooseScaleForTickSize(double tickSize, qint64 &outScale, qint64 &outTickSizeScaled)
+{
+    if (!(tickSize > 0.0) || !std::isfinite(tickSize)) {
+        return false;
+    }
+    for (int decimals = 0; decimals <= 12; ++decimals) {
+        const qint64 scale = pow10i(decimals);
+        const double scaled = tickSize * static_cast<double>(scale);
+        if (!std::isfinite(scaled)) {
+            continue;
+        }
+        const qint64 rounded = static_cast<qint64>(std::llround(scaled));
+        if (rounded <= 0) {
+            continue;
+        }
+        if (std::abs(scaled - static_cast<double>(rounded)) <= 1e-9) {
+            outScale = scale;
+            outTickSizeScaled = rounded;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool parseDecimalToScaledInt(const json &value, int decimals, qint64 &out)
+{
+    if (decimals < 0 || decimals > 12) {
+        return false;
+    }
+
+    std::string s;
+    if (value.is_string()) {
+        s = value.get<std::string>();
+    } else if (value.is_number()) {
+        s = value.dump();
+    } else {
+        return false;
+    }
+
+    if (s.empty()) {
+        return false;
+    }
+
+    bool neg = false;
+    size_t pos = 0;
+    if (s[pos] == '-') {
+        neg = true;
+        ++pos;
+    } else if (s[pos] == '+') {
+        ++pos;
+    }
+
+    qint64 intPart = 0;
+    bool anyDigit = false;
+    while (pos < s.size() && std::isdigit(static_cast<unsigned char>(s[pos]))) {
+        anyDigit = true;
+        intPart = intPart * 10 + (s[pos] - '0');
+        ++pos;
+    }
+
+    qint64 fracPart = 0;
+    int fracDigits = 0;
+    int nextDigit = -1;
+    if (pos < s.size() && s[pos] == '.') {
+        ++pos;
+        while (pos < s.size() && std::isdigit(static_cast<unsigned char>(s[pos]))) {
+            anyDigit = true;
+            if (fracDigits < decimals) {
+                fracPart = fracPart * 10 + (s[pos] - '0');
+                ++fracDigits;
+            } else if (nextDigit < 0) {
+                nextDigit = (s[pos] - '0');
+            }
+            ++pos;
+        }
+    }
+
+    if (!anyDigit) {
+        return false;
+    }
+
+    while (fracDigits < decimals) {
+        fracPart *= 10;
+        ++fracDigits;
+    }
+
+    if (nextDigit >= 5) {
+        fracPart += 1;
+        const qint64 scale = pow10i(decimals);
+        if (fracPart >= scale) {
+            fracPart -= scale;
+            intPart += 1;
+        }
+    }
+
+    const qint64 scale = pow10i(decimals);
+    qint64 result = intPart * scale + fracPart;
+    if (neg) {
+        result = -result;
+    }
+    out = result;
+    return true;
+}
+
+static bool quantizePriceToTick(const json &priceValue,
+                                double tickSize,
+                                qint64 &outTick,
+                                double &outSnappedPrice)
+{
+    qint64 scale = 0;
+    qint64 tickSizeScaled = 0;
+    if (!chooseScaleForTickSize(tickSize, scale, tickSizeScaled)) {
+        return false;
+    }
+    int decimals = 0;
+    qint64 tmp = scale;
+    while (tmp > 1) {
+        tmp /= 10;
+        ++decimals;
+    }
+
+    qint64 priceScaled = 0;
+    if (!parseDecimalToScaledInt(priceValue, decimals, priceScaled)) {
+        return false;
+    }
+
+    qint64 tick = 0;
+    if (priceScaled >= 0) {
+        tick = (priceScaled + tickSizeScaled / 2) / tickSizeScaled;
+    } else {
+        tick = -((-priceScaled + tickSizeScaled / 2) / tickSizeScaled);
+    }
+
+    const qint64 snappedScaled = tick * tickSizeScaled;
+    outTick = tick;
+    outSnappedPrice = static_cast<double>(snappedScaled) / static_cast<double>(scale);
+    return std::isfinite(outSnappedPrice);
+}
+} // namespace
+
+LadderIngest::LadderIngest(bool keepPrints, QObject *parent)
+    : QObject(parent)
+    , m_keepPrints(keepPrints)
+{
+}
+
+void LadderIngest::feed(const QByteArray &bytes)
+{
+    if (bytes.isEmpty()) {
+        return;
+    }
+    {
+        QMutexLocker lock(&m_inputMutex);
+        m_input += bytes;
+        if (m_drainQueued) {
+            return;
+        }
+        m_drainQueued = true;
+    }
+    wake();
+}
+
+void LadderIngest::feed(const char *data, std::size_t size)
+{
+    if (size == 0) {
+        return;
+    }
+    {
+        QMutexLocker lock(&m_inputMutex);
+        m_input.append(data, static_cast<qsizetype>(size));
+        if (m_drainQueued) {
+            return;
+        }
+        m_drainQueued = true;
+    }
+    wake();
+}
+
+void LadderIngest::reset(quint64 epoch, const dom::shm::Segment &segment, std::shared_ptr<void> retired)
+{
+    {
+        QMutexLocker lock(&m_inputMutex);
+        m_input.clear();
+        m_inputEpoch = epoch;
+        m_inputSegment = segment;
+        if (retired) {
+            m_retired.push_back(std::move(retired));
+        }
+        if (m_drainQueued) {
+            return;
+        }
+        m_drainQueued = true;
+    }
+    wake();
+}
+
+void LadderIngest::wake()
+{
+    QMetaObject::invokeMethod(this, [this]() { drain(); }, Qt::QueuedConnection);
+}
+
+void LadderIngest::clearBook()
+{
+    m_book.clear();
+    m_tickSize = 0.0;
+    m_bestBid = 0.0;
+    m_bestAsk = 0.0;
+    m_minTick = 0;
+    m_maxTick = 0;
+    m_centerTick = 0;
+    m_hasBook = false;
+    m_printBuffer.clear();
+}
+
+void LadderIngest::setCompression(qint64 compression)
+{
+    if (compression == m_book.compression()) {
+        return;
+    }
+    m_book.setCompression(compression);
+    publish();
+}
+
+void LadderIngest::drain()
+{
+    std::vector<std::shared_ptr<void>> retired;
+    m_changed = false;
+    {
+        QMutexLocker lock(&m_inputMutex);
+        m_drainQueued = false;
+        if (m_inputEpoch != m_resetEpoch) {
+            // reset(): a partial frame of the old stream must not prefix the new one.
+            m_resetEpoch = m_inputEpoch;
+            m_buffer.clear();
+            clearBook();
+            m_shmSegment = m_inputSegment;
+            m_shmActive = m_shmSegment.valid();
+            retired.swap(m_retired); // released below, after the old segment was let go
+            m_changed = true;
+        }
+        if (m_buffer.isEmpty()) {
+            m_buffer.swap(m_input);
+        } else {
+            m_buffer += m_input;
+            m_input.clear();
+        }
+    }
+    if (m_buffer.isEmpty()) {
+        if (m_changed) {
+            publish();
+        }
+        return;
+    }
+
+    // Everything that arrived since the last wake-up is parsed here and
+    // published once, so a burst costs the GUI a single snapshot swap.
+    bool desync = false;
+    const std::size_t consumed = dom::wire::consumeStream(
+        m_buffer.constData(),
+        static_cast<std::size_t>(m_buffer.size()),
+        [this](const dom::wire::FrameHeader &frame, const char *payload) {
+            processFrame(frame.type, payload, frame.payloadSize);
+        },
+        [this](const char *data, std::size_t length) {
+            processLine(data, length);
+        },
+        desync);
+    if (desync) {
+        qWarning() << "[LadderClient] bad frame size - dropping buffered output";
+        emit statusMessage(QStringLiteral("Backend stream out of sync, dropping buffered output"));
+        m_buffer.clear();
+    } else {
+        m_buffer.remove(0, static_cast<qsizetype>(consumed));
+    }
+    if (m_changed) {
+        publish();
+    }
+}
+
+void LadderIngest::publish()
+{
+    m_book.updateBuckets();
+    LadderBookState &state = m_states.back();
+    state.book.syncFrom(m_book); // the slot's own ring: no sharing, no detach on the next write
+    state.tickSize = m_tickSize;
+    state.bestBid = m_bestBid;
+    state.bestAsk = m_bestAsk;
+    state.minTick = m_minTick;
+    state.maxTick = m_maxTick;
+    state.centerTick = m_centerTick;
+    state.hasBook = m_hasBook;
+    state.shmActive = m_shmActive;
+    state.ladderSeq = m_ladderSeq;
+    state.bookEpoch = m_bookEpoch;
+    state.resetEpoch = m_resetEpoch;
+    state.timestampMs = m_timestampMs;
+    state.prints = m_printBuffer;
+    state.printSeq = m_printSeq;
+    m_states.publish();
+
+    if (!m_notifyPending.exchange(true, std::memory_order_acq_rel)) {
+        emit published();
+    }
+}
+
+void LadderIngest::processLine(const char *data, std::size_t size)
+{
+    const QByteArray line = QByteArray::fromRawData(data, static_cast<qsizetype>(size));
+    if (line.trimmed().isEmpty()) {
+        return;
+    }
+
+    json j;
+    try {
+        j = json::parse(data, data + size);
+    } catch (const std::exception &ex) {
+        qWarning() << "[LadderClient] parse error:" << ex.what();
+        emit statusMessage("Parse error: " + QString::fromUtf8(ex.what()));
+        return;
+    }
+
+    const std::string type = j.value("type", std::string());
+    if (type == "trade") {
+        if (!m_keepPrints) {
+            return;
+        }
+        double price = j.value("price", 0.0);
+        const double qtyBase = j.value("qty", 0.0);
+        const std::string side = j.value("side", std::string("buy"));
+        if (price <= 0.0 || qtyBase <= 0.0) {
+            return;
+        }
+        qint64 tick = 0;
+        if (j.contains("tick") && parseTickValue(j["tick"], tick)) {
+            if (m_tickSize > 0.0) {
+                price = static_cast<double>(tick) * m_tickSize;
+            }
+        }
+        if (tick == 0 && m_tickSize > 0.0) {
+            auto priceIt = j.find("price");
+            double snappedPrice = 0.0;
+            if (priceIt != j.end() && quantizePriceToTick(*priceIt, m_tickSize, tick, snappedPrice)) {
+                price = snappedPrice;
+            } else {
+                tick = static_cast<qint64>(std::llround(price / m_tickSize));
+                price = static_cast<double>(tick) * m_tickSize;
+            }
+        }
+
+        appendPrint(price, qtyBase, side != "sell", tick);
+        return;
+    }
+
+    if (type == "resubscribed") {
+        // Everything before this line in the stream belongs to the old symbol;
+        // the new full ladder follows. The shared segment stays in use.
+        clearBook();
+        ++m_bookEpoch;
+        m_changed = true;
+        return;
+    }
+    if (type == "resubscribe_failed") {
+        emit resubscribeFailed(QString::fromStdString(j.value("symbol", std::string())),
+                               QString::fromStdString(j.value("error", std::string())));
+        return;
+    }
+
+    if (type == "ladder_delta") {
+        applyDeltaLadderMessage(j);
+    } else if (type == "ladder") {
+        applyFullLadderMessage(j);
+    } else {
+        return;
+    }
+
+    const auto tsIt = j.find("timestamp");
+    if (tsIt != j.end() && tsIt->is_number_integer()) {
+        m_timestampMs = static_cast<qint64>(tsIt->get<std::int64_t>());
+    }
+}
+
+void LadderIngest::processFrame(dom::wire::FrameType type, const char *payload, std::size_t size)
+{
+    switch (type) {
+    case dom::wire::FrameType::Trade: {
+        if (!m_keepPrints) {
+            return;
+        }
+        dom::wire::Trade trade;
+        if (!dom::wire::parseTrade(payload, size, trade)) {
+            qWarning() << "[LadderClient] truncated trade frame";
+            return;
+        }
+        appendWireTrade(trade.tick, trade.price, trade.qty, trade.flags);
+        return;
+    }
+    case dom::wire::FrameType::ShmTrades:
+        if (!m_shmActive) {
+            return;
+        }
+        // Always advance the read cursor so the backend never sees a full ring.
+        m_shmSegment.drainTrades([this](const dom::shm::TradeSlot &trade) {
+            if (m_keepPrints) {
+                appendWireTrade(trade.tick, trade.price, trade.qty, static_cast<unsigned>(trade.flags));
+            }
+        });
+        return;
+    case dom::wire::FrameType::ShmLadder: {
+        dom::wire::LadderHeader header;
+        if (!dom::wire::parseLadderHeader(payload, size, header)) {
+            qWarning() << "[LadderClient] truncated shm ladder frame";
+            return;
+        }
+        applyLadderHeader(header);
+        m_hasBook = header.windowMinTick <= header.windowMaxTick && (m_bestBid > 0.0 || m_bestAsk > 0.0);
+        if (m_hasBook) {
+            m_minTick = header.windowMinTick;
+            m_maxTick = header.windowMaxTick;
+            m_centerTick = header.centerTick;
+        } else {
+            m_minTick = 0;
+            m_maxTick = 0;
+            m_centerTick = 0;
+        }
+        ++m_ladderSeq;
+        m_changed = true;
+        return;
+    }
+    case dom::wire::FrameType::Ladder:
+    case dom::wire::FrameType::LadderSparse:
+    case dom::wire::FrameType::LadderDelta: {
+        dom::wire::LadderFrame frame;
+        if (!dom::wire::parseLadder(type, payload, size, frame)) {
+            qWarning() << "[LadderClient] truncated ladder frame";
+            return;
+        }
+        if (m_shmActive) {
+            // Backend could not open the segment and fell back to the pipe;
+            // LadderClient releases the mapping once it sees shmActive drop.
+            qWarning() << "[LadderClient] backend sends ladders over stdout, dropping shared segment";
+            m_shmSegment = dom::shm::Segment{};
+            m_shmActive = false;
+        }
+        if (type == dom::wire::FrameType::LadderDelta) {
+            applyDeltaLadderFrame(frame);
+        } else {
+            applyFullLadderFrame(frame);
+        }
+        return;
+    }
+    }
+    qWarning() << "[LadderClient] unknown frame type" << static_cast<int>(type);
+}
+
+void LadderIngest::appendWireTrade(std::int64_t wireTick, double price, double qty, unsigned flags)
+{
+    if (price <= 0.0 || qty <= 0.0) {
+        return;
+    }
+    qint64 tick = 0;
+    if (m_tickSize > 0.0) {
+        tick = (flags & dom::wire::TradeHasTick)
+                   ? static_cast<qint64>(wireTick)
+                   : static_cast<qint64>(std::llround(price / m_tickSize));
+        price = static_cast<double>(tick) * m_tickSize;
+    } else if (flags & dom::wire::TradeHasTick) {
+        tick = static_cast<qint64>(wireTick);
+    }
+    appendPrint(price, qty, (flags & dom::wire::TradeBuy) != 0, tick);
+}
+
+void LadderIngest::appendPrint(double price, double qtyBase, bool buy, qint64 tick)
+{
+    const double qtyQuote = price * qtyBase;
+    if (qtyQuote <= 0.0) {
+        return;
+    }
+
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    PrintItem it;
+    it.price = price;
+    it.qty = qtyQuote;
+    it.buy = buy;
+    it.rowHint = -1;
+    it.tick = tick;
+    it.timeMs = nowMs;
+    it.seq = ++m_printSeq;
+    m_printBuffer.push_back(it);
+    // IMPORTANT: prints UI only renders a small tail (<= ~64 slots). Keeping thousands of prints
+    // and shifting the vector on every trade can freeze the whole UI on high-throughput symbols
+    // like BTC. Keep a small rolling buffer instead.
+    const int maxPrints = PrintsWidget::kMaxPrints;
+    if (m_printBuffer.size() > maxPrints) {
+        m_printBuffer.erase(m_printBuffer.begin(),
+                            m_printBuffer.begin() + (m_printBuffer.size() - maxPrints));
+    }
+    m_changed = true;
+}
+
+void LadderIngest::applyLadderHeader(const dom::wire::LadderHeader &header)
+{
+    m_bestBid = header.bestBid;
+    m_bestAsk = header.bestAsk;
+    if (header.tickSize > 0.0) {
+        m_tickSize = header.tickSize;
+    }
+    m_timestampMs = static_cast<qint64>(header.timestamp);
+}
+
+void LadderIngest::applyFullLadderMessage(const json &j)
+{
+    m_bestBid = j.value("bestBid", 0.0);
+    m_bestAsk = j.value("bestAsk", 0.0);
+    const double tickSize = j.value("tickSize", 0.0);
+    if (tickSize > 0.0) {
+        m_tickSize = tickSize;
+    }
+
+    auto rowsIt = j.find("rows");
+    if (rowsIt != j.end() && rowsIt->is_array()) {
+        m_book.clear();
+        // "sparse" ladders (--deep-book) list only non-empty rows, possibly none.
+        if (m_tickSize > 0.0 && (!rowsIt->empty() || j.value("sparse", false))) {
+            // The window is only known after the rows when the message omits it.
+            std::vector<std::pair<qint64, LadderBookEntry>> rows;
+            rows.reserve(rowsIt->size());
+            qint64 lowTick = std::numeric_limits<qint64>::max();
+            qint64 highTick = std::numeric_limits<qint64>::min();
+            for (const auto &row : *rowsIt) {
+                qint64 tick = 0;
+                if (row.contains("tick") && parseTickValue(row["tick"], tick)) {
+                } else {
+                    const double price = row.value("price", 0.0);
+                    tick = static_cast<qint64>(std::llround(price / m_tickSize));
+                }
+                rows.push_back({tick, LadderBookEntry{row.value("bid", 0.0), row.value("ask", 0.0)}});
+                lowTick = std::min(lowTick, tick);
+                highTick = std::max(highTick, tick);
+            }
+            m_book.setWindow(j.value("windowMinTick", lowTick), j.value("windowMaxTick", highTick));
+            for (const auto &[tick, entry] : rows) {
+                m_book.set(tick, entry.bidQty, entry.askQty);
+            }
+        }
+    }
+
+    if (!m_book.hasWindow()) {
+        finishFullLadder(0, 0, 0);
+        return;
+    }
+    const qint64 minTick = m_book.minTick();
+    const qint64 maxTick = m_book.maxTick();
+    finishFullLadder(minTick, maxTick, j.value("centerTick", (minTick + maxTick) / 2));
+}
+
+void LadderIngest::applyDeltaLadderMessage(const json &j)
+{
+    if (!m_hasBook) {
+        applyFullLadderMessage(j);
+        return;
+    }
+
+    m_bestBid = j.value("bestBid", m_bestBid);
+    m_bestAsk = j.value("bestAsk", m_bestAsk);
+    const double tickSize = j.value("tickSize", 0.0);
+    if (tickSize > 0.0) {
+        m_tickSize = tickSize;
+    }
+
+    // Moving the window first drops the rows it slid off; updates outside
+    // the new window are ignored.
+    m_book.setWindow(j.value("windowMinTick", m_minTick), j.value("windowMaxTick", m_maxTick));
+
+    auto updatesIt = j.find("updates");
+    if (updatesIt != j.end() && updatesIt->is_array() && m_tickSize > 0.0) {
+        for (const auto &row : *updatesIt) {
+            qint64 tick = 0;
+            if (row.contains("tick") && parseTickValue(row["tick"], tick)) {
+            } else {
+                const double price = row.value("price", 0.0);
+                tick = static_cast<qint64>(std::llround(price / m_tickSize));
+            }
+            const LadderBookEntry old = m_book.at(tick);
+            m_book.set(tick, row.value("bid", old.bidQty), row.value("ask", old.askQty));
+        }
+    }
+
+    auto removalsIt = j.find("removals");
+    if (removalsIt != j.end() && removalsIt->is_array()) {
+        for (const auto &tickValue : *removalsIt) {
+            if (tickValue.is_number_integer()) {
+                m_book.remove(static_cast<qint64>(tickValue.get<std::int64_t>()));
+            }
+        }
+    }
+
+    finishDeltaLadder(j.value("centerTick", m_centerTick));
+}
+
+void LadderIngest::applyFullLadderFrame(const dom::wire::LadderFrame &frame)
+{
+    const dom::wire::LadderHeader &h = frame.header;
+    applyLadderHeader(h);
+
+    m_book.clear();
+    // A sparse frame (frame.ticks set) keeps its window even with no rows listed.
+    if (m_tickSize > 0.0 && (frame.rowCount > 0 || frame.ticks)) {
+        m_book.setWindow(h.windowMinTick, h.windowMaxTick);
+        for (std::size_t i = 0; i < frame.rowCount; ++i) {
+            m_book.set(static_cast<qint64>(frame.tickAt(i)), frame.bidAt(i), frame.askAt(i));
+        }
+    }
+    if (!m_book.hasWindow()) {
+        finishFullLadder(0, 0, 0);
+        return;
+    }
+    finishFullLadder(m_book.minTick(), m_book.maxTick(), h.centerTick);
+}
+
+void LadderIngest::applyDeltaLadderFrame(const dom::wire::LadderFrame &frame)
+{
+    if (!m_hasBook) {
+        // Nothing to patch yet: the changed rows are the best base we have.
+        applyFullLadderFrame(frame);
+        return;
+    }
+
+    const dom::wire::LadderHeader &h = frame.header;
+    applyLadderHeader(h);
+
+    m_book.setWindow(h.windowMinTick, h.windowMaxTick);
+    if (m_tickSize > 0.0) {
+        for (std::size_t i = 0; i < frame.rowCount; ++i) {
+            m_book.set(static_cast<qint64>(frame.tickAt(i)), frame.bidAt(i), frame.askAt(i));
+        }
+    }
+    for (std::size_t i = 0; i < frame.removalCount; ++i) {
+        m_book.remove(static_cast<qint64>(frame.removalAt(i)));
+    }
+
+    finishDeltaLadder(h.centerTick);
+}
+
+void LadderIngest::finishFullLadder(qint64 minTick, qint64 maxTick, qint64 centerTick)
+{
+    ++m_ladderSeq;
+    m_changed = true;
+    m_hasBook = m_book.hasWindow();
+    if (m_hasBook) {
+        m_minTick = minTick;
+        m_maxTick = maxTick;
+        m_centerTick = centerTick;
+    } else {
+        m_minTick = 0;
+        m_maxTick = 0;
+        m_centerTick = 0;
+    }
+}
+
+void LadderIngest::finishDeltaLadder(qint64 centerTick)
+{
+    ++m_ladderSeq;
+    m_changed = true;
+    m_centerTick = centerTick;
+    m_hasBook = m_book.hasWindow();
+    if (m_hasBook) {
+        m_minTick = m_book.minTick();
+        m_maxTick = m_book.maxTick();
+    } else {
+        m_minTick = 0;
+        m_maxTick = 0;
+        m_centerTick = 0;
+    }
+}
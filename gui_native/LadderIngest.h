@@ -0,0 +1,153 @@
+// Parses one ladder's backend output on a worker thread and publishes the
+// resulting book to the GUI thread without locking.
+
+#pragma once
+
+#include "LadderBook.h"
+#include "LadderShm.hpp"
+#include "LadderWire.hpp"
+#include "PrintsWidget.h"
+#include <json.hpp>
+
+#include <QByteArray>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Everything LadderClient reads at frame time. Published as a whole.
+struct LadderBookState {
+    LadderBook book; // no window while shm is active; buckets are up to date
+    double tickSize = 0.0;
+    double bestBid = 0.0;
+    double bestAsk = 0.0;
+    qint64 minTick = 0;
+    qint64 maxTick = 0;
+    qint64 centerTick = 0;
+    bool hasBook = false;
+    bool shmActive = false;
+    quint64 ladderSeq = 0;   // bumped by every applied ladder frame/message
+    quint64 bookEpoch = 0;   // bumped when the backend switches the ladder to another symbol
+    quint64 resetEpoch = 0;  // LadderIngest::reset() this state was built after
+    qint64 timestampMs = 0;  // backend timestamp of that ladder
+    QVector<PrintItem> prints;
+    quint64 printSeq = 0;    // seq of the newest print
+};
+
+// Single-producer/single-consumer triple buffer. The writer fills back() and
+// publish()es it; the reader's acquire() returns the newest published state.
+// Neither side ever waits, and a slot is never touched by both threads at once.
+class LadderStateBuffer {
+public:
+    LadderBookState &back() { return m_slots[m_back]; }
+
+    void publish()
+    {
+        m_back = m_middle.exchange(m_back | kFresh, std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    // The returned reference stays valid until the next acquire().
+    const LadderBookState &acquire()
+    {
+        if (m_middle.load(std::memory_order_relaxed) & kFresh) {
+            m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & kIndexMask;
+        }
+        return m_slots[m_front];
+    }
+
+private:
+    static constexpr unsigned kIndexMask = 3u;
+    static constexpr unsigned kFresh = 4u;
+
+    LadderBookState m_slots[3];
+    unsigned m_back = 0;             // writer only
+    std::atomic<unsigned> m_middle{1};
+    unsigned m_front = 2;            // reader only
+};
+
+class LadderIngest final : public QObject {
+    Q_OBJECT
+
+public:
+    explicit LadderIngest(bool keepPrints, QObject *parent = nullptr);
+
+    // GUI thread. Queues raw backend stdout (frames and JSON lines, possibly
+    // split anywhere) and wakes the worker if it is idle.
+    void feed(const QByteArray &bytes);
+    void feed(const char *data, std::size_t size);
+
+    // GUI thread. Newest published state; call acknowledge() first when
+    // handling published() so a later publish raises the signal again.
+    const LadderBookState &acquire() { return m_states.acquire(); }
+    void acknowledge() { m_notifyPending.store(false, std::memory_order_release); }
+
+    // GUI thread, never waits on the worker. Drops queued input; everything
+    // fed afterwards belongs to `epoch`, which published states carry from
+    // the point the worker drops the book, prints and old segment and starts
+    // on `segment` (invalid for none). `retired` keeps the mapping of the
+    // segment being replaced alive until then.
+    void reset(quint64 epoch, const dom::shm::Segment &segment, std::shared_ptr<void> retired);
+
+    // Worker thread (LadderClient calls it through a queued invoke).
+    void setCompression(qint64 compression);
+
+signals:
+    // Coalesced: at most one is in flight until acknowledge().
+    void published();
+    void statusMessage(const QString &message);
+    // The backend could not switch the ladder to `wireSymbol` and keeps the old one.
+    void resubscribeFailed(const QString &wireSymbol, const QString &error);
+
+private:
+    void drain();
+    void wake();
+    void publish();
+    void clearBook();
+    void processLine(const char *data, std::size_t size);
+    void processFrame(dom::wire::FrameType type, const char *payload, std::size_t size);
+    void applyFullLadderMessage(const nlohmann::json &j);
+    void applyDeltaLadderMessage(const nlohmann::json &j);
+    void applyFullLadderFrame(const dom::wire::LadderFrame &frame);
+    void applyDeltaLadderFrame(const dom::wire::LadderFrame &frame);
+    void applyLadderHeader(const dom::wire::LadderHeader &header);
+    void finishFullLadder(qint64 minTick, qint64 maxTick, qint64 centerTick);
+    void finishDeltaLadder(qint64 centerTick);
+    void appendPrint(double price, double qtyBase, bool buy, qint64 tick);
+    void appendWireTrade(std::int64_t tick, double price, double qty, unsigned flags);
+
+    // Shared with the GUI thread.
+    QMutex m_inputMutex;
+    QByteArray m_input;
+    bool m_drainQueued = false;
+    quint64 m_inputEpoch = 0;
+    dom::shm::Segment m_inputSegment;
+    std::vector<std::shared_ptr<void>> m_retired;
+    std::atomic<bool> m_notifyPending{false};
+    LadderStateBuffer m_states;
+
+    // Worker thread only.
+    const bool m_keepPrints;
+    QByteArray m_buffer;
+    LadderBook m_book;
+    double m_tickSize = 0.0;
+    double m_bestBid = 0.0;
+    double m_bestAsk = 0.0;
+    qint64 m_minTick = 0;
+    qint64 m_maxTick = 0;
+    qint64 m_centerTick = 0;
+    bool m_hasBook = false;
+    quint64 m_ladderSeq = 0;
+    quint64 m_bookEpoch = 0;
+    quint64 m_resetEpoch = 0;
+    qint64 m_timestampMs = 0;
+    dom::shm::Segment m_shmSegment;
+    bool m_shmActive = false;
+    QVector<PrintItem> m_printBuffer;
+    quint64 m_printSeq = 0;
+    bool m_changed = false;
+};
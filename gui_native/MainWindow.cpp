@@ -218,6 +218,16 @@ constexpr int kMinBaseLadderLevels = 50;
 constexpr int kMaxBaseLadderLevels = 4000;
 constexpr int kMaxEffectiveLadderLevels = 20000;
 
+// The DOM frame timer never needs to tick faster than the fastest screen can show.
+static int fastestScreenRefreshHz()
+{
+    qreal hz = 0.0;
+    for (const QScreen *screen : QGuiApplication::screens()) {
+        hz = std::max(hz, screen->refreshRate());
+    }
+    return static_cast<int>(std::lround(hz));
+}
+
 static QStringList toStringList(const QList<int> &sizes)
 {
     QStringList out;
@@ -1851,6 +1861,10 @@ void MainWindow::buildUi()
         {QStringLiteral("domFrameRate"),
          tr("Частота обновления DOM"),
          {QStringLiteral("fps"), QStringLiteral("частота"), QStringLiteral("обновление"), QStringLiteral("dom")}});
+    m_settingEntries.append(
+        {QStringLiteral("domRenderer"),
+         tr("Отрисовка стакана"),
+         {QStringLiteral("render"), QStringLiteral("отрисовка"), QStringLiteral("scene graph"), QStringLiteral("qml")}});
     QStringList completionNames;
     for (const auto &entry : m_settingEntries) {
         completionNames << entry.name;
@@ -2955,6 +2969,7 @@ MainWindow::DomColumn MainWindow::createDomColumn(const QString &symbol,
     auto *dom = new DomWidget(column);
     dom->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
     dom->setVolumeHighlightRules(m_volumeRules);
+    dom->setRenderMode(m_domRenderMode);
     dom->setProperty("domContainerPtr",
                      QVariant::fromValue<quintptr>(reinterpret_cast<quintptr>(column)));
     prints->setRowHeightOnly(dom->rowHeight());
@@ -5131,7 +5146,7 @@ void MainWindow::applyCompressionForColumn(QWidget *columnContainer, int compres
     if (col->client) {
         col->client->setCompression(clamped);
         col->client->resetManualCenter();
-        restartColumnClient(*col);
+        restartColumnClient(*col, true);
     }
     saveUserSettings();
     statusBar()->showMessage(tr("Compression set to %1x").arg(clamped), 1200);
@@ -5965,6 +5980,7 @@ void MainWindow::openSettingsWindow()
         m_settingsWindow->setVolumeHighlightRules(m_volumeRules);
         m_settingsWindow->setCustomHotkeys(currentCustomHotkeys());
         m_settingsWindow->setDomRefreshRate(m_domTargetFps);
+        m_settingsWindow->setDomRenderMode(m_domRenderMode);
         m_settingsWindow->setActiveDomOutlineEnabled(m_activeDomOutlineEnabled);
         connect(m_settingsWindow,
                 &SettingsWindow::centerHotkeyChanged,
@@ -6004,6 +6020,14 @@ void MainWindow::openSettingsWindow()
                         fps > 0 ? tr("DOM FPS: %1").arg(fps) : tr("DOM FPS: по событиям");
                     statusBar()->showMessage(text, 1800);
                 });
+        connect(m_settingsWindow,
+                &SettingsWindow::domRenderModeChanged,
+                this,
+                [this](DomRenderMode mode) {
+                    m_domRenderMode = mode;
+                    applyDomRenderModeToAllDoms();
+                    saveUserSettings();
+                });
         connect(m_settingsWindow,
                 &SettingsWindow::activeDomOutlineEnabledChanged,
                 this,
@@ -6017,6 +6041,7 @@ void MainWindow::openSettingsWindow()
         m_settingsWindow->setVolumeHighlightRules(m_volumeRules);
         m_settingsWindow->setCustomHotkeys(currentCustomHotkeys());
         m_settingsWindow->setDomRefreshRate(m_domTargetFps);
+        m_settingsWindow->setDomRenderMode(m_domRenderMode);
         m_settingsWindow->setActiveDomOutlineEnabled(m_activeDomOutlineEnabled);
     }
     m_settingsWindow->show();
@@ -7269,7 +7294,7 @@ void MainWindow::openSettingEntry(const QString &id)
         m_settingsWindow->focusVolumeHighlightRules();
         return;
     }
-    if (id == QLatin1String("domFrameRate")) {
+    if (id == QLatin1String("domFrameRate") || id == QLatin1String("domRenderer")) {
         m_settingsWindow->focusVolumeHighlightRules();
         return;
     }
@@ -7412,6 +7437,9 @@ void MainWindow::loadUserSettings()
 
     s.beginGroup(QStringLiteral("ladder"));
     m_domTargetFps = s.value(QStringLiteral("domRefreshFps"), m_domTargetFps).toInt();
+    m_domRenderMode = s.value(QStringLiteral("domRenderer"), 0).toInt() == static_cast<int>(DomRenderMode::SceneGraph)
+                          ? DomRenderMode::SceneGraph
+                          : DomRenderMode::Qml;
     m_activeDomOutlineEnabled = s.value(QStringLiteral("activeDomOutline"), true).toBool();
     m_volumeRules.clear();
     int ruleCount = s.beginReadArray(QStringLiteral("volumeRules"));
@@ -7592,6 +7620,7 @@ void MainWindow::saveUserSettings() const
 
     s.beginGroup(QStringLiteral("ladder"));
     s.setValue(QStringLiteral("domRefreshFps"), m_domTargetFps);
+    s.setValue(QStringLiteral("domRenderer"), static_cast<int>(m_domRenderMode));
     s.setValue(QStringLiteral("activeDomOutline"), m_activeDomOutlineEnabled);
     s.beginWriteArray(QStringLiteral("volumeRules"));
     for (int i = 0; i < m_volumeRules.size(); ++i) {
@@ -7706,6 +7735,8 @@ void MainWindow::initializeDomFrameTimer()
         m_domFrameTimer = new QTimer(this);
         m_domFrameTimer->setTimerType(Qt::PreciseTimer);
         connect(m_domFrameTimer, &QTimer::timeout, this, &MainWindow::handleDomFrameTick);
+        connect(qGuiApp, &QGuiApplication::screenAdded, this, [this]() { applyDomFrameRate(m_domTargetFps); });
+        connect(qGuiApp, &QGuiApplication::screenRemoved, this, [this]() { applyDomFrameRate(m_domTargetFps); });
     }
     applyDomFrameRate(m_domTargetFps);
 }
@@ -7721,7 +7752,10 @@ void MainWindow::applyDomFrameRate(int fps)
         m_domFrameTimer->stop();
         return;
     }
-    const int interval = std::max(1, static_cast<int>(std::round(1000.0 / clamped)));
+    // The setting is kept as chosen; ticks run at most at the screen refresh rate.
+    const int screenHz = fastestScreenRefreshHz();
+    const int effective = screenHz > 0 ? std::min(clamped, screenHz) : clamped;
+    const int interval = std::max(1, static_cast<int>(std::round(1000.0 / effective)));
     if (!m_domFrameTimer->isActive() || m_domFrameTimer->interval() != interval) {
         m_domFrameTimer->start(interval);
     }
@@ -7749,6 +7783,17 @@ void MainWindow::updateColumnStatusLabel(DomColumn &col)
     QString fpsText;
     if (col.lastFpsHz > 0.0) {
         fpsText = QStringLiteral("%1 Hz").arg(col.lastFpsHz, 0, 'f', 1);
+        // GUI time per ladder frame, to compare the QML and scene-graph renderers.
+        if (col.dom && col.dom->frameCostUs() > 0.0) {
+            fpsText.append(QStringLiteral(" · %1 µs").arg(col.dom->frameCostUs(), 0, 'f', 0));
+        }
+    }
+    if (col.skippedFramePct >= 0) {
+        // Share of frame ticks with nothing new to draw (or the column hidden).
+        if (!fpsText.isEmpty()) {
+            fpsText.append(QStringLiteral(" · "));
+        }
+        fpsText.append(QStringLiteral("skip %1%").arg(col.skippedFramePct));
     }
     if (!fpsText.isEmpty()) {
         if (!text.isEmpty()) {
@@ -7769,6 +7814,19 @@ void MainWindow::refreshDomColumnFrame(DomColumn &col)
     if (!col.client || !col.dom || !col.hasBuffer) {
         return;
     }
+    // Roughly twice a second, publish how many ticks found nothing to do.
+    if (++col.frameTicks >= std::max(1, 500 / std::max(1, m_domFrameTimer->interval()))) {
+        col.skippedFramePct = col.skippedFrameTicks * 100 / col.frameTicks;
+        col.frameTicks = 0;
+        col.skippedFrameTicks = 0;
+        updateColumnStatusLabel(col);
+    }
+    // A hidden column keeps its pulled revision, so whatever changed meanwhile
+    // is pulled on its first tick after it is shown again.
+    if (!isDomColumnShown(col)) {
+        ++col.skippedFrameTicks;
+        return;
+    }
     if (col.pendingViewportUpdate) {
         flushPendingColumnViewport(col);
         return;
@@ -7776,15 +7834,34 @@ void MainWindow::refreshDomColumnFrame(DomColumn &col)
     if (col.lastViewportTop < col.lastViewportBottom) {
         return;
     }
+    if (col.client->revision() == col.pulledRevision && col.lastViewportBottom == col.pulledBottomTick
+        && col.lastViewportTop == col.pulledTopTick) {
+        ++col.skippedFrameTicks;
+        return;
+    }
     pullSnapshotForColumn(col, col.lastViewportBottom, col.lastViewportTop);
 }
+
+bool MainWindow::isDomColumnShown(const DomColumn &col) const
+{
+    // Docked columns of background tabs are hidden with their stack page; a
+    // minimized window (main or floating) keeps its widgets "visible".
+    return col.dom && col.dom->isVisible() && !col.dom->window()->isMinimized();
+}
 
 bool MainWindow::pullSnapshotForColumn(DomColumn &col, qint64 bottomTick, qint64 topTick)
 {
     if (!col.client || !col.dom) {
         return false;
     }
-    DomSnapshot snap = col.client->snapshotForRange(bottomTick, topTick);
+    // Reused every frame so steady-state pulls do not allocate. The revision is
+    // read first: a ladder landing during the pull only causes one extra pull.
+    DomSnapshot &snap = col.snapshot;
+    col.pulledRevision = col.client->revision();
+    col.pulledBottomTick = bottomTick;
+    col.pulledTopTick = topTick;
+    col.client->setViewport(bottomTick, topTick);
+    col.client->snapshotForRange(bottomTick, topTick, snap);
     if (snap.tickSize > 0.0) {
         col.bufferTickSize = snap.tickSize;
     }
@@ -8132,7 +8209,7 @@ bool MainWindow::slideDisplayWindow(DomColumn &col, int direction, qint64 overri
 
 void MainWindow::maybePrefetchBuffer(DomColumn &col, bool upwards)
 {
-    if (!col.client) {
+    if (!col.client || col.client->streamsDeepBook()) {
         return;
     }
     const qint64 span =
@@ -8156,7 +8233,7 @@ void MainWindow::maybePrefetchBuffer(DomColumn &col, bool upwards)
 
 void MainWindow::queueColumnDepthShift(DomColumn &col, bool upwards, double multiplier)
 {
-    if (!col.client) {
+    if (!col.client || col.client->streamsDeepBook()) {
         return;
     }
     const double clamped = std::clamp(multiplier, 1.0, 8.0);
@@ -8566,7 +8643,7 @@ void MainWindow::handleDomScroll(QWidget *columnContainer, int value)
     }
 }
 
-void MainWindow::restartColumnClient(DomColumn &col)
+void MainWindow::restartColumnClient(DomColumn &col, bool reuseBackend)
 {
     if (!col.client) {
         return;
@@ -8654,7 +8731,11 @@ void MainWindow::restartColumnClient(DomColumn &col)
     col.bufferRevision = 0;
     col.scrollValueValid = false;
     col.lastScrollBarValue = 0;
-    col.client->restart(col.symbol, effectiveLevels, exch);
+    if (reuseBackend) {
+        col.client->reconfigure(col.symbol, effectiveLevels, exch);
+    } else {
+        col.client->restart(col.symbol, effectiveLevels, exch);
+    }
 }
 
 QVector<VolumeHighlightRule> MainWindow::defaultVolumeHighlightRules() const
@@ -8668,6 +8749,17 @@ QVector<VolumeHighlightRule> MainWindow::defaultVolumeHighlightRules() const
     };
 }
 
+void MainWindow::applyDomRenderModeToAllDoms()
+{
+    for (auto &tab : m_tabs) {
+        for (auto &col : tab.columnsData) {
+            if (col.dom) {
+                col.dom->setRenderMode(m_domRenderMode);
+            }
+        }
+    }
+}
+
 void MainWindow::applyVolumeRulesToAllDoms()
 {
     for (auto &tab : m_tabs) {
@@ -10645,7 +10737,7 @@ void MainWindow::applySymbolToColumn(DomColumn &col,
     }
 
     if (col.client) {
-        restartColumnClient(col);
+        restartColumnClient(col, true);
     }
     syncWatchedSymbols();
 }
@@ -224,12 +224,21 @@ private:
         qint64 lastSnapshotLogMs = 0;
         qint64 lastFpsLabelUpdateMs = 0;
         double lastFpsHz = 0.0;
+        // Frame scheduler: the client revision and range of the last pull, and
+        // how many frame ticks skipped this column since the status refresh.
+        quint64 pulledRevision = 0;
+        qint64 pulledBottomTick = 0;
+        qint64 pulledTopTick = 0;
+        int frameTicks = 0;
+        int skippedFrameTicks = 0;
+        int skippedFramePct = -1; // shown in the status label; -1 before the first count
         qint64 lastPrintsBottomTick = 0;
         qint64 lastPrintsTopTick = 0;
         int lastPrintsRowHeight = 0;
         int lastPrintsCompression = 0;
         double lastPrintsTick = 0.0;
         int lastPrintsRowCount = 0;
+        DomSnapshot snapshot; // pullSnapshotForColumn's buffer, refilled in place
         QString lastStatusMessage;
         qint64 extendQueuedShiftUp = 0;
         qint64 extendQueuedShiftDown = 0;
@@ -288,6 +297,7 @@ private:
     void saveUserSettings() const;
     QVector<VolumeHighlightRule> defaultVolumeHighlightRules() const;
     void applyVolumeRulesToAllDoms();
+    void applyDomRenderModeToAllDoms();
     void refreshActiveLadder();
     DomColumn *focusedDomColumn();
     void setActiveDomContainer(QWidget *container);
@@ -305,6 +315,7 @@ private:
     void pollSltpHoldKey();
     void updateColumnStatusLabel(DomColumn &col);
     void refreshDomColumnFrame(DomColumn &col);
+    bool isDomColumnShown(const DomColumn &col) const;
     bool pullSnapshotForColumn(DomColumn &col, qint64 bottomTick, qint64 topTick);
     void maybeTriggerSltpForColumn(DomColumn &col, const DomSnapshot &snap);
     QVector<SettingsWindow::HotkeyEntry> currentCustomHotkeys() const;
@@ -325,7 +336,9 @@ private:
     void queueColumnDepthShift(DomColumn &col, bool upwards, double multiplier);
     void recenterDisplayWindow(DomColumn &col, qint64 centerTick);
     void handleDomScroll(QWidget *columnContainer, int value);
-    void restartColumnClient(DomColumn &col);
+    // reuseBackend: hand symbol/level changes to the running backend when it
+    // can take them live (LadderClient::reconfigure) instead of a new process.
+    void restartColumnClient(DomColumn &col, bool reuseBackend = false);
     void updateColumnViewport(DomColumn &col, bool forceCenter = false);
     void flushPendingColumnViewport(DomColumn &col);
     void updateColumnScrollRange(DomColumn &col);
@@ -563,6 +576,7 @@ private:
     QTimer *m_sltpHoldPollTimer = nullptr;
     QTimer *m_domFrameTimer = nullptr;
     int m_domTargetFps = 60;
+    DomRenderMode m_domRenderMode = DomRenderMode::Qml;
     std::array<int, 5> m_notionalPresetKeys{
         {Qt::Key_1, Qt::Key_2, Qt::Key_3, Qt::Key_4, Qt::Key_5}};
     std::array<Qt::KeyboardModifiers, 5> m_notionalPresetMods{
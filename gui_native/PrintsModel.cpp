@@ -1,5 +1,7 @@
 #include "PrintsModel.h"
 
+#include <algorithm>
+
 PrintCirclesModel::PrintCirclesModel(QObject *parent)
     : QAbstractListModel(parent)
 {
@@ -256,40 +258,85 @@ QHash<int, QByteArray> PrintClustersModel::roleNames() const
 
 void PrintClustersModel::setEntries(QVector<Entry> entries)
 {
-    if (entries.size() != m_entries.size()) {
+    // Entries come sorted by (row, col). Cells that appear or disappear are
+    // inserted/removed in place and changed cells get dataChanged, so the
+    // delegates of untouched cells survive. When most keys differ (ladder
+    // scrolled, bucket rolled over) a reset is cheaper.
+    auto less = [](const Entry &a, const Entry &b) { return a.row != b.row ? a.row < b.row : a.col < b.col; };
+    int kept = 0;
+    for (int i = 0, j = 0; i < m_entries.size() && j < entries.size();) {
+        if (less(m_entries[i], entries[j])) {
+            ++i;
+        } else if (less(entries[j], m_entries[i])) {
+            ++j;
+        } else {
+            ++kept;
+            ++i;
+            ++j;
+        }
+    }
+    if (kept * 2 < std::max<int>(m_entries.size(), entries.size())) {
         beginResetModel();
         m_entries = std::move(entries);
         endResetModel();
         return;
     }
-    QVector<int> changed;
-    for (int i = 0; i < entries.size(); ++i) {
-        if (entries[i] != m_entries[i]) {
-            m_entries[i] = entries[i];
-            changed.append(i);
+
+    static const QVector<int> kCellRoles = {TextRole, TextColorRole, BgColorRole};
+    int changedFirst = -1;
+    int changedLast = -1;
+    auto flushChanged = [&]() {
+        if (changedFirst >= 0) {
+            emit dataChanged(createIndex(changedFirst, 0), createIndex(changedLast, 0), kCellRoles);
+            changedFirst = changedLast = -1;
         }
-    }
-    if (changed.isEmpty()) {
-        return;
-    }
-    QVector<int> roleList = {RowRole, ColRole, TextRole, TextColorRole, BgColorRole};
-    int start = -1;
-    int last = -1;
-    for (int idx : changed) {
-        if (start < 0) {
-            start = last = idx;
-        } else if (idx == last + 1) {
-            last = idx;
-        } else {
-            const QModelIndex top = createIndex(start, 0);
-            const QModelIndex bottom = createIndex(last, 0);
-            emit dataChanged(top, bottom, roleList);
-            start = last = idx;
+    };
+    int i = 0;
+    int j = 0;
+    while (j < entries.size()) {
+        if (i < m_entries.size() && less(m_entries[i], entries[j])) {
+            int last = i;
+            while (last + 1 < m_entries.size() && less(m_entries[last + 1], entries[j])) {
+                ++last;
+            }
+            flushChanged();
+            beginRemoveRows(QModelIndex(), i, last);
+            m_entries.remove(i, last - i + 1);
+            endRemoveRows();
+            continue;
+        }
+        if (i == m_entries.size() || less(entries[j], m_entries[i])) {
+            int end = j + 1;
+            while (end < entries.size() && (i == m_entries.size() || less(entries[end], m_entries[i]))) {
+                ++end;
+            }
+            const int count = end - j;
+            flushChanged();
+            beginInsertRows(QModelIndex(), i, i + count - 1);
+            m_entries.insert(i, count, Entry());
+            std::copy(entries.cbegin() + j, entries.cbegin() + end, m_entries.begin() + i);
+            endInsertRows();
+            i += count;
+            j = end;
+            continue;
+        }
+        if (m_entries[i] != entries[j]) {
+            m_entries[i] = entries[j];
+            if (changedFirst >= 0 && changedLast + 1 != i) {
+                flushChanged();
+            }
+            if (changedFirst < 0) {
+                changedFirst = i;
+            }
+            changedLast = i;
         }
+        ++i;
+        ++j;
     }
-    if (start >= 0) {
-        const QModelIndex top = createIndex(start, 0);
-        const QModelIndex bottom = createIndex(last, 0);
-        emit dataChanged(top, bottom, roleList);
+    flushChanged();
+    if (i < m_entries.size()) {
+        beginRemoveRows(QModelIndex(), i, m_entries.size() - 1);
+        m_entries.resize(i);
+        endRemoveRows();
     }
 }
@@ -55,6 +55,7 @@ PrintsWidget::PrintsWidget(QWidget *parent)
     : QWidget(parent)
 {
     setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+    m_spawnProgress.fill(1.0);
     ensureQuickInitialized();
     connect(ThemeManager::instance(), &ThemeManager::themeChanged, this, [this]() {
         syncQuickProperties();
@@ -75,46 +76,55 @@ void PrintsWidget::setPrints(const QVector<PrintItem> &items)
     // Row alignment must be derived from the active ladder price mapping (price -> row), otherwise a
     // backend/offline hint can introduce a systematic 1-tick shift.
     m_items = items;
-    for (const auto &it : m_items) {
-        if (it.seq > m_lastClusterSeq) {
-            ClusterTrade t;
-            t.price = it.price;
-            t.tick = it.tick;
-            t.qty = it.qty;
-            t.buy = it.buy;
-            t.timeMs = it.timeMs > 0 ? it.timeMs : QDateTime::currentMSecsSinceEpoch();
-            t.seq = it.seq;
-            m_clusterTrades.push_back(t);
-            m_lastClusterSeq = it.seq;
-        }
-    }
-
-    QHash<QString, double> nextProgress;
-    nextProgress.reserve(items.size());
     bool hasNew = false;
     for (const auto &it : m_items) {
-        const QString key = makeKey(it);
-        if (m_spawnProgress.contains(key)) {
-            nextProgress.insert(key, m_spawnProgress.value(key));
-        } else {
-            nextProgress.insert(key, 0.0);
-            hasNew = true;
-        }
+        hasNew |= trackPrint(it);
     }
-    m_spawnProgress = nextProgress;
-    bool needTimer = false;
-    for (auto it = m_spawnProgress.cbegin(); it != m_spawnProgress.cend(); ++it) {
-        if (it.value() < 0.999) {
-            needTimer = true;
-            break;
-        }
+    printsChanged(hasNew);
+}
+
+void PrintsWidget::appendPrints(const QVector<PrintItem> &items, int from)
+{
+    bool hasNew = false;
+    for (int i = std::max(0, from); i < items.size(); ++i) {
+        m_items.push_back(items[i]);
+        hasNew |= trackPrint(items[i]);
     }
-    if (needTimer) {
-        if (!m_animTimer.isActive()) {
-            m_animTimer.start(16, this);
-        }
-    } else {
-        m_animTimer.stop();
+    if (m_items.size() > kMaxPrints) {
+        m_items.erase(m_items.begin(), m_items.begin() + (m_items.size() - kMaxPrints));
+    }
+    printsChanged(hasNew);
+}
+
+bool PrintsWidget::trackPrint(const PrintItem &item)
+{
+    if (item.seq > m_lastClusterSeq) {
+        ClusterTrade t;
+        t.price = item.price;
+        t.tick = item.tick;
+        t.qty = item.qty;
+        t.buy = item.buy;
+        t.timeMs = item.timeMs > 0 ? item.timeMs : QDateTime::currentMSecsSinceEpoch();
+        t.seq = item.seq;
+        m_clusterTrades.push_back(t);
+        addClusterTrade(t);
+        m_lastClusterSeq = item.seq;
+    }
+    // Seqs are consecutive, so the kept prints never share a spawn slot.
+    const int slot = static_cast<int>(item.seq & (kSpawnSlots - 1));
+    if (m_spawnSeq[slot] == item.seq) {
+        return false;
+    }
+    m_spawnSeq[slot] = item.seq;
+    m_spawnProgress[slot] = 0.0;
+    return true;
+}
+
+void PrintsWidget::printsChanged(bool hasNew)
+{
+    // The timer stops itself once every spawn has finished.
+    if (hasNew && !m_animTimer.isActive()) {
+        m_animTimer.start(16, this);
     }
     updatePrintsQml();
     updateClustersQml();
@@ -256,8 +266,7 @@ void PrintsWidget::timerEvent(QTimerEvent *event)
 {
     if (event->timerId() == m_animTimer.timerId()) {
         bool any = false;
-        for (auto it = m_spawnProgress.begin(); it != m_spawnProgress.end(); ++it) {
-            double value = it.value();
+        for (double &value : m_spawnProgress) {
             if (value < 0.999) {
                 value += (1.0 - value) * 0.3;
                 if (value > 0.999) {
@@ -265,7 +274,6 @@ void PrintsWidget::timerEvent(QTimerEvent *event)
                 } else {
                     any = true;
                 }
-                it.value() = value;
             }
         }
         if (!any) {
@@ -275,15 +283,6 @@ void PrintsWidget::timerEvent(QTimerEvent *event)
         return;
     }
     QWidget::timerEvent(event);
-}
-
-QString PrintsWidget::makeKey(const PrintItem &item) const
-{
-    return QStringLiteral("%1_%2_%3_%4")
-        .arg(item.price, 0, 'f', 5)
-        .arg(item.qty, 0, 'f', 3)
-        .arg(item.buy ? QLatin1Char('B') : QLatin1Char('S'))
-        .arg(item.seq, 0, 10);
 }
 
 qint64 PrintsWidget::tickForPrice(double price) const
@@ -616,8 +615,9 @@ void PrintsWidget::updatePrintsQml()
         entries.reserve(count - startIdx);
         for (int i = startIdx; i < count; ++i) {
             const PrintItem &item = m_items[i];
-            const QString key = makeKey(item);
-            const double spawn = std::clamp(m_spawnProgress.value(key, 1.0), 0.0, 1.0);
+            const int spawnSlot = static_cast<int>(item.seq & (kSpawnSlots - 1));
+            const double spawn =
+                m_spawnSeq[spawnSlot] == item.seq ? std::clamp(m_spawnProgress[spawnSlot], 0.0, 1.0) : 1.0;
             const double eased = 1.0 - std::pow(1.0 - spawn, 3.0);
             const double magnitude = std::log10(1.0 + std::abs(item.qty));
             const int baseRadius = std::clamp(9 + static_cast<int>(std::round(magnitude * 5.0)), 10, 18);
@@ -781,66 +781,62 @@ void PrintsWidget::updateClustersQml(bool force)
     if (!force && m_lastClusterUpdateMs > 0 && nowMs - m_lastClusterUpdateMs < kMinClusterUpdateMs) {
         return;
     }
-    m_lastClusterUpdateMs = nowMs;
     const int bucketMs = std::clamp(m_clusterBucketMs, 100, 300000);
-    const int bucketCount = std::clamp(m_clusterBucketCount, 1, 12);
+    const int bucketCount = std::clamp(m_clusterBucketCount, 1, kClusterRingSize);
+    const qint64 currentBucket = nowMs / bucketMs;
+    // Nothing arrived and no bucket boundary passed: the grid is unchanged.
+    if (!force && !m_clusterTradesAdded && currentBucket == m_publishedClusterBucket) {
+        return;
+    }
+    m_lastClusterUpdateMs = nowMs;
+    m_clusterTradesAdded = false;
+    m_publishedClusterBucket = currentBucket;
     const qint64 cutoff = nowMs - static_cast<qint64>(bucketMs) * static_cast<qint64>(bucketCount);
     while (!m_clusterTrades.empty() && m_clusterTrades.front().timeMs < cutoff) {
         m_clusterTrades.pop_front();
     }
 
-    struct Agg {
-        double total = 0.0;
-        double delta = 0.0;
-    };
-    QHash<QPair<qint64, int>, Agg> aggByCell;
-    aggByCell.reserve(static_cast<int>(m_clusterTrades.size()));
-    const qint64 currentBucket = nowMs / bucketMs;
+    // Cost is one pass over the distinct ticks of each visible bucket; trades
+    // were summed when they arrived.
     QVector<double> totalsByCol(bucketCount, 0.0);
     QVector<qint64> startMsByCol(bucketCount, 0);
-    for (int col = 0; col < bucketCount; ++col) {
+    m_clusterCells.clear();
+    for (int col = 0; col < bucketCount; ++col) { // newest on the right
         const qint64 bucket = currentBucket - (bucketCount - 1 - col);
         startMsByCol[col] = bucket * static_cast<qint64>(bucketMs);
-    }
-    for (const auto &t : m_clusterTrades) {
-        const qint64 priceTick = t.tick != 0 ? bucketizeTick(t.tick) : tickForPrice(t.price);
-        const qint64 bucket = t.timeMs / bucketMs;
-        const qint64 offset = currentBucket - bucket;
-        if (offset < 0 || offset >= bucketCount) {
+        const ClusterBucket &slot = m_clusterBuckets[static_cast<int>(bucket % kClusterRingSize)];
+        if (slot.index != bucket) {
             continue;
         }
-        const int col = (bucketCount - 1) - static_cast<int>(offset); // newest on the right
-        const QPair<qint64, int> key(priceTick, col);
-        Agg agg = aggByCell.value(key, Agg{});
-        agg.total += t.qty;
-        agg.delta += t.buy ? t.qty : -t.qty;
-        aggByCell.insert(key, agg);
-    }
-
-    m_clusterCells.clear();
-    m_clusterCells.reserve(aggByCell.size());
-    for (auto it = aggByCell.constBegin(); it != aggByCell.constEnd(); ++it) {
-        const qint64 tick = it.key().first;
-        const int col = it.key().second;
-        const Agg agg = it.value();
-        if (!(agg.total > 0.0)) {
-            continue;
+        m_clusterCellByTick.clear();
+        auto add = [&](qint64 tick, const ClusterAgg &agg) {
+            auto it = m_clusterCellByTick.constFind(tick);
+            if (it == m_clusterCellByTick.constEnd()) {
+                ClusterCellAgg cell;
+                cell.tick = tick;
+                cell.price = (m_tickSize > 0.0) ? (static_cast<double>(tick) * m_tickSize) : 0.0;
+                cell.col = col;
+                it = m_clusterCellByTick.insert(tick, m_clusterCells.size());
+                m_clusterCells.push_back(cell);
+            }
+            ClusterCellAgg &cell = m_clusterCells[it.value()];
+            cell.total += agg.total;
+            cell.delta += agg.delta;
+        };
+        for (auto it = slot.byTick.constBegin(); it != slot.byTick.constEnd(); ++it) {
+            add(bucketizeTick(it.key()), it.value());
         }
-        ClusterCellAgg cell;
-        cell.tick = tick;
-        cell.price = (m_tickSize > 0.0) ? (static_cast<double>(tick) * m_tickSize) : 0.0;
-        cell.col = col;
-        cell.total = agg.total;
-        cell.delta = agg.delta;
-        m_clusterCells.push_back(cell);
-        if (col >= 0 && col < totalsByCol.size()) {
-            totalsByCol[col] += agg.total;
+        for (auto it = slot.byPrice.constBegin(); it != slot.byPrice.constEnd(); ++it) {
+            add(tickForPrice(it.key()), it.value());
         }
     }
-    std::sort(m_clusterCells.begin(), m_clusterCells.end(), [](const auto &a, const auto &b) {
-        if (a.tick != b.tick) return a.tick < b.tick;
-        return a.col < b.col;
-    });
+    m_clusterCells.erase(std::remove_if(m_clusterCells.begin(),
+                                        m_clusterCells.end(),
+                                        [](const ClusterCellAgg &cell) { return !(cell.total > 0.0); }),
+                         m_clusterCells.end());
+    for (const ClusterCellAgg &cell : m_clusterCells) {
+        totalsByCol[cell.col] += cell.total;
+    }
     publishClustersModel();
 
     const bool bucketsChanged = (m_clusterBucketStartMs != startMsByCol)
@@ -853,6 +849,34 @@ void PrintsWidget::updateClustersQml(bool force)
     scheduleNextClusterBoundary();
 }
 
+void PrintsWidget::addClusterTrade(const ClusterTrade &t)
+{
+    const qint64 bucket = t.timeMs / std::clamp(m_clusterBucketMs, 100, 300000);
+    ClusterBucket &slot = m_clusterBuckets[static_cast<int>(bucket % kClusterRingSize)];
+    if (slot.index != bucket) {
+        if (slot.index > bucket) {
+            return; // a full ring older than the slot: outside any window
+        }
+        slot.index = bucket;
+        slot.byTick.clear();
+        slot.byPrice.clear();
+    }
+    ClusterAgg &agg = t.tick != 0 ? slot.byTick[t.tick] : slot.byPrice[t.price];
+    agg.total += t.qty;
+    agg.delta += t.buy ? t.qty : -t.qty;
+    m_clusterTradesAdded = true;
+}
+
+void PrintsWidget::rebuildClusterBuckets()
+{
+    for (ClusterBucket &slot : m_clusterBuckets) {
+        slot = ClusterBucket();
+    }
+    for (const ClusterTrade &t : m_clusterTrades) {
+        addClusterTrade(t);
+    }
+}
+
 void PrintsWidget::publishClustersModel()
 {
     if (m_prices.isEmpty() || m_clusterCells.isEmpty()) {
@@ -919,6 +943,7 @@ void PrintsWidget::setClusterWindowMs(int ms)
         return;
     }
     m_clusterBucketMs = clamped;
+    rebuildClusterBuckets();
     emit clusterLabelChanged(clusterLabel());
     updateClustersQml(true);
 }
@@ -940,5 +965,6 @@ void PrintsWidget::clearClusters()
 {
     m_clusterTrades.clear();
     m_lastClusterSeq = 0;
+    rebuildClusterBuckets();
     updateClustersQml(true);
 }
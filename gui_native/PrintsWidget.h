@@ -7,7 +7,9 @@
 #include <QVariant>
 #include <QVector>
 #include <QWidget>
+#include <array>
 #include <deque>
+#include <limits>
 
 #include "PrintsModel.h"
 
@@ -36,9 +38,14 @@ class QQuickWidget;
 class PrintsWidget : public QWidget {
     Q_OBJECT
 public:
+    // Prints kept by LadderIngest and by this widget; at most m_maxVisiblePrints are drawn.
+    static constexpr int kMaxPrints = 128;
+
     explicit PrintsWidget(QWidget *parent = nullptr);
 
     void setPrints(const QVector<PrintItem> &items);
+    // Appends items[from..] (newer than anything held) and drops the oldest beyond kMaxPrints.
+    void appendPrints(const QVector<PrintItem> &items, int from);
     void setLadderPrices(const QVector<double> &prices,
                          const QVector<qint64> &rowTicks,
                          int rowHeight,
@@ -99,7 +106,8 @@ protected:
     QSize minimumSizeHint() const override;
 
 private:
-    QString makeKey(const PrintItem &item) const;
+    bool trackPrint(const PrintItem &item);
+    void printsChanged(bool hasNew);
     qint64 tickForPrice(double price) const;
     int rowForPrice(double price) const;
     qint64 bucketizeTick(qint64 tick) const;
@@ -114,6 +122,7 @@ private:
     void updateClustersQml(bool force = false);
     void publishClustersModel();
     void scheduleNextClusterBoundary();
+    void rebuildClusterBuckets();
     int resolvedRowForItem(const PrintItem &item, int *outRowIdx = nullptr) const;
 
     QVector<PrintItem> m_items;
@@ -122,7 +131,12 @@ private:
     QHash<double, int> m_priceToRow;
     QHash<qint64, int> m_tickToRow;
     int m_rowHeight = 20;
-    QHash<QString, double> m_spawnProgress;
+    // Spawn animation per print, in slot seq % kSpawnSlots; a slot holding
+    // another seq means that print has finished spawning.
+    static constexpr int kSpawnSlots = 256;
+    std::array<quint64, kSpawnSlots> m_spawnSeq{};
+    std::array<double, kSpawnSlots> m_spawnProgress{};
+    static_assert(kSpawnSlots >= kMaxPrints, "kept prints must not share spawn slots");
     QBasicTimer m_animTimer;
     int m_hoverRow = -1;
     double m_hoverPrice = 0.0;
@@ -166,7 +180,26 @@ private:
         qint64 timeMs = 0;
         quint64 seq = 0;
     };
-    std::deque<ClusterTrade> m_clusterTrades;
+    void addClusterTrade(const ClusterTrade &t);
+    std::deque<ClusterTrade> m_clusterTrades; // kept only to re-bucket on a window change
+
+    // Trades summed per time bucket as they arrive, one ring slot per bucket
+    // (slot = bucket % kClusterRingSize). Keyed by raw tick, or by price for
+    // trades without one, and mapped to ladder rows only when published.
+    struct ClusterAgg {
+        double total = 0.0;
+        double delta = 0.0;
+    };
+    struct ClusterBucket {
+        qint64 index = std::numeric_limits<qint64>::min(); // timeMs / bucket size
+        QHash<qint64, ClusterAgg> byTick;
+        QHash<double, ClusterAgg> byPrice;
+    };
+    static constexpr int kClusterRingSize = 12; // the largest bucket count
+    QVector<ClusterBucket> m_clusterBuckets = QVector<ClusterBucket>(kClusterRingSize);
+    QHash<qint64, int> m_clusterCellByTick; // publish scratch: tick -> m_clusterCells index
+    bool m_clusterTradesAdded = false;
+    qint64 m_publishedClusterBucket = 0;
     quint64 m_lastClusterSeq = 0;
     qint64 m_lastClusterUpdateMs = 0;
     int m_clusterBucketMs = 1000;
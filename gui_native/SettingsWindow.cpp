@@ -281,6 +281,30 @@ SettingsWindow::SettingsWindow(QWidget *parent)
                          emit domRefreshRateChanged(m_domRefreshChoices[index]);
                      });
 
+    auto *renderRow = new QHBoxLayout();
+    auto *renderLabel = new QLabel(tr("Отрисовка стакана"), ladderPage);
+    renderLabel->setStyleSheet(QStringLiteral("font-weight:bold;"));
+    renderRow->addWidget(renderLabel);
+    renderRow->addStretch(1);
+    m_domRenderCombo = new QComboBox(ladderPage);
+    m_domRenderCombo->addItem(tr("QML (ListView)"), static_cast<int>(DomRenderMode::Qml));
+    m_domRenderCombo->addItem(tr("Scene graph (нативный)"), static_cast<int>(DomRenderMode::SceneGraph));
+    m_domRenderCombo->setToolTip(
+        tr("Нагрузка на GUI-поток (мкс на кадр) показывается рядом с частотой в статусе колонки."));
+    renderRow->addWidget(m_domRenderCombo);
+    ladderLayout->addLayout(renderRow);
+
+    QObject::connect(m_domRenderCombo,
+                     qOverload<int>(&QComboBox::currentIndexChanged),
+                     this,
+                     [this](int index) {
+                         if (index < 0) {
+                             return;
+                         }
+                         emit domRenderModeChanged(
+                             static_cast<DomRenderMode>(m_domRenderCombo->itemData(index).toInt()));
+                     });
+
     auto *volumeLabel = new QLabel(tr("Подсветка объёмов (USDT)"), ladderPage);
     volumeLabel->setStyleSheet(QStringLiteral("font-weight: bold;"));
     ladderLayout->addWidget(volumeLabel);
@@ -701,6 +725,16 @@ void SettingsWindow::setDomRefreshRate(int fps)
     m_domRefreshCombo->setCurrentIndex(bestIndex);
 }
 
+void SettingsWindow::setDomRenderMode(DomRenderMode mode)
+{
+    if (!m_domRenderCombo) {
+        return;
+    }
+    const int index = m_domRenderCombo->findData(static_cast<int>(mode));
+    const QSignalBlocker blocker(m_domRenderCombo);
+    m_domRenderCombo->setCurrentIndex(std::max(0, index));
+}
+
 void SettingsWindow::setActiveDomOutlineEnabled(bool enabled)
 {
     if (!m_activeDomOutlineCheck) {
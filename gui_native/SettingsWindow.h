@@ -27,6 +27,7 @@ public:
     void setCustomHotkeys(const QVector<HotkeyEntry> &entries);
     void setVolumeHighlightRules(const QVector<VolumeHighlightRule> &rules);
     void setDomRefreshRate(int fps);
+    void setDomRenderMode(DomRenderMode mode);
     void setActiveDomOutlineEnabled(bool enabled);
     void focusCenterHotkey();
     void focusVolumeHighlightRules();
@@ -36,6 +37,7 @@ signals:
     void volumeHighlightRulesChanged(const QVector<VolumeHighlightRule> &rules);
     void customHotkeyChanged(const QString &id, int key, Qt::KeyboardModifiers mods);
     void domRefreshRateChanged(int fps);
+    void domRenderModeChanged(DomRenderMode mode);
     void activeDomOutlineEnabledChanged(bool enabled);
 
 private:
@@ -54,6 +56,7 @@ private:
     int m_tradingCategoryIndex = -1;
     QComboBox *m_domRefreshCombo = nullptr;
     QVector<int> m_domRefreshChoices;
+    QComboBox *m_domRenderCombo = nullptr;
     QCheckBox *m_activeDomOutlineCheck = nullptr;
 
     int m_centerKey = Qt::Key_Shift;
@@ -1,4 +1,5 @@
 #include "MainWindow.h"
+#include "DomLadderItem.h"
 #include <QApplication>
 #include <QDir>
 #include <QFile>
@@ -8,6 +9,7 @@
 #include <QIcon>
 #include <QGuiApplication>
 #include <QPalette>
+#include <QQmlEngine>
 #include <QStyleFactory>
 #include <QSurfaceFormat>
 
@@ -60,6 +62,7 @@ int main(int argc, char **argv)
     QSurfaceFormat::setDefaultFormat(fmt);
 
     QApplication app(argc, argv);
+    qmlRegisterType<DomLadderItem>("PlasmaTerminal.Dom", 1, 0, "DomLadder");
 
 #ifdef Q_OS_WIN
     // On Windows with light OS theme, the default palette bleeds into unstyled widgets and
@@ -1,8 +1,11 @@
 import QtQuick 2.15
+import PlasmaTerminal.Dom 1.0
 
 Item {
     id: root
     property var levelsModel: null
+    // Draw rows with the native DomLadder item instead of ListView delegates.
+    property bool nativeRenderer: false
     property int rowHeight: 14
     property color backgroundColor: "#121212"
     property color gridColor: "#1f1f1f"
@@ -58,7 +61,8 @@ Item {
                         : (positionBar.visible ? positionBar.top : parent.bottom)
         spacing: 0
         clip: true
-        model: root.levelsModel
+        visible: !root.nativeRenderer
+        model: root.nativeRenderer ? null : root.levelsModel
         interactive: false
 
         delegate: Item {
@@ -221,6 +225,29 @@ Item {
         }
     }
 
+    // Same rows as the delegate above, from one batched scene-graph node tree.
+    DomLadder {
+        id: nativeLadder
+        objectName: "domLadder"
+        anchors.fill: levelsView
+        clip: true
+        visible: root.nativeRenderer
+        rowHeight: root.rowHeight
+        priceColumnWidth: root.priceColumnWidth
+        hoverRow: root.hoverRow
+        gridColor: root.gridColor
+        textColor: root.textColor
+        priceBorderColor: root.priceBorderColor
+        tickSize: root.tickSize
+        positionActive: root.positionActive
+        positionEntryPrice: root.positionEntryPrice
+        positionMarkPrice: root.positionMarkPrice
+        positionPnlColor: root.positionPnlColor
+        priceFontFamily: root.priceFontFamily
+        priceFontPixelSize: root.priceFontPixelSize
+        highlightPhase: root.orderHighlightPhase
+    }
+
     Rectangle {
         id: actionOverlay
         anchors.left: parent.left
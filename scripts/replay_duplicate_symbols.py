@@ -0,0 +1,193 @@
+"""Replay check: two books on the same symbol (`--symbols A,A`) get the same updates.
+
+The GUI hub puts every ladder with the same backend settings into one process,
+so two columns on one symbol become two feeds of that symbol. This writes a
+small synthetic recording per venue (REST bodies once per feed, then depth and
+trade pushes), replays it with --speed max --throttle-ms 0 and compares the
+JSON stream of book 0 with that of book 1.
+
+    python scripts/replay_duplicate_symbols.py [--backend path/to/orderbook_backend]
+
+Without --backend the backend is built the way `run.py backend` builds it.
+"""
+
+import argparse
+import json
+import struct
+import subprocess
+import sys
+import tempfile
+from pathlib import Path
+
+SYMBOL = "BTCUSDT"
+TICK = "0.1"
+MAGIC = b"OBREC001"
+
+OPEN, TEXT, BINARY, HTTP = 1, 2, 3, 4
+
+
+class Recording:
+    """Writes the format described in backend/include/Recording.hpp."""
+
+    def __init__(self, path: Path) -> None:
+        self._out = path.open("wb")
+        self._out.write(MAGIC)
+        self._ns = 0
+
+    def record(self, kind: int, key: str, payload: bytes) -> None:
+        self._ns += 1_000_000
+        key_bytes = key.encode()
+        self._out.write(struct.pack("<BqII", kind, self._ns, len(key_bytes), len(payload)))
+        self._out.write(key_bytes)
+        self._out.write(payload)
+
+    def http(self, key: str, body: dict) -> None:
+        self.record(HTTP, key, json.dumps(body).encode())
+
+    def close(self) -> None:
+        self._out.close()
+
+
+def exchange_info() -> dict:
+    return {"symbols": [{"symbol": SYMBOL, "filters": [{"filterType": "PRICE_FILTER", "tickSize": TICK}]}]}
+
+
+def snapshot(last_update_id: int) -> dict:
+    return {
+        "lastUpdateId": last_update_id,
+        "bids": [["100.0", "1"], ["99.9", "2"], ["99.8", "3"]],
+        "asks": [["100.1", "1"], ["100.2", "2"], ["100.3", "3"]],
+    }
+
+
+# (price, qty) changes per update; a new best bid and ask halfway through.
+UPDATES = [
+    ([("100.0", "5")], [("100.2", "0")]),
+    ([("99.9", "0")], [("100.1", "4")]),
+    ([("100.05", "7")], [("100.08", "6")]),
+    ([("99.7", "9")], [("100.4", "1")]),
+]
+TRADES = [("100.1", "0.5", True), ("100.0", "0.25", False)]
+
+
+def write_binance(path: Path, feeds: int) -> None:
+    rec = Recording(path)
+    for _ in range(feeds):
+        rec.http(f"api.binance.com:443/api/v3/exchangeInfo?symbol={SYMBOL}", exchange_info())
+        rec.http(f"api.binance.com:443/api/v3/depth?symbol={SYMBOL}&limit=500", snapshot(100))
+    rec.record(OPEN, "stream.binance.com:9443/ws", b"")
+    rec.record(TEXT, "", json.dumps({"result": None, "id": 1}).encode())
+    update_id = 100
+    for i, (bids, asks) in enumerate(UPDATES):
+        update_id += 1
+        event = {"e": "depthUpdate", "E": 1_700_000_000_000 + i, "s": SYMBOL, "U": update_id, "u": update_id,
+                 "b": [list(b) for b in bids], "a": [list(a) for a in asks]}
+        rec.record(TEXT, "", json.dumps(event).encode())
+        if i < len(TRADES):
+            price, qty, buy = TRADES[i]
+            trade = {"e": "aggTrade", "s": SYMBOL, "p": price, "q": qty, "m": not buy, "T": 1_700_000_000_100 + i}
+            rec.record(TEXT, "", json.dumps(trade).encode())
+    rec.close()
+
+
+def varint(value: int) -> bytes:
+    out = bytearray()
+    while True:
+        byte = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return bytes(out)
+
+
+def field_bytes(number: int, payload: bytes) -> bytes:
+    return varint(number << 3 | 2) + varint(len(payload)) + payload
+
+
+def field_varint(number: int, value: int) -> bytes:
+    return varint(number << 3) + varint(value)
+
+
+def mexc_push(channel: str, body_field: int, body: bytes) -> bytes:
+    return field_bytes(1, channel.encode()) + field_bytes(3, SYMBOL.encode()) + field_bytes(body_field, body)
+
+
+def write_mexc(path: Path, feeds: int) -> None:
+    rec = Recording(path)
+    for _ in range(feeds):
+        rec.http(f"api.mexc.com:443/api/v3/exchangeInfo?symbol={SYMBOL}", exchange_info())
+        rec.http(f"api.mexc.com:443/api/v3/depth?symbol={SYMBOL}&limit=500", snapshot(100))
+    rec.record(OPEN, "wbs-api.mexc.com:443/ws", b"")
+    for i, (bids, asks) in enumerate(UPDATES):
+        depth = b"".join(field_bytes(1, field_bytes(1, p.encode()) + field_bytes(2, q.encode())) for p, q in asks)
+        depth += b"".join(field_bytes(2, field_bytes(1, p.encode()) + field_bytes(2, q.encode())) for p, q in bids)
+        rec.record(BINARY, "", mexc_push(f"spot@public.aggre.depth.v3.api.pb@100ms@{SYMBOL}", 313, depth))
+        if i < len(TRADES):
+            price, qty, buy = TRADES[i]
+            deal = (field_bytes(1, price.encode()) + field_bytes(2, qty.encode())
+                    + field_varint(3, 1 if buy else 2) + field_varint(4, 1_700_000_000_100 + i))
+            rec.record(BINARY, "", mexc_push(f"spot@public.aggre.deals.v3.api.pb@100ms@{SYMBOL}", 314,
+                                             field_bytes(1, deal)))
+    rec.close()
+
+
+# Wall-clock fields differ between two emits of the same state.
+VOLATILE = {"book", "ts", "timestamp"}
+
+
+def book_streams(stdout: str) -> dict:
+    streams: dict = {}
+    for line in stdout.splitlines():
+        try:
+            msg = json.loads(line)
+        except ValueError:
+            continue
+        if not isinstance(msg, dict) or msg.get("type") not in ("ladder", "ladder_delta", "trade"):
+            continue
+        streams.setdefault(msg.get("book", 0), []).append({k: v for k, v in msg.items() if k not in VOLATILE})
+    return streams
+
+
+def check(backend: Path, exchange: str, writer) -> bool:
+    with tempfile.TemporaryDirectory() as tmp:
+        recording = Path(tmp) / f"{exchange}.obrec"
+        writer(recording, 2)
+        cmd = [str(backend), "--exchange", exchange, "--symbols", f"{SYMBOL},{SYMBOL}", "--protocol", "json",
+               "--snapshot-depth", "500", "--replay", str(recording), "--speed", "max", "--throttle-ms", "0"]
+        proc = subprocess.run(cmd, capture_output=True, text=True, timeout=60)
+    streams = book_streams(proc.stdout)
+    first, second = streams.get(0, []), streams.get(1, [])
+    trades = sum(1 for msg in first if msg["type"] == "trade")
+    ok = bool(first) and first == second and trades == len(TRADES) and len(first) > len(TRADES) + 1
+    print(f"[{exchange}] book0={len(first)} book1={len(second)} trades={trades}: {'ok' if ok else 'FAILED'}")
+    if not ok:
+        print(proc.stderr, file=sys.stderr)
+    return ok
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--backend", help="orderbook_backend to run; built with run.py's settings if omitted")
+    parser.add_argument("--config", default="Release")
+    args = parser.parse_args()
+
+    if args.backend:
+        backend = Path(args.backend)
+    else:
+        sys.path.insert(0, str(Path(__file__).resolve().parent))
+        from run import backend_binary, configure_and_build
+
+        root = Path(__file__).resolve().parents[1]
+        build_dir = (root / "build").resolve()
+        configure_and_build(root, build_dir, args.config)
+        backend = backend_binary(build_dir, args.config)
+
+    ok = check(backend, "binance", write_binance)
+    ok = check(backend, "mexc", write_mexc) and ok
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())